@@ -35,12 +35,13 @@ struct BoxStack : public Demo
 		//bodyDef.angle = q3PI * q3RandomFloat( -1.0f, 1.0f );
 		q3Body* body = scene.CreateBody( bodyDef );
 
-		q3BoxDef boxDef;
-		boxDef.SetRestitution( 0 );
+		q3PlaneDef planeDef;
+		planeDef.SetRestitution( 0 );
 		q3Transform tx;
 		q3Identity( tx );
-		boxDef.Set( tx, q3Vec3( 50.0f, 1.0f, 50.0f ) );
-		body->AddBox( boxDef );
+		tx.position.Set( 0.0f, 0.5f, 0.0f );
+		planeDef.Set( tx );
+		body->AddPlane( planeDef );
 
 		// Create boxes
 		//for ( i32 i = 0; i < 10; ++i )
@@ -57,6 +58,9 @@ struct BoxStack : public Demo
 		//}
 
 		bodyDef.bodyType = eDynamicBody;
+		q3BoxDef boxDef;
+		boxDef.SetRestitution( 0 );
+		q3Identity( tx );
 		boxDef.Set( tx, q3Vec3( 1.0f, 1.0f, 1.0f ) );
 
 		for ( i32 i = 0; i < 8; ++i )
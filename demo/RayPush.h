@@ -32,7 +32,7 @@ public:
 	q3Vec3 nfinal;
 	q3Body *impactBody;
 	
-	bool ReportShape( q3Box *shape )
+	bool ReportShape( q3Shape *shape )
 	{
 		if ( data.toi < tfinal )
 		{
@@ -26,8 +26,12 @@
 
 #include "q3BroadPhase.h"
 #include "../collision/q3Box.h"
+#include "../collision/q3Mesh.h"
+#include "../collision/q3Heightfield.h"
+#include "../collision/q3Plane.h"
 #include "../common/q3Geometry.h"
 #include "../dynamics/q3ContactManager.h"
+#include "../dynamics/q3Body.h"
 
 //--------------------------------------------------------------------------------------------------
 // q3BroadPhase
@@ -43,27 +47,59 @@ q3BroadPhase::q3BroadPhase( q3ContactManager *manager )
 	m_moveCount = 0;
 	m_moveCapacity = 64;
 	m_moveBuffer = (i32*)q3Alloc( m_moveCapacity * sizeof( i32 ) );
+
+	m_planeCount = 0;
+	m_planeCapacity = 4;
+	m_planes = (q3Shape**)q3Alloc( m_planeCapacity * sizeof( q3Shape* ) );
 }
 
 //--------------------------------------------------------------------------------------------------
 q3BroadPhase::~q3BroadPhase( )
 {
+	q3Free( m_planes );
 	q3Free( m_moveBuffer );
 	q3Free( m_pairBuffer );
 }
 
 //--------------------------------------------------------------------------------------------------
-void q3BroadPhase::InsertBox( q3Box *box, const q3AABB& aabb )
+void q3BroadPhase::InsertBody( q3Body *body, const q3AABB& aabb )
 {
-	i32 id = m_tree.Insert( aabb, box );
-	box->broadPhaseIndex = id;
+	i32 tree = (body->m_flags & q3Body::eStatic) || !body->IsAwake( ) ? eRestingTree : eAwakeTree;
+	i32 id = ProxyId( m_trees[ tree ].Insert( aabb, body ), tree );
+	body->m_broadPhaseIndex = id;
 	BufferMove( id );
 }
 
 //--------------------------------------------------------------------------------------------------
-void q3BroadPhase::RemoveBox( const q3Box *box )
+void q3BroadPhase::RemoveBody( q3Body *body )
 {
-	m_tree.Remove( box->broadPhaseIndex );
+	i32 id = body->m_broadPhaseIndex;
+
+	// Remove pending moves so the freed node is not queried
+	ReplaceMove( id, -1 );
+
+	m_trees[ id & 1 ].Remove( id >> 1 );
+	body->m_broadPhaseIndex = -1;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3BroadPhase::SetBodyAwake( q3Body *body, bool awake )
+{
+	i32 id = body->m_broadPhaseIndex;
+	i32 tree = awake ? eAwakeTree : eRestingTree;
+
+	if ( id == -1 || (id & 1) == tree || (body->m_flags & q3Body::eStatic) )
+		return;
+
+	// Reinserted from a tight AABB so the proxy is not fattened twice
+	q3AABB aabb;
+	body->ComputeAABB( &aabb );
+
+	m_trees[ id & 1 ].Remove( id >> 1 );
+	i32 newId = ProxyId( m_trees[ tree ].Insert( aabb, body ), tree );
+	body->m_broadPhaseIndex = newId;
+
+	ReplaceMove( id, newId );
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -87,13 +123,19 @@ void q3BroadPhase::UpdatePairs( )
 	for ( i32 i = 0; i < m_moveCount; ++i)
 	{
 		m_currentIndex = m_moveBuffer[ i ];
-		q3AABB aabb = m_tree.GetFatAABB( m_currentIndex );
 
-		// @TODO: Use a static and non-static tree and query one against the other.
-		//        This will potentially prevent (gotta think about this more) time
-		//        wasted with queries of static bodies against static bodies, and
-		//        kinematic to kinematic.
-		m_tree.Query( this, aabb );
+		if ( m_currentIndex == -1 )
+			continue;
+
+		q3AABB aabb = GetFatAABB( m_currentIndex );
+
+		// Resting proxies that moved, such as teleported bodies, are queried
+		// against both trees as well
+		for ( m_queryTree = 0; m_queryTree < 2; ++m_queryTree )
+			m_trees[ m_queryTree ].Query( this, aabb );
+
+		if ( m_planeCount )
+			AddPlanePairs( (q3Body*)GetUserData( m_currentIndex ) );
 	}
 
 	// Reset the move buffer
@@ -109,9 +151,11 @@ void q3BroadPhase::UpdatePairs( )
 		{
 			// Add contact to manager
 			q3ContactPair* pair = m_pairBuffer + i;
-			q3Box *A = (q3Box*)m_tree.GetUserData( pair->A );
-			q3Box *B = (q3Box*)m_tree.GetUserData( pair->B );
-			m_manager->AddContact( A, B );
+			q3Body *A = (q3Body*)GetUserData( pair->A );
+			q3Body *B = (q3Body*)GetUserData( pair->B );
+
+			if ( A->CanCollide( B ) )
+				MidPhase( A, B );
 
 			++i;
 
@@ -128,20 +172,242 @@ void q3BroadPhase::UpdatePairs( )
 		}
 	}
 
-	m_tree.Validate( );
+	m_trees[ eAwakeTree ].Validate( );
+	m_trees[ eRestingTree ].Validate( );
 }
 
 //--------------------------------------------------------------------------------------------------
 void q3BroadPhase::Update( i32 id, const q3AABB& aabb )
 {
-	if ( m_tree.Update( id, aabb ) )
+	if ( m_trees[ id & 1 ].Update( id >> 1, aabb ) )
 		BufferMove( id );
 }
 
 //--------------------------------------------------------------------------------------------------
-bool q3BroadPhase::TestOverlap( i32 A, i32 B ) const
+void q3BroadPhase::TouchProxy( i32 id )
+{
+	BufferMove( id );
+}
+
+//--------------------------------------------------------------------------------------------------
+bool q3BroadPhase::TestOverlap( const q3Shape *A, const q3Shape *B, i32 childB ) const
+{
+	q3AABB aabbB;
+
+	switch ( B->type )
+	{
+	case eMeshShape:
+		((const q3Mesh*)B)->ComputeTriangleAABB( B->body->m_tx, childB, &aabbB );
+		break;
+
+	case eHeightfieldShape:
+		((const q3Heightfield*)B)->ComputeTriangleAABB( B->body->m_tx, childB, &aabbB );
+		break;
+
+	case ePlaneShape:
+		return q3AABBtoPlane( GetShapeAABB( A ), ((const q3Plane*)B)->GetPlane( B->body->m_tx ) );
+
+	default:
+		aabbB = GetShapeAABB( B );
+	}
+
+	return q3AABBtoAABB( GetShapeAABB( A ), aabbB );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3BroadPhase::InsertPlane( q3Shape *plane )
+{
+	if ( m_planeCount == m_planeCapacity )
+	{
+		q3Shape** oldPlanes = m_planes;
+		m_planeCapacity *= 2;
+		m_planes = (q3Shape**)q3Alloc( m_planeCapacity * sizeof( q3Shape* ) );
+		memcpy( m_planes, oldPlanes, m_planeCount * sizeof( q3Shape* ) );
+		q3Free( oldPlanes );
+	}
+
+	m_planes[ m_planeCount++ ] = plane;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3BroadPhase::RemovePlane( q3Shape *plane )
+{
+	for ( i32 i = 0; i < m_planeCount; ++i )
+	{
+		if ( m_planes[ i ] == plane )
+		{
+			m_planes[ i ] = m_planes[ --m_planeCount ];
+			return;
+		}
+	}
+
+	assert( false );
+}
+
+//--------------------------------------------------------------------------------------------------
+const q3AABB q3BroadPhase::GetShapeAABB( const q3Shape *shape ) const
 {
-	return q3AABBtoAABB( m_tree.GetFatAABB( A ), m_tree.GetFatAABB( B ) );
+	const q3Body *body = shape->body;
+
+	if ( body->m_shapeCount == 1 )
+		return GetFatAABB( body->m_broadPhaseIndex );
+
+	return q3Mul( body->m_tx, body->m_shapeTree.GetFatAABB( shape->treeIndex ) );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3BroadPhase::MidPhase( q3Body *bodyA, q3Body *bodyB )
+{
+	// Shapes of the body with the lower proxy are always passed first so that
+	// the contact manager sees shape pairs in a consistent order
+	struct MidPhaseWrapper
+	{
+		bool TreeCallBack( i32 id )
+		{
+			q3Shape *shape = (q3Shape*)tree->GetUserData( id );
+
+			if ( flip )
+				broadPhase->AddShapePair( shape, single );
+			else
+				broadPhase->AddShapePair( single, shape );
+
+			return true;
+		}
+
+		bool TreeCallBack( i32 idA, i32 idB )
+		{
+			q3Shape *A = (q3Shape*)tree->GetUserData( idA );
+			q3Shape *B = (q3Shape*)otherTree->GetUserData( idB );
+			broadPhase->AddShapePair( A, B );
+
+			return true;
+		}
+
+		q3BroadPhase *broadPhase;
+		const q3DynamicAABBTree *tree;
+		const q3DynamicAABBTree *otherTree;
+		q3Shape *single;
+		bool flip;
+	};
+
+	MidPhaseWrapper wrapper;
+	wrapper.broadPhase = this;
+
+	if ( bodyA->m_shapeCount == 1 && bodyB->m_shapeCount == 1 )
+	{
+		AddShapePair( bodyA->m_shapes, bodyB->m_shapes );
+	}
+
+	else if ( bodyA->m_shapeCount == 1 )
+	{
+		wrapper.tree = &bodyB->m_shapeTree;
+		wrapper.single = bodyA->m_shapes;
+		wrapper.flip = false;
+		bodyB->m_shapeTree.Query( &wrapper, bodyB->m_tx, GetFatAABB( bodyA->m_broadPhaseIndex ) );
+	}
+
+	else if ( bodyB->m_shapeCount == 1 )
+	{
+		wrapper.tree = &bodyA->m_shapeTree;
+		wrapper.single = bodyB->m_shapes;
+		wrapper.flip = true;
+		bodyA->m_shapeTree.Query( &wrapper, bodyA->m_tx, GetFatAABB( bodyB->m_broadPhaseIndex ) );
+	}
+
+	else
+	{
+		wrapper.tree = &bodyA->m_shapeTree;
+		wrapper.otherTree = &bodyB->m_shapeTree;
+		bodyA->m_shapeTree.Query( &wrapper, bodyA->m_tx, bodyB->m_shapeTree, bodyB->m_tx );
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+// Adds a contact for every triangle of B (a mesh or heightfield) that
+// overlaps the world space aabb of shape A
+template <typename T>
+struct q3TriangleQueryWrapper
+{
+	bool TreeCallBack( i32 index )
+	{
+		q3AABB triAABB;
+		triangles->ComputeTriangleAABB( triangles->body->GetTransform( ), index, &triAABB );
+
+		if ( q3AABBtoAABB( aabb, triAABB ) )
+			manager->AddContact( shape, triangles, index );
+
+		return true;
+	}
+
+	q3ContactManager *manager;
+	q3Shape *shape;
+	T *triangles;
+	q3AABB aabb;
+};
+
+//--------------------------------------------------------------------------------------------------
+template <typename T>
+static void q3AddTrianglePairs( q3ContactManager *manager, q3Shape *A, T *B, const q3AABB& aabb )
+{
+	q3TriangleQueryWrapper<T> wrapper;
+	wrapper.manager = manager;
+	wrapper.shape = A;
+	wrapper.triangles = B;
+	wrapper.aabb = aabb;
+
+	// Triangles are queried within the space of B's body
+	B->Query( &wrapper, q3Mul( q3Inverse( B->body->GetTransform( ) ), aabb ) );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3BroadPhase::AddShapePair( q3Shape *A, q3Shape *B )
+{
+	// Shapes with child triangles are always shape B
+	if ( A->type > B->type )
+		std::swap( A, B );
+
+	switch ( B->type )
+	{
+	case eMeshShape:
+		q3AddTrianglePairs( m_manager, A, (q3Mesh*)B, GetShapeAABB( A ) );
+		break;
+
+	case eHeightfieldShape:
+		q3AddTrianglePairs( m_manager, A, (q3Heightfield*)B, GetShapeAABB( A ) );
+		break;
+
+	default:
+		m_manager->AddContact( A, B, 0 );
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3BroadPhase::AddPlanePairs( q3Body *body )
+{
+	q3AABB aabb = GetFatAABB( body->m_broadPhaseIndex );
+
+	for ( i32 i = 0; i < m_planeCount; ++i )
+	{
+		q3Shape *plane = m_planes[ i ];
+
+		if ( !body->CanCollide( plane->body ) )
+			continue;
+
+		q3HalfSpace h = ((q3Plane*)plane)->GetPlane( plane->body->m_tx );
+
+		// Cull the whole body before looking at its shapes
+		if ( !q3AABBtoPlane( aabb, h ) )
+			continue;
+
+		for ( q3Shape *shape = body->m_shapes; shape; shape = shape->next )
+		{
+			if ( shape->type == ePlaneShape )
+				continue;
+
+			if ( q3AABBtoPlane( GetShapeAABB( shape ), h ) )
+				m_manager->AddContact( shape, plane, 0 );
+		}
+	}
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -158,3 +424,13 @@ void q3BroadPhase::BufferMove( i32 id )
 
 	m_moveBuffer[ m_moveCount++ ] = id;
 }
+
+//--------------------------------------------------------------------------------------------------
+void q3BroadPhase::ReplaceMove( i32 id, i32 newId )
+{
+	for ( i32 i = 0; i < m_moveCount; ++i )
+	{
+		if ( m_moveBuffer[ i ] == id )
+			m_moveBuffer[ i ] = newId;
+	}
+}
@@ -35,7 +35,8 @@
 // q3BroadPhase
 //--------------------------------------------------------------------------------------------------
 class q3ContactManager;
-struct q3Box;
+class q3Body;
+struct q3Shape;
 struct q3Transform;
 struct q3AABB;
 
@@ -51,16 +52,41 @@ public:
 	q3BroadPhase( q3ContactManager *manager );
 	~q3BroadPhase( );
 
-	void InsertBox( q3Box *shape, const q3AABB& aabb );
-	void RemoveBox( const q3Box *shape );
+	// Each body owns a single proxy bounding all of its shapes
+	void InsertBody( q3Body *body, const q3AABB& aabb );
+	void RemoveBody( q3Body *body );
+
+	// Moves the proxy of a body into the tree of awake proxies or the tree
+	// of resting ones. Must not be called from within UpdatePairs.
+	void SetBodyAwake( q3Body *body, bool awake );
 
 	// Generates the contact list. All previous contacts are returned to the allocator
-	// before generation occurs.
+	// before generation occurs. Overlapping bodies are refined into overlapping shape
+	// pairs by querying the shape trees of the bodies (mid-phase).
 	void UpdatePairs( void );
 
 	void Update( i32 id, const q3AABB& aabb );
 
-	bool TestOverlap( i32 A, i32 B ) const;
+	// Forces a proxy to be queried against the tree upon the next UpdatePairs
+	void TouchProxy( i32 id );
+
+	// Tests the bounds of a shape pair, childB is a triangle of a mesh or
+	// heightfield B
+	bool TestOverlap( const q3Shape *A, const q3Shape *B, i32 childB ) const;
+
+	// Infinite planes are kept out of the tree. Every moving proxy is tested
+	// directly against each plane instead.
+	void InsertPlane( q3Shape *plane );
+	void RemovePlane( q3Shape *plane );
+
+	// Queries both trees, calling cb->TreeCallBack( id ) with proxy ids
+	template <typename T>
+	void Query( T *cb, const q3AABB& aabb ) const;
+	template <typename T>
+	void Query( T *cb, q3RaycastData& rayCast ) const;
+
+	void *GetUserData( i32 id ) const;
+	const q3AABB& GetFatAABB( i32 id ) const;
 
 private:
 	q3ContactManager *m_manager;
@@ -73,20 +99,111 @@ private:
 	i32 m_moveCount;
 	i32 m_moveCapacity;
 
-	q3DynamicAABBTree m_tree;
+	q3Shape** m_planes;
+	i32 m_planeCount;
+	i32 m_planeCapacity;
+
+	// Proxies of static and sleeping bodies are kept apart from those of
+	// awake bodies, so queries of moving proxies search fewer nodes and the
+	// nodes of resting bodies are not restructured around moving ones. The
+	// lowest bit of a proxy id tells the tree and the rest the node.
+	enum
+	{
+		eAwakeTree,
+		eRestingTree
+	};
+
+	q3DynamicAABBTree m_trees[ 2 ];
 	i32 m_currentIndex;
+	i32 m_queryTree;
 
+	static i32 ProxyId( i32 node, i32 tree );
 	void BufferMove( i32 id );
+	void ReplaceMove( i32 id, i32 newId );
 	bool TreeCallBack( i32 index );
+	void MidPhase( q3Body *bodyA, q3Body *bodyB );
+	void AddShapePair( q3Shape *A, q3Shape *B );
+	void AddPlanePairs( q3Body *body );
+
+	// Bounding volume of a shape used by the mid-phase. Bodies with a single
+	// shape use the fat AABB of their proxy.
+	const q3AABB GetShapeAABB( const q3Shape *shape ) const;
 
 	friend class q3DynamicAABBTree;
 	friend class q3Scene;
+	friend struct q3TOISolver;
 };
 
+inline i32 q3BroadPhase::ProxyId( i32 node, i32 tree )
+{
+	return (node << 1) | tree;
+}
+
+//--------------------------------------------------------------------------------------------------
+inline void *q3BroadPhase::GetUserData( i32 id ) const
+{
+	return m_trees[ id & 1 ].GetUserData( id >> 1 );
+}
+
+//--------------------------------------------------------------------------------------------------
+inline const q3AABB& q3BroadPhase::GetFatAABB( i32 id ) const
+{
+	return m_trees[ id & 1 ].GetFatAABB( id >> 1 );
+}
+
+//--------------------------------------------------------------------------------------------------
+// Turns the node indices reported by one tree into proxy ids
+template <typename T>
+struct q3ProxyQueryWrapper
+{
+	bool TreeCallBack( i32 index )
+	{
+		proceed = cb->TreeCallBack( (index << 1) | tree );
+		return proceed;
+	}
+
+	T *cb;
+	i32 tree;
+	bool proceed;
+};
+
+//--------------------------------------------------------------------------------------------------
+template <typename T>
+inline void q3BroadPhase::Query( T *cb, const q3AABB& aabb ) const
+{
+	q3ProxyQueryWrapper<T> wrapper;
+	wrapper.cb = cb;
+	wrapper.proceed = true;
+
+	for ( i32 i = 0; i < 2 && wrapper.proceed; ++i )
+	{
+		wrapper.tree = i;
+		m_trees[ i ].Query( &wrapper, aabb );
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+template <typename T>
+inline void q3BroadPhase::Query( T *cb, q3RaycastData& rayCast ) const
+{
+	q3ProxyQueryWrapper<T> wrapper;
+	wrapper.cb = cb;
+	wrapper.proceed = true;
+
+	for ( i32 i = 0; i < 2 && wrapper.proceed; ++i )
+	{
+		wrapper.tree = i;
+		m_trees[ i ].Query( &wrapper, rayCast );
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
 inline bool q3BroadPhase::TreeCallBack( i32 index )
 {
+	i32 id = ProxyId( index, m_queryTree );
+
 	// Cannot collide with self
-	if ( index == m_currentIndex )
+	if ( id == m_currentIndex )
 		return true;
 
 	if ( m_pairCount == m_pairCapacity )
@@ -98,8 +215,8 @@ inline bool q3BroadPhase::TreeCallBack( i32 index )
 		q3Free( oldBuffer );
 	}
 
-	i32 iA = q3Min( index, m_currentIndex );
-	i32 iB = q3Max( index, m_currentIndex );
+	i32 iA = q3Min( id, m_currentIndex );
+	i32 iB = q3Max( id, m_currentIndex );
 
 	m_pairBuffer[ m_pairCount ].A = iA;
 	m_pairBuffer[ m_pairCount ].B = iB;
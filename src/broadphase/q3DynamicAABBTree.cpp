@@ -31,21 +31,24 @@
 //--------------------------------------------------------------------------------------------------
 // q3DynamicAABBTree
 //--------------------------------------------------------------------------------------------------
-inline void FattenAABB( q3AABB& aabb )
+inline void FattenAABB( q3AABB& aabb, r32 fattener )
 {
-	const r32 k_fattener = r32( 0.5 );
-	q3Vec3 v( k_fattener, k_fattener, k_fattener );
+	q3Vec3 v( fattener, fattener, fattener );
 
 	aabb.min -= v;
 	aabb.max += v;
 }
 
 //--------------------------------------------------------------------------------------------------
-q3DynamicAABBTree::q3DynamicAABBTree( )
+q3DynamicAABBTree::q3DynamicAABBTree( i32 capacity, r32 fattener )
 {
+	assert( capacity > 0 );
+	assert( fattener >= r32( 0.0 ) );
+
 	m_root = Node::Null;
+	m_fattener = fattener;
 
-	m_capacity = 1024;
+	m_capacity = capacity;
 	m_count = 0;
 	m_nodes = (Node *)q3Alloc( sizeof( Node ) * m_capacity );
 
@@ -65,7 +68,7 @@ i32 q3DynamicAABBTree::Insert( const q3AABB& aabb, void *userData )
 
 	// Fatten AABB and set height/userdata
 	m_nodes[ id ].aabb = aabb;
-	FattenAABB( m_nodes[id].aabb );
+	FattenAABB( m_nodes[id].aabb, m_fattener );
 	m_nodes[ id ].userData = userData;
 	m_nodes[ id ].height = 0;
 
@@ -94,7 +97,7 @@ bool q3DynamicAABBTree::Update( i32 id, const q3AABB& aabb )
 	RemoveLeaf( id );
 
 	m_nodes[ id ].aabb = aabb;
-	FattenAABB( m_nodes[ id ].aabb );
+	FattenAABB( m_nodes[ id ].aabb, m_fattener );
 
 	InsertLeaf( id );
 
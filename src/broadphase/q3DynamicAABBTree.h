@@ -29,6 +29,7 @@
 
 #include "../math/q3Math.h"
 #include "../common/q3Geometry.h"
+#include "../math/q3Transform.h"
 
 //--------------------------------------------------------------------------------------------------
 // q3DynamicAABBTree
@@ -41,7 +42,9 @@ class q3Render;
 class q3DynamicAABBTree
 {
 public:
-	q3DynamicAABBTree( );
+	// Leaf AABBs are grown by fattener on each side so that small movements
+	// do not require the tree to be restructured.
+	q3DynamicAABBTree( i32 capacity = 1024, r32 fattener = r32( 0.5 ) );
 	~q3DynamicAABBTree( );
 
 	// Provide tight-AABB
@@ -58,6 +61,19 @@ public:
 	template <typename T>
 	void Query( T *cb, q3RaycastData& rayCast ) const;
 
+	// Queries a tree whose AABBs are stored relative to tx, where aabb is
+	// in world space. Node AABBs are transformed conservatively.
+	template <typename T>
+	void Query( T *cb, const q3Transform& tx, const q3AABB& aabb ) const;
+
+	// Reports all overlapping leaf pairs between this tree and other, each
+	// placed in world space by their transform. Calls cb->TreeCallBack( idA, idB )
+	// where idA belongs to this tree and idB to other.
+	template <typename T>
+	void Query( T *cb, const q3Transform& tx, const q3DynamicAABBTree& other, const q3Transform& otherTx ) const;
+
+	bool IsEmpty( ) const;
+
 	// For testing
 	void Validate( ) const;
 
@@ -118,6 +134,7 @@ private:
 	i32 m_count;	// Number of active nodes
 	i32 m_capacity;	// Max capacity of nodes
 	i32 m_freeList;
+	r32 m_fattener;
 };
 
 #include "q3DynamicAABBTree.inl"
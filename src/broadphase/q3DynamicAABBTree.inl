@@ -64,6 +64,9 @@ inline void q3DynamicAABBTree::Query( T *cb, const q3AABB& aabb ) const
 
 		i32 id = stack[ --sp ];
 
+		if ( id == Node::Null )
+			continue;
+
 		const Node *n = m_nodes + id;
 		if ( q3AABBtoAABB( aabb, n->aabb ) )
 		{
@@ -152,3 +155,109 @@ void q3DynamicAABBTree::Query( T *cb, q3RaycastData& rayCast ) const
 		}
 	}
 }
+
+//--------------------------------------------------------------------------------------------------
+template <typename T>
+void q3DynamicAABBTree::Query( T *cb, const q3Transform& tx, const q3AABB& aabb ) const
+{
+	if ( m_root == Node::Null )
+		return;
+
+	const i32 k_stackCapacity = 256;
+	i32 stack[ k_stackCapacity ];
+	i32 sp = 1;
+
+	*stack = m_root;
+
+	while ( sp )
+	{
+		// k_stackCapacity too small
+		assert( sp < k_stackCapacity );
+
+		i32 id = stack[ --sp ];
+
+		const Node *n = m_nodes + id;
+		if ( q3AABBtoAABB( aabb, q3Mul( tx, n->aabb ) ) )
+		{
+			if ( n->IsLeaf( ) )
+			{
+				if ( !cb->TreeCallBack( id ) )
+					return;
+			}
+			else
+			{
+				stack[ sp++ ] = n->left;
+				stack[ sp++ ] = n->right;
+			}
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+template <typename T>
+void q3DynamicAABBTree::Query( T *cb, const q3Transform& tx, const q3DynamicAABBTree& other, const q3Transform& otherTx ) const
+{
+	if ( m_root == Node::Null || other.m_root == Node::Null )
+		return;
+
+	// Simultaneous descent, always splitting the larger of the two nodes
+	const i32 k_stackCapacity = 256;
+	i32 stack[ k_stackCapacity * 2 ];
+	i32 sp = 1;
+
+	stack[ 0 ] = m_root;
+	stack[ 1 ] = other.m_root;
+
+	while ( sp )
+	{
+		// k_stackCapacity too small
+		assert( sp + 1 < k_stackCapacity );
+
+		--sp;
+		i32 idA = stack[ sp * 2 ];
+		i32 idB = stack[ sp * 2 + 1 ];
+
+		const Node *a = m_nodes + idA;
+		const Node *b = other.m_nodes + idB;
+		q3AABB aabbA = q3Mul( tx, a->aabb );
+		q3AABB aabbB = q3Mul( otherTx, b->aabb );
+
+		if ( !q3AABBtoAABB( aabbA, aabbB ) )
+			continue;
+
+		bool leafA = a->IsLeaf( );
+		bool leafB = b->IsLeaf( );
+
+		if ( leafA && leafB )
+		{
+			if ( !cb->TreeCallBack( idA, idB ) )
+				return;
+		}
+
+		else if ( leafB || (!leafA && aabbA.SurfaceArea( ) >= aabbB.SurfaceArea( )) )
+		{
+			stack[ sp * 2 ] = a->left;
+			stack[ sp * 2 + 1 ] = idB;
+			++sp;
+			stack[ sp * 2 ] = a->right;
+			stack[ sp * 2 + 1 ] = idB;
+			++sp;
+		}
+
+		else
+		{
+			stack[ sp * 2 ] = idA;
+			stack[ sp * 2 + 1 ] = b->left;
+			++sp;
+			stack[ sp * 2 ] = idA;
+			stack[ sp * 2 + 1 ] = b->right;
+			++sp;
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+inline bool q3DynamicAABBTree::IsEmpty( ) const
+{
+	return m_root == Node::Null;
+}
@@ -27,42 +27,15 @@
 #ifndef Q3BOX_H
 #define Q3BOX_H
 
-#include "../math/q3Vec3.h"
-#include "../math/q3Mat3.h"
-#include "../math/q3Transform.h"
-#include "../debug/q3Render.h"
-
-//--------------------------------------------------------------------------------------------------
-// q3MassData
-//--------------------------------------------------------------------------------------------------
-struct q3MassData
-{
-	q3Mat3 inertia;
-	q3Vec3 center;
-	r32 mass;
-};
+#include "q3Shape.h"
 
 //--------------------------------------------------------------------------------------------------
 // q3Box
 //--------------------------------------------------------------------------------------------------
-struct q3Box
+struct q3Box : public q3Shape
 {
-	q3Transform local;
 	q3Vec3 e; // extent, as in the extent of each OBB axis
 
-	q3Box* next;
-	class q3Body* body;
-	r32 friction;
-	r32 restitution;
-	r32 density;
-	i32 broadPhaseIndex;
-	mutable void* userData;
-	mutable bool sensor;
-
-	void SetUserdata( void* data ) const;
-	void* GetUserdata( ) const;
-	void SetSensor( bool isSensor );
-
 	bool TestPoint( const q3Transform& tx, const q3Vec3& p ) const;
 	bool Raycast( const q3Transform& tx, q3RaycastData* raycast ) const;
 	void ComputeAABB( const q3Transform& tx, q3AABB* aabb ) const;
@@ -73,34 +46,14 @@ struct q3Box
 //--------------------------------------------------------------------------------------------------
 // q3BoxDef
 //--------------------------------------------------------------------------------------------------
-class q3BoxDef
+class q3BoxDef : public q3ShapeDef
 {
 public:
-	q3BoxDef( )
-	{
-		// Common default values
-		m_friction = r32( 0.4 );
-		m_restitution = r32( 0.2 );
-		m_density = r32( 1.0 );
-		m_sensor = false;
-	}
-
 	void Set( const q3Transform& tx, const q3Vec3& extents );
 
-	void SetFriction( r32 friction );
-	void SetRestitution( r32 restitution );
-	void SetDensity( r32 density );
-	void SetSensor( bool sensor );
-
 private:
-	q3Transform m_tx;
 	q3Vec3 m_e;
 
-	r32 m_friction;
-	r32 m_restitution;
-	r32 m_density;
-	bool m_sensor;
-
 	friend class q3Body;
 };
 
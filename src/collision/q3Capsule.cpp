@@ -0,0 +1,208 @@
+//--------------------------------------------------------------------------------------------------
+/**
+@file	q3Capsule.cpp
+
+@author	Randy Gaul
+@date	10/19/2026
+
+	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+
+	This software is provided 'as-is', without any express or implied
+	warranty. In no event will the authors be held liable for any damages
+	arising from the use of this software.
+
+	Permission is granted to anyone to use this software for any purpose,
+	including commercial applications, and to alter it and redistribute it
+	freely, subject to the following restrictions:
+	  1. The origin of this software must not be misrepresented; you must not
+	     claim that you wrote the original software. If you use this software
+	     in a product, an acknowledgment in the product documentation would be
+	     appreciated but is not required.
+	  2. Altered source versions must be plainly marked as such, and must not
+	     be misrepresented as being the original software.
+	  3. This notice may not be removed or altered from any source distribution.
+*/
+//--------------------------------------------------------------------------------------------------
+
+#include "q3Capsule.h"
+
+//--------------------------------------------------------------------------------------------------
+// q3Capsule
+//--------------------------------------------------------------------------------------------------
+bool q3Capsule::TestPoint( const q3Transform& tx, const q3Vec3& p ) const
+{
+	q3Transform world = q3Mul( tx, local );
+	q3Vec3 p0 = q3MulT( world, p );
+	r32 y = q3Clamp( -h, h, p0.y );
+
+	return q3DistanceSq( p0, q3Vec3( r32( 0.0 ), y, r32( 0.0 ) ) ) <= radius * radius;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Intersects a ray with a sphere, false if the ray starts within the sphere
+static bool q3RaytoSphere( const q3Vec3& p, const q3Vec3& d, const q3Vec3& center, r32 radius, r32* t )
+{
+	q3Vec3 m = p - center;
+	r32 b = q3Dot( m, d );
+	r32 c = q3Dot( m, m ) - radius * radius;
+	r32 discriminant = b * b - c;
+
+	if ( c < r32( 0.0 ) || discriminant < r32( 0.0 ) )
+		return false;
+
+	*t = -b - std::sqrt( discriminant );
+
+	return *t >= r32( 0.0 );
+}
+
+//--------------------------------------------------------------------------------------------------
+bool q3Capsule::Raycast( const q3Transform& tx, q3RaycastData* raycast ) const
+{
+	q3Transform world = q3Mul( tx, local );
+	q3Vec3 d = q3MulT( world.rotation, raycast->dir );
+	q3Vec3 p = q3MulT( world, raycast->start );
+	const r32 epsilon = r32( 1.0e-8 );
+	r32 toi = raycast->t;
+	bool hit = false;
+	q3Vec3 n;
+
+	// Infinite cylinder about the y axis, clipped to the segment
+	r32 a = d.x * d.x + d.z * d.z;
+
+	if ( a > epsilon )
+	{
+		r32 b = p.x * d.x + p.z * d.z;
+		r32 c = p.x * p.x + p.z * p.z - radius * radius;
+		r32 discriminant = b * b - a * c;
+
+		if ( c >= r32( 0.0 ) && discriminant >= r32( 0.0 ) )
+		{
+			r32 t = (-b - std::sqrt( discriminant )) / a;
+			r32 y = p.y + d.y * t;
+
+			if ( t >= r32( 0.0 ) && t <= toi && y >= -h && y <= h )
+			{
+				hit = true;
+				toi = t;
+				n = q3Vec3( p.x + d.x * t, r32( 0.0 ), p.z + d.z * t );
+			}
+		}
+	}
+
+	// End caps
+	for ( i32 i = 0; i < 2; ++i )
+	{
+		q3Vec3 center( r32( 0.0 ), i ? h : -h, r32( 0.0 ) );
+		r32 t;
+
+		if ( q3RaytoSphere( p, d, center, radius, &t ) && t <= toi )
+		{
+			hit = true;
+			toi = t;
+			n = p + d * t - center;
+		}
+	}
+
+	if ( hit )
+	{
+		raycast->toi = toi;
+		raycast->normal = q3Mul( world.rotation, q3Normalize( n ) );
+	}
+
+	return hit;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Capsule::ComputeAABB( const q3Transform& tx, q3AABB* aabb ) const
+{
+	q3Vec3 a, b;
+	GetSegment( &a, &b );
+	a = q3Mul( tx, a );
+	b = q3Mul( tx, b );
+	q3Vec3 r( radius, radius, radius );
+
+	aabb->min = q3Min( a, b ) - r;
+	aabb->max = q3Max( a, b ) + r;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Capsule::ComputeMass( q3MassData* md ) const
+{
+	// Cylinder plus two hemispheres, which together form a sphere
+	r32 r2 = radius * radius;
+	r32 height = r32( 2.0 ) * h;
+	r32 cylinderMass = q3PI * r2 * height * density;
+	r32 sphereMass = r32( 4.0 / 3.0 ) * q3PI * r2 * radius * density;
+	r32 mass = cylinderMass + sphereMass;
+
+	// The hemispheres are offset from the center by h plus the distance
+	// of each hemisphere's center of mass from its flat face, 3r/8
+	r32 y = r32( 0.5 ) * cylinderMass * r2 + r32( 2.0 / 5.0 ) * sphereMass * r2;
+	r32 x = cylinderMass * (r32( 1.0 / 12.0 ) * height * height + r32( 0.25 ) * r2);
+	x += sphereMass * (r32( 2.0 / 5.0 ) * r2 + h * h + r32( 3.0 / 4.0 ) * h * radius);
+	q3Mat3 I = q3Diagonal( x, y, x );
+
+	// Transform tensor to local space
+	I = local.rotation * I * q3Transpose( local.rotation );
+	q3Mat3 identity;
+	q3Identity( identity );
+	I += (identity * q3Dot( local.position, local.position ) - q3OuterProduct( local.position, local.position )) * mass;
+
+	md->center = local.position;
+	md->inertia = I;
+	md->mass = mass;
+}
+
+//--------------------------------------------------------------------------------------------------
+const i32 kCapsuleRings = 8; // Must be even
+const i32 kCapsuleSectors = 12;
+
+//--------------------------------------------------------------------------------------------------
+// Rings 0 through kCapsuleRings / 2 form the top cap, the remaining rings
+// form the bottom cap. The two rings at the equator form the cylinder.
+static q3Vec3 q3CapsuleVertex( i32 ring, i32 sector, r32 h, q3Vec3* n )
+{
+	r32 offset = h;
+
+	if ( ring > kCapsuleRings / 2 )
+	{
+		--ring;
+		offset = -h;
+	}
+
+	r32 theta = q3PI * r32( ring ) / r32( kCapsuleRings );
+	r32 phi = r32( 2.0 ) * q3PI * r32( sector ) / r32( kCapsuleSectors );
+	*n = q3Vec3( std::sin( theta ) * std::cos( phi ), std::cos( theta ), std::sin( theta ) * std::sin( phi ) );
+
+	return q3Vec3( r32( 0.0 ), offset, r32( 0.0 ) );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Capsule::Render( const q3Transform& tx, bool awake, q3Render* render ) const
+{
+	Q3_UNUSED( awake );
+
+	q3Transform world = q3Mul( tx, local );
+
+	for ( i32 i = 0; i <= kCapsuleRings; ++i )
+	{
+		for ( i32 j = 0; j < kCapsuleSectors; ++j )
+		{
+			q3Vec3 n[ 4 ];
+			q3Vec3 v[ 4 ];
+			v[ 0 ] = q3CapsuleVertex( i, j, h, n );
+			v[ 1 ] = q3CapsuleVertex( i + 1, j, h, n + 1 );
+			v[ 2 ] = q3CapsuleVertex( i + 1, j + 1, h, n + 2 );
+			v[ 3 ] = q3CapsuleVertex( i, j + 1, h, n + 3 );
+
+			for ( i32 k = 0; k < 4; ++k )
+				v[ k ] = q3Mul( world, v[ k ] + n[ k ] * radius );
+
+			q3Vec3 normal = q3Normalize( q3Mul( world.rotation, n[ 0 ] + n[ 2 ] ) );
+
+			render->SetTriNormal( normal.x, normal.y, normal.z );
+			render->Triangle( v[ 0 ].x, v[ 0 ].y, v[ 0 ].z, v[ 2 ].x, v[ 2 ].y, v[ 2 ].z, v[ 1 ].x, v[ 1 ].y, v[ 1 ].z );
+			render->Triangle( v[ 0 ].x, v[ 0 ].y, v[ 0 ].z, v[ 3 ].x, v[ 3 ].y, v[ 3 ].z, v[ 2 ].x, v[ 2 ].y, v[ 2 ].z );
+		}
+	}
+}
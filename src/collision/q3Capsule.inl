@@ -0,0 +1,43 @@
+//--------------------------------------------------------------------------------------------------
+// q3Capsule.inl
+//
+//	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+//
+//	This software is provided 'as-is', without any express or implied
+//	warranty. In no event will the authors be held liable for any damages
+//	arising from the use of this software.
+//
+//	Permission is granted to anyone to use this software for any purpose,
+//	including commercial applications, and to alter it and redistribute it
+//	freely, subject to the following restrictions:
+//	  1. The origin of this software must not be misrepresented; you must not
+//	     claim that you wrote the original software. If you use this software
+//	     in a product, an acknowledgment in the product documentation would be
+//	     appreciated but is not required.
+//	  2. Altered source versions must be plainly marked as such, and must not
+//	     be misrepresented as being the original software.
+//	  3. This notice may not be removed or altered from any source distribution.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+// q3Capsule
+//--------------------------------------------------------------------------------------------------
+inline void q3Capsule::GetSegment( q3Vec3* a, q3Vec3* b ) const
+{
+	q3Vec3 axis = local.rotation.ey * h;
+	*a = local.position - axis;
+	*b = local.position + axis;
+}
+
+//--------------------------------------------------------------------------------------------------
+// q3CapsuleDef
+//--------------------------------------------------------------------------------------------------
+inline void q3CapsuleDef::Set( const q3Transform& tx, r32 height, r32 radius )
+{
+	assert( height >= r32( 0.0 ) );
+	assert( radius > r32( 0.0 ) );
+
+	m_tx = tx;
+	m_h = height * r32( 0.5 );
+	m_radius = radius;
+}
@@ -31,9 +31,9 @@
 //--------------------------------------------------------------------------------------------------
 // qBoxtoBox
 //--------------------------------------------------------------------------------------------------
-inline bool q3TrackFaceAxis( i32* axis, i32 n, r32 s, r32* sMax, const q3Vec3& normal, q3Vec3* axisNormal )
+inline bool q3TrackFaceAxis( i32* axis, i32 n, r32 s, r32 margin, r32* sMax, const q3Vec3& normal, q3Vec3* axisNormal )
 {
-	if ( s > r32( 0.0 ) )
+	if ( s > margin )
 		return true;
 
 	if ( s > *sMax )
@@ -47,14 +47,14 @@ inline bool q3TrackFaceAxis( i32* axis, i32 n, r32 s, r32* sMax, const q3Vec3& n
 }
 
 //--------------------------------------------------------------------------------------------------
-inline bool q3TrackEdgeAxis( i32* axis, i32 n, r32 s, r32* sMax, const q3Vec3& normal, q3Vec3* axisNormal )
+inline bool q3TrackEdgeAxis( i32* axis, i32 n, r32 s, r32 margin, r32* sMax, const q3Vec3& normal, q3Vec3* axisNormal )
 {
-	if ( s > r32( 0.0 ) )
-		return true;
-
 	r32 l = r32( 1.0 ) / q3Length( normal );
 	s *= l;
 
+	if ( s > margin )
+		return true;
+
 	if ( s > *sMax )
 	{
 		*sMax = s;
@@ -347,7 +347,7 @@ i32 q3Orthographic( r32 sign, r32 e, i32 axis, i32 clipEdge, q3ClipVertex* in, i
 //--------------------------------------------------------------------------------------------------
 // Resources (also see q3BoxtoBox's resources):
 // http://www.randygaul.net/2013/10/27/sutherland-hodgman-clipping/
-i32 q3Clip( const q3Vec3& rPos, const q3Vec3& e, u8* clipEdges, const q3Mat3& basis, q3ClipVertex* incident, q3ClipVertex* outVerts, r32* outDepths )
+i32 q3Clip( const q3Vec3& rPos, const q3Vec3& e, u8* clipEdges, const q3Mat3& basis, q3ClipVertex* incident, r32 margin, q3ClipVertex* outVerts, r32* outDepths )
 {
 	i32 inCount = 4;
 	i32 outCount;
@@ -374,13 +374,14 @@ i32 q3Clip( const q3Vec3& rPos, const q3Vec3& e, u8* clipEdges, const q3Mat3& ba
 
 	inCount = q3Orthographic( r32( -1.0 ), e.y, 1, clipEdges[ 3 ], out, outCount, in );
 
-	// Keep incident vertices behind the reference face
+	// Keep incident vertices behind the reference face, or within the
+	// speculative margin in front of it
 	outCount = 0;
 	for ( i32 i = 0; i < inCount; ++i )
 	{
 		r32 d = in[ i ].v.z - e.z;
 
-		if ( d <= r32( 0.0 ) )
+		if ( d <= margin )
 		{
 			outVerts[ outCount ].v = q3Mul( basis, in[ i ].v ) + rPos;
 			outVerts[ outCount ].f = in[ i ].f;
@@ -487,6 +488,7 @@ void q3BoxtoBox( q3Manifold* m, q3Box* a, q3Box* b )
 	btx = q3Mul( btx, bL );
 	q3Vec3 eA = a->e;
 	q3Vec3 eB = b->e;
+	r32 margin = m->margin;
 
 	// B's frame in A's space
 	q3Mat3 C = q3Transpose( atx.rotation ) * btx.rotation;
@@ -525,32 +527,32 @@ void q3BoxtoBox( q3Manifold* m, q3Box* a, q3Box* b )
 
 	// a's x axis
 	s = q3Abs( t.x ) - (eA.x + q3Dot( absC.Column0( ), eB ));
-	if ( q3TrackFaceAxis( &aAxis, 0, s, &aMax, atx.rotation.ex, &nA ) )
+	if ( q3TrackFaceAxis( &aAxis, 0, s, margin, &aMax, atx.rotation.ex, &nA ) )
 		return;
 
 	// a's y axis
 	s = q3Abs( t.y ) - (eA.y + q3Dot( absC.Column1( ), eB ));
-	if ( q3TrackFaceAxis( &aAxis, 1, s, &aMax, atx.rotation.ey, &nA ) )
+	if ( q3TrackFaceAxis( &aAxis, 1, s, margin, &aMax, atx.rotation.ey, &nA ) )
 		return;
 
 	// a's z axis
 	s = q3Abs( t.z ) - (eA.z + q3Dot( absC.Column2( ), eB ));
-	if ( q3TrackFaceAxis( &aAxis, 2, s, &aMax, atx.rotation.ez, &nA ) )
+	if ( q3TrackFaceAxis( &aAxis, 2, s, margin, &aMax, atx.rotation.ez, &nA ) )
 		return;
 
 	// b's x axis
 	s = q3Abs( q3Dot( t, C.ex ) ) - (eB.x + q3Dot( absC.ex, eA ));
-	if ( q3TrackFaceAxis( &bAxis, 3, s, &bMax, btx.rotation.ex, &nB ) )
+	if ( q3TrackFaceAxis( &bAxis, 3, s, margin, &bMax, btx.rotation.ex, &nB ) )
 		return;
 
 	// b's y axis
 	s = q3Abs( q3Dot( t, C.ey ) ) - (eB.y + q3Dot( absC.ey, eA ));
-	if ( q3TrackFaceAxis( &bAxis, 4, s, &bMax, btx.rotation.ey, &nB ) )
+	if ( q3TrackFaceAxis( &bAxis, 4, s, margin, &bMax, btx.rotation.ey, &nB ) )
 		return;
 
 	// b's z axis
 	s = q3Abs( q3Dot( t, C.ez ) ) - (eB.z + q3Dot( absC.ez, eA ));
-	if ( q3TrackFaceAxis( &bAxis, 5, s, &bMax, btx.rotation.ez, &nB ) )
+	if ( q3TrackFaceAxis( &bAxis, 5, s, margin, &bMax, btx.rotation.ez, &nB ) )
 		return;
 
 	if ( !parallel )
@@ -563,63 +565,63 @@ void q3BoxtoBox( q3Manifold* m, q3Box* a, q3Box* b )
 		rA = eA.y * absC[ 0 ][ 2 ] + eA.z * absC[ 0 ][ 1 ];
 		rB = eB.y * absC[ 2 ][ 0 ] + eB.z * absC[ 1 ][ 0 ];
 		s = q3Abs( t.z * C[ 0 ][ 1 ] - t.y * C[ 0 ][ 2 ] ) - (rA + rB);
-		if ( q3TrackEdgeAxis( &eAxis, 6, s, &eMax, q3Vec3( r32( 0.0 ), -C[ 0 ][ 2 ], C[ 0 ][ 1 ] ), &nE ) )
+		if ( q3TrackEdgeAxis( &eAxis, 6, s, margin, &eMax, q3Vec3( r32( 0.0 ), -C[ 0 ][ 2 ], C[ 0 ][ 1 ] ), &nE ) )
 			return;
 
 		// Cross( a.x, b.y )
 		rA = eA.y * absC[ 1 ][ 2 ] + eA.z * absC[ 1 ][ 1 ];
 		rB = eB.x * absC[ 2 ][ 0 ] + eB.z * absC[ 0 ][ 0 ];
 		s = q3Abs( t.z * C[ 1 ][ 1 ] - t.y * C[ 1 ][ 2 ] ) - (rA + rB);
-		if ( q3TrackEdgeAxis( &eAxis, 7, s, &eMax, q3Vec3( r32( 0.0 ), -C[ 1 ][ 2 ], C[ 1 ][ 1 ] ), &nE ) )
+		if ( q3TrackEdgeAxis( &eAxis, 7, s, margin, &eMax, q3Vec3( r32( 0.0 ), -C[ 1 ][ 2 ], C[ 1 ][ 1 ] ), &nE ) )
 			return;
 
 		// Cross( a.x, b.z )
 		rA = eA.y * absC[ 2 ][ 2 ] + eA.z * absC[ 2 ][ 1 ];
 		rB = eB.x * absC[ 1 ][ 0 ] + eB.y * absC[ 0 ][ 0 ];
 		s = q3Abs( t.z * C[ 2 ][ 1 ] - t.y * C[ 2 ][ 2 ] ) - (rA + rB);
-		if ( q3TrackEdgeAxis( &eAxis, 8, s, &eMax, q3Vec3( r32( 0.0 ), -C[ 2 ][ 2 ], C[ 2 ][ 1 ] ), &nE ) )
+		if ( q3TrackEdgeAxis( &eAxis, 8, s, margin, &eMax, q3Vec3( r32( 0.0 ), -C[ 2 ][ 2 ], C[ 2 ][ 1 ] ), &nE ) )
 			return;
 
 		// Cross( a.y, b.x )
 		rA = eA.x * absC[ 0 ][ 2 ] + eA.z * absC[ 0 ][ 0 ];
 		rB = eB.y * absC[ 2 ][ 1 ] + eB.z * absC[ 1 ][ 1 ];
 		s = q3Abs( t.x * C[ 0 ][ 2 ] - t.z * C[ 0 ][ 0 ] ) - (rA + rB);
-		if ( q3TrackEdgeAxis( &eAxis, 9, s, &eMax, q3Vec3( C[ 0 ][ 2 ], r32( 0.0 ), -C[ 0 ][ 0 ] ), &nE ) )
+		if ( q3TrackEdgeAxis( &eAxis, 9, s, margin, &eMax, q3Vec3( C[ 0 ][ 2 ], r32( 0.0 ), -C[ 0 ][ 0 ] ), &nE ) )
 			return;
 
 		// Cross( a.y, b.y )
 		rA = eA.x * absC[ 1 ][ 2 ] + eA.z * absC[ 1 ][ 0 ];
 		rB = eB.x * absC[ 2 ][ 1 ] + eB.z * absC[ 0 ][ 1 ];
 		s = q3Abs( t.x * C[ 1 ][ 2 ] - t.z * C[ 1 ][ 0 ] ) - (rA + rB);
-		if ( q3TrackEdgeAxis( &eAxis, 10, s, &eMax, q3Vec3( C[ 1 ][ 2 ], r32( 0.0 ), -C[ 1 ][ 0 ] ), &nE ) )
+		if ( q3TrackEdgeAxis( &eAxis, 10, s, margin, &eMax, q3Vec3( C[ 1 ][ 2 ], r32( 0.0 ), -C[ 1 ][ 0 ] ), &nE ) )
 			return;
 
 		// Cross( a.y, b.z )
 		rA = eA.x * absC[ 2 ][ 2 ] + eA.z * absC[ 2 ][ 0 ];
 		rB = eB.x * absC[ 1 ][ 1 ] + eB.y * absC[ 0 ][ 1 ];
 		s = q3Abs( t.x * C[ 2 ][ 2 ] - t.z * C[ 2 ][ 0 ] ) - (rA + rB);
-		if ( q3TrackEdgeAxis( &eAxis, 11, s, &eMax, q3Vec3( C[ 2 ][ 2 ], r32( 0.0 ), -C[ 2 ][ 0 ] ), &nE ) )
+		if ( q3TrackEdgeAxis( &eAxis, 11, s, margin, &eMax, q3Vec3( C[ 2 ][ 2 ], r32( 0.0 ), -C[ 2 ][ 0 ] ), &nE ) )
 			return;
 
 		// Cross( a.z, b.x )
 		rA = eA.x * absC[ 0 ][ 1 ] + eA.y * absC[ 0 ][ 0 ];
 		rB = eB.y * absC[ 2 ][ 2 ] + eB.z * absC[ 1 ][ 2 ];
 		s = q3Abs( t.y * C[ 0 ][ 0 ] - t.x * C[ 0 ][ 1 ] ) - (rA + rB);
-		if ( q3TrackEdgeAxis( &eAxis, 12, s, &eMax, q3Vec3( -C[ 0 ][ 1 ], C[ 0 ][ 0 ], r32( 0.0 ) ), &nE ) )
+		if ( q3TrackEdgeAxis( &eAxis, 12, s, margin, &eMax, q3Vec3( -C[ 0 ][ 1 ], C[ 0 ][ 0 ], r32( 0.0 ) ), &nE ) )
 			return;
 
 		// Cross( a.z, b.y )
 		rA = eA.x * absC[ 1 ][ 1 ] + eA.y * absC[ 1 ][ 0 ];
 		rB = eB.x * absC[ 2 ][ 2 ] + eB.z * absC[ 0 ][ 2 ];
 		s = q3Abs( t.y * C[ 1 ][ 0 ] - t.x * C[ 1 ][ 1 ] ) - (rA + rB);
-		if ( q3TrackEdgeAxis( &eAxis, 13, s, &eMax, q3Vec3( -C[ 1 ][ 1 ], C[ 1 ][ 0 ], r32( 0.0 ) ), &nE ) )
+		if ( q3TrackEdgeAxis( &eAxis, 13, s, margin, &eMax, q3Vec3( -C[ 1 ][ 1 ], C[ 1 ][ 0 ], r32( 0.0 ) ), &nE ) )
 			return;
 
 		// Cross( a.z, b.z )
 		rA = eA.x * absC[ 2 ][ 1 ] + eA.y * absC[ 2 ][ 0 ];
 		rB = eB.x * absC[ 1 ][ 2 ] + eB.y * absC[ 0 ][ 2 ];
 		s = q3Abs( t.y * C[ 2 ][ 0 ] - t.x * C[ 2 ][ 1 ] ) - (rA + rB);
-		if ( q3TrackEdgeAxis( &eAxis, 14, s, &eMax, q3Vec3( -C[ 2 ][ 1 ], C[ 2 ][ 0 ], r32( 0.0 ) ), &nE ) )
+		if ( q3TrackEdgeAxis( &eAxis, 14, s, margin, &eMax, q3Vec3( -C[ 2 ][ 1 ], C[ 2 ][ 0 ], r32( 0.0 ) ), &nE ) )
 			return;
 	}
 
@@ -699,7 +701,7 @@ void q3BoxtoBox( q3Manifold* m, q3Box* a, q3Box* b )
 		q3ClipVertex out[ 8 ];
 		r32 depths[ 8 ];
 		i32 outNum;
-		outNum = q3Clip( rtx.position, e, clipEdges, basis, incident, out, depths );
+		outNum = q3Clip( rtx.position, e, clipEdges, basis, incident, margin, out, depths );
 
 		if ( outNum )
 		{
@@ -751,3 +753,2178 @@ void q3BoxtoBox( q3Manifold* m, q3Box* a, q3Box* b )
 		c->position = (CA + CB) * r32( 0.5 );
 	}
 }
+
+//--------------------------------------------------------------------------------------------------
+// Boolean form of the SAT in q3BoxtoBox. Only the sign of each separation
+// matters, so edge axes are not normalized and nothing is clipped.
+bool q3BoxtoBoxOverlap( q3Box* a, q3Box* b )
+{
+	q3Transform atx = q3Mul( a->body->GetTransform( ), a->local );
+	q3Transform btx = q3Mul( b->body->GetTransform( ), b->local );
+	q3Vec3 eA = a->e;
+	q3Vec3 eB = b->e;
+
+	// B's frame in A's space
+	q3Mat3 C = q3Transpose( atx.rotation ) * btx.rotation;
+
+	q3Mat3 absC;
+	bool parallel = false;
+	const r32 kCosTol = r32( 1.0e-6 );
+	for ( i32 i = 0; i < 3; ++i )
+	{
+		for ( i32 j = 0; j < 3; ++j )
+		{
+			r32 val = q3Abs( C[ i ][ j ] );
+			absC[ i ][ j ] = val;
+
+			if ( val + kCosTol >= r32( 1.0 ) )
+				parallel = true;
+		}
+	}
+
+	// Vector from center A to center B in A's space
+	q3Vec3 t = q3MulT( atx.rotation, btx.position - atx.position );
+
+	// Face axes of A and B
+	for ( i32 i = 0; i < 3; ++i )
+	{
+		q3Vec3 column( absC.ex[ i ], absC.ey[ i ], absC.ez[ i ] );
+
+		if ( q3Abs( t[ i ] ) > eA[ i ] + q3Dot( column, eB ) )
+			return false;
+
+		if ( q3Abs( q3Dot( t, C[ i ] ) ) > eB[ i ] + q3Dot( absC[ i ], eA ) )
+			return false;
+	}
+
+	// Face axes cover every pair of nearly parallel edges
+	if ( parallel )
+		return true;
+
+	// Cross( a's i axis, b's j axis )
+	for ( i32 i = 0; i < 3; ++i )
+	{
+		i32 i1 = (i + 1) % 3;
+		i32 i2 = (i + 2) % 3;
+
+		for ( i32 j = 0; j < 3; ++j )
+		{
+			i32 j1 = (j + 1) % 3;
+			i32 j2 = (j + 2) % 3;
+
+			r32 rA = eA[ i1 ] * absC[ j ][ i2 ] + eA[ i2 ] * absC[ j ][ i1 ];
+			r32 rB = eB[ j1 ] * absC[ j2 ][ i ] + eB[ j2 ] * absC[ j1 ][ i ];
+
+			if ( q3Abs( t[ i2 ] * C[ j ][ i1 ] - t[ i1 ] * C[ j ][ i2 ] ) > rA + rB )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+// q3BoxtoTriangle
+//--------------------------------------------------------------------------------------------------
+// Tracks the separation along a unit axis given the triangle's projected
+// interval [tMin, tMax] and the box's projected radius r. The tracked normal
+// points from the box towards the triangle.
+inline bool q3TrackTriangleAxis( i32* axis, i32 n, r32 tMin, r32 tMax, r32 r, r32* sMax, const q3Vec3& normal, q3Vec3* axisNormal )
+{
+	r32 sPos = tMin - r;
+	r32 sNeg = -r - tMax;
+	r32 s = q3Max( sPos, sNeg );
+
+	if ( s > r32( 0.0 ) )
+		return true;
+
+	if ( s > *sMax )
+	{
+		*sMax = s;
+		*axis = n;
+		*axisNormal = sPos > sNeg ? normal : -normal;
+	}
+
+	return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+const i32 k_maxClipVertices = 64;
+
+// Sutherland-Hodgman clipping of a convex polygon against planeCount planes.
+// Vertices with a positive distance to any plane are clipped away. Feature
+// pairs follow the same conventions as q3Orthographic.
+i32 q3ClipPolygon( const q3HalfSpace* planes, const u8* planeIds, i32 planeCount, q3ClipVertex* in, i32 inCount, q3ClipVertex* out )
+{
+	q3ClipVertex buffer[ k_maxClipVertices ];
+	q3ClipVertex* src = in;
+	q3ClipVertex* dst = buffer;
+
+	for ( i32 p = 0; p < planeCount; ++p )
+	{
+		const q3HalfSpace& h = planes[ p ];
+		i32 dstCount = 0;
+		q3ClipVertex a = src[ inCount - 1 ];
+		r32 da = q3Dot( h.normal, a.v ) - h.distance;
+
+		for ( i32 i = 0; i < inCount; ++i )
+		{
+			q3ClipVertex b = src[ i ];
+			r32 db = q3Dot( h.normal, b.v ) - h.distance;
+			q3ClipVertex cv;
+
+			// B
+			if ( da <= r32( 0.0 ) && db <= r32( 0.0 ) )
+			{
+				assert( dstCount < k_maxClipVertices );
+				dst[ dstCount++ ] = b;
+			}
+
+			// I
+			else if ( da <= r32( 0.0 ) && db > r32( 0.0 ) )
+			{
+				cv.f = b.f;
+				cv.v = a.v + (b.v - a.v) * (da / (da - db));
+				cv.f.outR = planeIds[ p ];
+				cv.f.outI = 0;
+				assert( dstCount < k_maxClipVertices );
+				dst[ dstCount++ ] = cv;
+			}
+
+			// I, B
+			else if ( da > r32( 0.0 ) && db <= r32( 0.0 ) )
+			{
+				cv.f = a.f;
+				cv.v = a.v + (b.v - a.v) * (da / (da - db));
+				cv.f.inR = planeIds[ p ];
+				cv.f.inI = 0;
+				assert( dstCount < k_maxClipVertices - 1 );
+				dst[ dstCount++ ] = cv;
+				dst[ dstCount++ ] = b;
+			}
+
+			a = b;
+			da = db;
+		}
+
+		if ( !dstCount )
+			return 0;
+
+		inCount = dstCount;
+		src = dst;
+		dst = (dst == buffer) ? out : buffer;
+	}
+
+	if ( src != out )
+	{
+		for ( i32 i = 0; i < inCount; ++i )
+			out[ i ] = src[ i ];
+	}
+
+	return inCount;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Collision is computed within the space of the box. The triangle is two-
+// sided, the SAT considers the triangle normal, the three box face normals
+// and the nine cross products of box and triangle edges.
+void q3BoxtoTriangle( q3Manifold* m, q3Box* a, const q3Vec3& v0, const q3Vec3& v1, const q3Vec3& v2 )
+{
+	q3Transform atx = q3Mul( a->body->GetTransform( ), a->local );
+	q3Vec3 e = a->e;
+
+	q3Vec3 p[ 3 ];
+	p[ 0 ] = q3MulT( atx, v0 );
+	p[ 1 ] = q3MulT( atx, v1 );
+	p[ 2 ] = q3MulT( atx, v2 );
+
+	q3Vec3 edges[ 3 ];
+	edges[ 0 ] = p[ 1 ] - p[ 0 ];
+	edges[ 1 ] = p[ 2 ] - p[ 1 ];
+	edges[ 2 ] = p[ 0 ] - p[ 2 ];
+
+	q3Vec3 triNormal = q3Cross( edges[ 0 ], -edges[ 2 ] );
+	r32 area = q3Length( triNormal );
+
+	// Degenerate triangle
+	if ( area < r32( 1.0e-8 ) )
+		return;
+
+	triNormal /= area;
+
+	// Query states
+	r32 bMax = -Q3_R32_MAX;
+	r32 tMax = -Q3_R32_MAX;
+	r32 eMax = -Q3_R32_MAX;
+	i32 bAxis = ~0;
+	i32 tAxis = ~0;
+	i32 eAxis = ~0;
+	q3Vec3 nB;
+	q3Vec3 nT;
+	q3Vec3 nE;
+
+	// Triangle face axis
+	{
+		r32 t = q3Dot( triNormal, p[ 0 ] );
+		r32 r = q3Dot( q3Abs( triNormal ), e );
+
+		if ( q3TrackTriangleAxis( &tAxis, 3, t, t, r, &tMax, triNormal, &nT ) )
+			return;
+	}
+
+	// Box face axes
+	for ( i32 i = 0; i < 3; ++i )
+	{
+		r32 lo = q3Min( p[ 0 ][ i ], q3Min( p[ 1 ][ i ], p[ 2 ][ i ] ) );
+		r32 hi = q3Max( p[ 0 ][ i ], q3Max( p[ 1 ][ i ], p[ 2 ][ i ] ) );
+		q3Vec3 n( r32( 0.0 ), r32( 0.0 ), r32( 0.0 ) );
+		n[ i ] = r32( 1.0 );
+
+		if ( q3TrackTriangleAxis( &bAxis, i, lo, hi, e[ i ], &bMax, n, &nB ) )
+			return;
+	}
+
+	// Edge axes
+	for ( i32 i = 0; i < 3; ++i )
+	{
+		for ( i32 j = 0; j < 3; ++j )
+		{
+			q3Vec3 u( r32( 0.0 ), r32( 0.0 ), r32( 0.0 ) );
+			u[ i ] = r32( 1.0 );
+
+			q3Vec3 n = q3Cross( u, edges[ j ] );
+			r32 l = q3Length( n );
+
+			// Parallel edges are covered by the face axes
+			if ( l < r32( 1.0e-6 ) * q3Length( edges[ j ] ) )
+				continue;
+
+			n /= l;
+
+			r32 d0 = q3Dot( n, p[ 0 ] );
+			r32 d1 = q3Dot( n, p[ 1 ] );
+			r32 d2 = q3Dot( n, p[ 2 ] );
+			r32 lo = q3Min( d0, q3Min( d1, d2 ) );
+			r32 hi = q3Max( d0, q3Max( d1, d2 ) );
+			r32 r = q3Dot( q3Abs( n ), e );
+
+			if ( q3TrackTriangleAxis( &eAxis, 4 + i * 3 + j, lo, hi, r, &eMax, n, &nE ) )
+				return;
+		}
+	}
+
+	// Artificial axis bias to improve frame coherence, triangle faces are
+	// preferred to keep contacts stable across neighboring triangles
+	const r32 kRelTol = r32( 0.95 );
+	const r32 kAbsTol = r32( 0.01 );
+	i32 axis;
+	r32 sMax;
+	q3Vec3 n;
+	r32 faceMax = q3Max( tMax, bMax );
+	if ( kRelTol * eMax > faceMax + kAbsTol )
+	{
+		axis = eAxis;
+		sMax = eMax;
+		n = nE;
+	}
+
+	else
+	{
+		if ( kRelTol * bMax > tMax + kAbsTol )
+		{
+			axis = bAxis;
+			sMax = bMax;
+			n = nB;
+		}
+
+		else
+		{
+			axis = tAxis;
+			sMax = tMax;
+			n = nT;
+		}
+	}
+
+	if ( axis == ~0 )
+		return;
+
+	q3ClipVertex out[ k_maxClipVertices ];
+	r32 depths[ k_maxClipVertices ];
+	i32 outNum = 0;
+
+	if ( axis == 3 )
+	{
+		// Reference face is the triangle, the incident face is the box face
+		// most aligned with the normal
+		i32 k = 0;
+		q3Vec3 absN = q3Abs( n );
+
+		if ( absN.y > absN.x && absN.y >= absN.z )
+			k = 1;
+
+		else if ( absN.z > absN.x && absN.z > absN.y )
+			k = 2;
+
+		i32 u = (k + 1) % 3;
+		i32 v = (k + 2) % 3;
+		r32 s = q3Sign( n[ k ] );
+		u8 face = u8( k * 2 + (s > r32( 0.0 ) ? 0 : 1) );
+
+		const r32 signs[ 4 ][ 2 ] = {
+			{  r32( 1.0 ),  r32( 1.0 ) },
+			{ -r32( 1.0 ),  r32( 1.0 ) },
+			{ -r32( 1.0 ), -r32( 1.0 ) },
+			{  r32( 1.0 ), -r32( 1.0 ) },
+		};
+
+		q3ClipVertex incident[ k_maxClipVertices ];
+		for ( i32 i = 0; i < 4; ++i )
+		{
+			incident[ i ].v[ k ] = s * e[ k ];
+			incident[ i ].v[ u ] = signs[ i ][ 0 ] * e[ u ];
+			incident[ i ].v[ v ] = signs[ i ][ 1 ] * e[ v ];
+			incident[ i ].f.key = 0;
+			incident[ i ].f.inI = u8( face * 4 + (i + 3) % 4 + 1 );
+			incident[ i ].f.outI = u8( face * 4 + i + 1 );
+		}
+
+		// Side planes face away from the triangle's interior
+		q3Vec3 winding = q3Cross( edges[ 0 ], -edges[ 2 ] );
+		q3HalfSpace planes[ 3 ];
+		u8 planeIds[ 3 ];
+
+		for ( i32 i = 0; i < 3; ++i )
+		{
+			planes[ i ].Set( q3Cross( edges[ i ], winding ), p[ i ] );
+			planeIds[ i ] = u8( i + 1 );
+		}
+
+		i32 clipped = q3ClipPolygon( planes, planeIds, 3, incident, 4, out );
+
+		// Keep incident vertices behind the triangle, as seen from the box
+		for ( i32 i = 0; i < clipped; ++i )
+		{
+			r32 d = q3Dot( p[ 0 ] - out[ i ].v, n );
+
+			if ( d <= r32( 0.0 ) )
+			{
+				out[ outNum ] = out[ i ];
+				depths[ outNum++ ] = d;
+			}
+		}
+	}
+
+	else if ( axis < 3 )
+	{
+		// Reference face is a box face, the incident face is the triangle
+		i32 k = axis;
+		i32 u = (k + 1) % 3;
+		i32 v = (k + 2) % 3;
+
+		q3ClipVertex incident[ k_maxClipVertices ];
+		for ( i32 i = 0; i < 3; ++i )
+		{
+			incident[ i ].v = p[ i ];
+			incident[ i ].f.key = 0;
+			incident[ i ].f.inI = u8( 32 + (i + 2) % 3 );
+			incident[ i ].f.outI = u8( 32 + i );
+		}
+
+		q3HalfSpace planes[ 4 ];
+		u8 planeIds[ 4 ];
+		q3Vec3 pu( r32( 0.0 ), r32( 0.0 ), r32( 0.0 ) );
+		q3Vec3 pv( r32( 0.0 ), r32( 0.0 ), r32( 0.0 ) );
+		pu[ u ] = r32( 1.0 );
+		pv[ v ] = r32( 1.0 );
+		planes[ 0 ] = q3HalfSpace( pu, e[ u ] );
+		planes[ 1 ] = q3HalfSpace( pv, e[ v ] );
+		planes[ 2 ] = q3HalfSpace( -pu, e[ u ] );
+		planes[ 3 ] = q3HalfSpace( -pv, e[ v ] );
+
+		for ( i32 i = 0; i < 4; ++i )
+			planeIds[ i ] = u8( k * 4 + i + 4 );
+
+		i32 clipped = q3ClipPolygon( planes, planeIds, 4, incident, 3, out );
+
+		// Keep incident vertices behind the reference face
+		for ( i32 i = 0; i < clipped; ++i )
+		{
+			r32 d = q3Dot( out[ i ].v, n ) - e[ k ];
+
+			if ( d <= r32( 0.0 ) )
+			{
+				out[ outNum ] = out[ i ];
+				depths[ outNum++ ] = d;
+			}
+		}
+	}
+
+	else
+	{
+		// Supporting edge of the box along n, against the triangle edge
+		i32 i = (axis - 4) / 3;
+		i32 j = (axis - 4) % 3;
+
+		q3Vec3 PA;
+		for ( i32 c = 0; c < 3; ++c )
+			PA[ c ] = n[ c ] < r32( 0.0 ) ? -e[ c ] : e[ c ];
+
+		q3Vec3 QA = PA;
+		PA[ i ] = e[ i ];
+		QA[ i ] = -e[ i ];
+
+		q3Vec3 CA, CB;
+		q3EdgesContact( &CA, &CB, PA, QA, p[ j ], p[ (j + 1) % 3 ] );
+
+		m->normal = q3Mul( atx.rotation, n );
+		m->contactCount = 1;
+
+		q3Contact* c = m->contacts;
+		q3FeaturePair pair;
+		pair.key = axis;
+		c->fp = pair;
+		c->penetration = sMax;
+		c->position = q3Mul( atx, (CA + CB) * r32( 0.5 ) );
+
+		return;
+	}
+
+	assert( outNum <= 8 );
+
+	if ( outNum )
+	{
+		m->contactCount = outNum;
+		m->normal = q3Mul( atx.rotation, n );
+
+		for ( i32 i = 0; i < outNum; ++i )
+		{
+			q3Contact* c = m->contacts + i;
+			c->fp = out[ i ].f;
+			c->position = q3Mul( atx, out[ i ].v );
+			c->penetration = depths[ i ];
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+// Spheres and capsules
+//--------------------------------------------------------------------------------------------------
+// Rounded shapes collide by finding the closest points between their cores,
+// a point for spheres and a segment for capsules, and then inflating the
+// result by the radius. This is far cheaper than the SAT used by boxes.
+const r32 k_roundEpsilon = r32( 1.0e-6 );
+
+//--------------------------------------------------------------------------------------------------
+inline void q3PushContact( q3Manifold* m, const q3Vec3& position, r32 penetration, i32 key )
+{
+	q3Contact* c = m->contacts + m->contactCount++;
+	c->position = position;
+	c->penetration = penetration;
+	c->fp.key = key;
+}
+
+//--------------------------------------------------------------------------------------------------
+inline const q3Vec3 q3ClosestPointOnSegment( const q3Vec3& p, const q3Vec3& a, const q3Vec3& b )
+{
+	q3Vec3 ab = b - a;
+	r32 d = q3Dot( ab, ab );
+
+	if ( d < k_roundEpsilon * k_roundEpsilon )
+		return a;
+
+	return a + ab * q3Clamp01( q3Dot( p - a, ab ) / d );
+}
+
+//--------------------------------------------------------------------------------------------------
+// Resources:
+// Real-Time Collision Detection, Christer Ericson, section 5.1.5
+const q3Vec3 q3ClosestPointOnTriangle( const q3Vec3& p, const q3Vec3& a, const q3Vec3& b, const q3Vec3& c )
+{
+	q3Vec3 ab = b - a;
+	q3Vec3 ac = c - a;
+	q3Vec3 ap = p - a;
+	r32 d1 = q3Dot( ab, ap );
+	r32 d2 = q3Dot( ac, ap );
+
+	if ( d1 <= r32( 0.0 ) && d2 <= r32( 0.0 ) )
+		return a;
+
+	q3Vec3 bp = p - b;
+	r32 d3 = q3Dot( ab, bp );
+	r32 d4 = q3Dot( ac, bp );
+
+	if ( d3 >= r32( 0.0 ) && d4 <= d3 )
+		return b;
+
+	r32 vc = d1 * d4 - d3 * d2;
+
+	if ( vc <= r32( 0.0 ) && d1 >= r32( 0.0 ) && d3 <= r32( 0.0 ) )
+		return a + ab * (d1 / (d1 - d3));
+
+	q3Vec3 cp = p - c;
+	r32 d5 = q3Dot( ab, cp );
+	r32 d6 = q3Dot( ac, cp );
+
+	if ( d6 >= r32( 0.0 ) && d5 <= d6 )
+		return c;
+
+	r32 vb = d5 * d2 - d1 * d6;
+
+	if ( vb <= r32( 0.0 ) && d2 >= r32( 0.0 ) && d6 <= r32( 0.0 ) )
+		return a + ac * (d2 / (d2 - d6));
+
+	r32 va = d3 * d6 - d5 * d4;
+
+	if ( va <= r32( 0.0 ) && d4 - d3 >= r32( 0.0 ) && d5 - d6 >= r32( 0.0 ) )
+		return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+	r32 denom = r32( 1.0 ) / (va + vb + vc);
+
+	return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Unlike q3EdgesContact the results are clamped to the segments, and
+// degenerate segments are handled.
+// Resources:
+// Real-Time Collision Detection, Christer Ericson, section 5.1.9
+void q3SegmentsClosestPoints( q3Vec3 *CA, q3Vec3 *CB, const q3Vec3& PA, const q3Vec3& QA, const q3Vec3& PB, const q3Vec3& QB )
+{
+	const r32 k_epsilon = k_roundEpsilon * k_roundEpsilon;
+	q3Vec3 DA = QA - PA;
+	q3Vec3 DB = QB - PB;
+	q3Vec3 r = PA - PB;
+	r32 a = q3Dot( DA, DA );
+	r32 e = q3Dot( DB, DB );
+	r32 f = q3Dot( DB, r );
+	r32 s = r32( 0.0 );
+	r32 t = r32( 0.0 );
+
+	if ( a <= k_epsilon && e <= k_epsilon )
+	{
+		// Both segments are points
+	}
+
+	else if ( a <= k_epsilon )
+	{
+		t = q3Clamp01( f / e );
+	}
+
+	else
+	{
+		r32 c = q3Dot( DA, r );
+
+		if ( e <= k_epsilon )
+		{
+			s = q3Clamp01( -c / a );
+		}
+
+		else
+		{
+			r32 b = q3Dot( DA, DB );
+			r32 denom = a * e - b * b;
+
+			// Parallel segments pick an arbitrary s
+			if ( denom > k_epsilon * a * e )
+				s = q3Clamp01( (b * f - c * e) / denom );
+
+			t = (b * s + f) / e;
+
+			if ( t < r32( 0.0 ) )
+			{
+				t = r32( 0.0 );
+				s = q3Clamp01( -c / a );
+			}
+
+			else if ( t > r32( 1.0 ) )
+			{
+				t = r32( 1.0 );
+				s = q3Clamp01( (b - c) / a );
+			}
+		}
+	}
+
+	*CA = PA + DA * s;
+	*CB = PB + DB * t;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Clips the segment p0 p1 against the side planes of a face and creates a
+// contact for each clipped end within radius r of the face. The face plane
+// points towards the segment.
+bool q3SegmenttoFace( q3Manifold* m, const q3Vec3& p0, const q3Vec3& p1, r32 r, const q3HalfSpace* sides, i32 sideCount, const q3HalfSpace& face )
+{
+	q3Vec3 d = p1 - p0;
+	r32 t0 = r32( 0.0 );
+	r32 t1 = r32( 1.0 );
+
+	for ( i32 i = 0; i < sideCount; ++i )
+	{
+		r32 da = sides[ i ].Distance( p0 );
+		r32 dd = q3Dot( sides[ i ].normal, d );
+
+		if ( q3Abs( dd ) < k_roundEpsilon )
+		{
+			if ( da > r32( 0.0 ) )
+				return false;
+
+			continue;
+		}
+
+		r32 t = -da / dd;
+
+		if ( dd > r32( 0.0 ) )
+			t1 = q3Min( t1, t );
+
+		else
+			t0 = q3Max( t0, t );
+
+		if ( t0 > t1 )
+			return false;
+	}
+
+	r32 t[ 2 ] = { t0, t1 };
+	i32 count = t1 - t0 > k_roundEpsilon ? 2 : 1;
+
+	for ( i32 i = 0; i < count; ++i )
+	{
+		q3Vec3 q = p0 + d * t[ i ];
+		r32 h = face.Distance( q );
+
+		// Halfway between the deepest capsule point and the face
+		if ( h < r )
+			q3PushContact( m, q - face.normal * (r32( 0.5 ) * (r + h)), h - r, i );
+	}
+
+	return m->contactCount > 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Single contact between two spheres
+void q3SpherestoContact( q3Manifold* m, const q3Vec3& a, r32 ra, const q3Vec3& b, r32 rb )
+{
+	q3Vec3 d = b - a;
+	r32 distSq = q3Dot( d, d );
+	r32 r = ra + rb;
+
+	if ( distSq > r * r )
+		return;
+
+	r32 dist = std::sqrt( distSq );
+	q3Vec3 n( r32( 0.0 ), r32( 1.0 ), r32( 0.0 ) );
+
+	if ( dist > k_roundEpsilon )
+		n = d / dist;
+
+	m->normal = n;
+	q3PushContact( m, (a + n * ra + b - n * rb) * r32( 0.5 ), dist - r, 0 );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3SpheretoSphere( q3Manifold* m, q3Sphere* a, q3Sphere* b )
+{
+	q3Vec3 ca = q3Mul( a->body->GetTransform( ), a->local.position );
+	q3Vec3 cb = q3Mul( b->body->GetTransform( ), b->local.position );
+
+	q3SpherestoContact( m, ca, a->radius, cb, b->radius );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3SpheretoCapsule( q3Manifold* m, q3Sphere* a, q3Capsule* b )
+{
+	q3Transform btx = b->body->GetTransform( );
+	q3Vec3 ca = q3Mul( a->body->GetTransform( ), a->local.position );
+	q3Vec3 pb, qb;
+	b->GetSegment( &pb, &qb );
+
+	q3Vec3 cb = q3ClosestPointOnSegment( ca, q3Mul( btx, pb ), q3Mul( btx, qb ) );
+
+	q3SpherestoContact( m, ca, a->radius, cb, b->radius );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3SpheretoBox( q3Manifold* m, q3Sphere* a, q3Box* b )
+{
+	// Work in the space of the box
+	q3Transform btx = q3Mul( b->body->GetTransform( ), b->local );
+	q3Vec3 c = q3MulT( btx, q3Mul( a->body->GetTransform( ), a->local.position ) );
+	q3Vec3 e = b->e;
+	r32 r = a->radius;
+
+	q3Vec3 q( q3Clamp( -e.x, e.x, c.x ), q3Clamp( -e.y, e.y, c.y ), q3Clamp( -e.z, e.z, c.z ) );
+	q3Vec3 d = c - q;
+	r32 distSq = q3Dot( d, d );
+
+	if ( distSq > r * r )
+		return;
+
+	q3Vec3 n;
+	r32 penetration;
+
+	if ( distSq > k_roundEpsilon * k_roundEpsilon )
+	{
+		r32 dist = std::sqrt( distSq );
+		n = -d / dist;
+		penetration = dist - r;
+	}
+
+	// Center within the box, push out through the closest face
+	else
+	{
+		i32 axis = 0;
+		r32 depth = e.x - q3Abs( c.x );
+
+		for ( i32 i = 1; i < 3; ++i )
+		{
+			if ( e[ i ] - q3Abs( c[ i ] ) < depth )
+			{
+				axis = i;
+				depth = e[ i ] - q3Abs( c[ i ] );
+			}
+		}
+
+		r32 s = c[ axis ] < r32( 0.0 ) ? r32( -1.0 ) : r32( 1.0 );
+		n = q3Vec3( r32( 0.0 ), r32( 0.0 ), r32( 0.0 ) );
+		n[ axis ] = -s;
+		q[ axis ] = s * e[ axis ];
+		penetration = -depth - r;
+	}
+
+	m->normal = q3Mul( btx.rotation, n );
+	q3PushContact( m, q3Mul( btx, (c + n * r + q) * r32( 0.5 ) ), penetration, 0 );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3SpheretoTriangle( q3Manifold* m, q3Sphere* a, const q3Vec3& v0, const q3Vec3& v1, const q3Vec3& v2 )
+{
+	q3Vec3 c = q3Mul( a->body->GetTransform( ), a->local.position );
+	q3Vec3 q = q3ClosestPointOnTriangle( c, v0, v1, v2 );
+	q3Vec3 d = q - c;
+	r32 distSq = q3Dot( d, d );
+	r32 r = a->radius;
+
+	if ( distSq > r * r )
+		return;
+
+	r32 dist = std::sqrt( distSq );
+	q3Vec3 n;
+
+	// Center lies upon the triangle, either side will do
+	if ( dist > k_roundEpsilon )
+		n = d / dist;
+	else
+		n = -q3Normalize( q3Cross( v1 - v0, v2 - v0 ) );
+
+	m->normal = n;
+	q3PushContact( m, (c + n * r + q) * r32( 0.5 ), dist - r, 0 );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3CapsuletoCapsule( q3Manifold* m, q3Capsule* a, q3Capsule* b )
+{
+	q3Transform atx = a->body->GetTransform( );
+	q3Transform btx = b->body->GetTransform( );
+	q3Vec3 PA, QA, PB, QB;
+	a->GetSegment( &PA, &QA );
+	b->GetSegment( &PB, &QB );
+	PA = q3Mul( atx, PA );
+	QA = q3Mul( atx, QA );
+	PB = q3Mul( btx, PB );
+	QB = q3Mul( btx, QB );
+
+	q3Vec3 CA, CB;
+	q3SegmentsClosestPoints( &CA, &CB, PA, QA, PB, QB );
+
+	q3Vec3 d = CB - CA;
+	r32 distSq = q3Dot( d, d );
+	r32 r = a->radius + b->radius;
+
+	if ( distSq > r * r )
+		return;
+
+	q3Vec3 DA = QA - PA;
+	q3Vec3 DB = QB - PB;
+	r32 dist = std::sqrt( distSq );
+	q3Vec3 n;
+
+	if ( dist > k_roundEpsilon )
+		n = d / dist;
+
+	// Segments intersect, separate perpendicular to both
+	else
+	{
+		n = q3Cross( DA, DB );
+
+		if ( q3Dot( n, n ) < k_roundEpsilon * k_roundEpsilon )
+		{
+			q3Vec3 t;
+			q3ComputeBasis( q3Normalize( DA ), &n, &t );
+		}
+
+		n = q3Normalize( n );
+	}
+
+	m->normal = n;
+
+	// Nearly parallel capsules rest upon one another along a line, so
+	// contacts are made at both ends of the overlapping span
+	const r32 k_parallel = r32( 0.005 );
+	r32 a2 = q3Dot( DA, DA );
+	r32 b2 = q3Dot( DB, DB );
+	q3Vec3 cross = q3Cross( DA, DB );
+
+	if ( a2 > k_roundEpsilon && b2 > k_roundEpsilon && q3Dot( cross, cross ) < k_parallel * a2 * b2 )
+	{
+		r32 t0 = q3Dot( PB - PA, DA ) / a2;
+		r32 t1 = q3Dot( QB - PA, DA ) / a2;
+		r32 lo = q3Clamp01( q3Min( t0, t1 ) );
+		r32 hi = q3Clamp01( q3Max( t0, t1 ) );
+
+		if ( hi - lo > k_roundEpsilon )
+		{
+			r32 t[ 2 ] = { lo, hi };
+
+			for ( i32 i = 0; i < 2; ++i )
+			{
+				q3Vec3 pa = PA + DA * t[ i ];
+				q3Vec3 pb = q3ClosestPointOnSegment( pa, PB, QB );
+				r32 s = q3Dot( pb - pa, n );
+
+				if ( s < r )
+					q3PushContact( m, (pa + n * a->radius + pb - n * b->radius) * r32( 0.5 ), s - r, i );
+			}
+
+			if ( m->contactCount )
+				return;
+		}
+	}
+
+	q3PushContact( m, (CA + n * a->radius + CB - n * b->radius) * r32( 0.5 ), dist - r, 0 );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3CapsuletoBox( q3Manifold* m, q3Capsule* a, q3Box* b )
+{
+	// Work in the space of the box
+	q3Transform btx = q3Mul( b->body->GetTransform( ), b->local );
+	q3Transform atx = q3MulT( btx, a->body->GetTransform( ) );
+	q3Vec3 p0, p1;
+	a->GetSegment( &p0, &p1 );
+	p0 = q3Mul( atx, p0 );
+	p1 = q3Mul( atx, p1 );
+	q3Vec3 e = b->e;
+	r32 r = a->radius;
+
+	q3AABB box;
+	box.min = -e;
+	box.max = e;
+	r32 tmin = r32( 0.0 );
+	r32 tmax = r32( 1.0 );
+	i32 axis = -1;
+	r32 s = r32( 0.0 );
+	q3Vec3 n;
+
+	if ( !q3RaytoAABB( p0, p1 - p0, box, &tmin, &tmax ) )
+	{
+		// The closest points involve either a segment end or a box edge
+		q3Vec3 cs, cb;
+		r32 distSq = Q3_R32_MAX;
+
+		for ( i32 i = 0; i < 2; ++i )
+		{
+			q3Vec3 p = i ? p1 : p0;
+			q3Vec3 q( q3Clamp( -e.x, e.x, p.x ), q3Clamp( -e.y, e.y, p.y ), q3Clamp( -e.z, e.z, p.z ) );
+			r32 l = q3DistanceSq( p, q );
+
+			if ( l < distSq )
+			{
+				distSq = l;
+				cs = p;
+				cb = q;
+			}
+		}
+
+		for ( i32 i = 0; i < 3; ++i )
+		{
+			i32 j = (i + 1) % 3;
+			i32 k = (i + 2) % 3;
+
+			for ( i32 c = 0; c < 4; ++c )
+			{
+				q3Vec3 u, v;
+				u[ i ] = -e[ i ];
+				v[ i ] = e[ i ];
+				u[ j ] = v[ j ] = (c & 1) ? e[ j ] : -e[ j ];
+				u[ k ] = v[ k ] = (c & 2) ? e[ k ] : -e[ k ];
+
+				q3Vec3 ps, pb;
+				q3SegmentsClosestPoints( &ps, &pb, p0, p1, u, v );
+				r32 l = q3DistanceSq( ps, pb );
+
+				if ( l < distSq )
+				{
+					distSq = l;
+					cs = ps;
+					cb = pb;
+				}
+			}
+		}
+
+		if ( distSq > r * r )
+			return;
+
+		r32 dist = std::sqrt( distSq );
+		n = (cs - cb) / dist;
+
+		// Resting upon a face can support two contacts
+		for ( i32 i = 0; i < 3; ++i )
+		{
+			if ( q3Abs( n[ i ] ) > r32( 1.0 ) - k_roundEpsilon )
+			{
+				axis = i;
+				s = q3Sign( n[ i ] );
+			}
+		}
+
+		if ( axis == -1 )
+		{
+			m->normal = q3Mul( btx.rotation, -n );
+			q3PushContact( m, q3Mul( btx, (cs - n * r + cb) * r32( 0.5 ) ), dist - r, 0 );
+			return;
+		}
+	}
+
+	// Segment within the box, push out through the face of least penetration
+	else
+	{
+		r32 sMax = -Q3_R32_MAX;
+
+		for ( i32 i = 0; i < 3; ++i )
+		{
+			r32 lo = q3Min( p0[ i ], p1[ i ] );
+			r32 hi = q3Max( p0[ i ], p1[ i ] );
+			r32 sPos = lo - r - e[ i ];
+			r32 sNeg = -e[ i ] - hi - r;
+
+			if ( sPos > sMax )
+			{
+				sMax = sPos;
+				axis = i;
+				s = r32( 1.0 );
+			}
+
+			if ( sNeg > sMax )
+			{
+				sMax = sNeg;
+				axis = i;
+				s = r32( -1.0 );
+			}
+		}
+	}
+
+	q3HalfSpace sides[ 4 ];
+	i32 j = (axis + 1) % 3;
+	i32 k = (axis + 2) % 3;
+	n = q3Vec3( r32( 0.0 ), r32( 0.0 ), r32( 0.0 ) );
+	n[ j ] = r32( 1.0 );
+	sides[ 0 ] = q3HalfSpace( n, e[ j ] );
+	sides[ 1 ] = q3HalfSpace( -n, e[ j ] );
+	n[ j ] = r32( 0.0 );
+	n[ k ] = r32( 1.0 );
+	sides[ 2 ] = q3HalfSpace( n, e[ k ] );
+	sides[ 3 ] = q3HalfSpace( -n, e[ k ] );
+	n[ k ] = r32( 0.0 );
+	n[ axis ] = s;
+
+	if ( !q3SegmenttoFace( m, p0, p1, r, sides, 4, q3HalfSpace( n, e[ axis ] ) ) )
+		return;
+
+	m->normal = q3Mul( btx.rotation, -n );
+
+	for ( i32 i = 0; i < m->contactCount; ++i )
+		m->contacts[ i ].position = q3Mul( btx, m->contacts[ i ].position );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3CapsuletoTriangle( q3Manifold* m, q3Capsule* a, const q3Vec3& v0, const q3Vec3& v1, const q3Vec3& v2 )
+{
+	q3Transform atx = a->body->GetTransform( );
+	q3Vec3 p0, p1;
+	a->GetSegment( &p0, &p1 );
+	p0 = q3Mul( atx, p0 );
+	p1 = q3Mul( atx, p1 );
+	r32 r = a->radius;
+
+	q3Vec3 normal = q3Cross( v1 - v0, v2 - v0 );
+	r32 area = q3Length( normal );
+
+	// Degenerate triangle
+	if ( area < r32( 1.0e-8 ) )
+		return;
+
+	normal /= area;
+
+	q3RaycastData ray;
+	ray.start = p0;
+	ray.dir = p1 - p0;
+	ray.t = r32( 1.0 );
+	q3Vec3 n;
+
+	if ( !q3RaycastTriangle( v0, v1, v2, &ray ) )
+	{
+		// The closest points involve either a segment end or a triangle edge
+		q3Vec3 v[ 3 ] = { v0, v1, v2 };
+		q3Vec3 cs = p0;
+		q3Vec3 ct = q3ClosestPointOnTriangle( p0, v0, v1, v2 );
+		r32 distSq = q3DistanceSq( cs, ct );
+
+		q3Vec3 q = q3ClosestPointOnTriangle( p1, v0, v1, v2 );
+
+		if ( q3DistanceSq( p1, q ) < distSq )
+		{
+			distSq = q3DistanceSq( p1, q );
+			cs = p1;
+			ct = q;
+		}
+
+		for ( i32 i = 0; i < 3; ++i )
+		{
+			q3Vec3 ps, pt;
+			q3SegmentsClosestPoints( &ps, &pt, p0, p1, v[ i ], v[ (i + 1) % 3 ] );
+			r32 l = q3DistanceSq( ps, pt );
+
+			if ( l < distSq )
+			{
+				distSq = l;
+				cs = ps;
+				ct = pt;
+			}
+		}
+
+		if ( distSq > r * r )
+			return;
+
+		r32 dist = std::sqrt( distSq );
+
+		if ( dist < k_roundEpsilon )
+			return;
+
+		n = (cs - ct) / dist;
+
+		// Anything other than the face makes a single contact
+		if ( q3Abs( q3Dot( n, normal ) ) < r32( 1.0 ) - k_roundEpsilon )
+		{
+			m->normal = -n;
+			q3PushContact( m, (cs - n * r + ct) * r32( 0.5 ), dist - r, 0 );
+			return;
+		}
+
+		n = q3Dot( n, normal ) > r32( 0.0 ) ? normal : -normal;
+	}
+
+	// Segment passes through the triangle, push out towards the nearer side
+	else
+	{
+		r32 d0 = q3Dot( p0 - v0, normal );
+		r32 d1 = q3Dot( p1 - v0, normal );
+		n = q3Max( d0, d1 ) >= -q3Min( d0, d1 ) ? normal : -normal;
+	}
+
+	q3HalfSpace sides[ 3 ];
+	q3Vec3 v[ 3 ] = { v0, v1, v2 };
+
+	for ( i32 i = 0; i < 3; ++i )
+	{
+		q3Vec3 o = q3Normalize( q3Cross( v[ (i + 1) % 3 ] - v[ i ], normal ) );
+		sides[ i ] = q3HalfSpace( o, q3Dot( o, v[ i ] ) );
+	}
+
+	if ( q3SegmenttoFace( m, p0, p1, r, sides, 3, q3HalfSpace( n, q3Dot( n, v0 ) ) ) )
+		m->normal = -n;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Hulls
+//--------------------------------------------------------------------------------------------------
+// Boxes, hulls and triangles are all viewed as polyhedra with half-edge
+// topology, so that a single SAT handles every pairing. Face axes are
+// tested by support queries. Edge axes are only tested for edge pairs that
+// form a face of the Minkowski difference, found by intersecting arcs upon
+// the Gauss map, which removes most of the edge pairs of larger hulls.
+// Resources:
+// http://media.steampowered.com/apps/valve/2015/DirkGregorius_Contacts.pdf
+struct q3Polyhedron
+{
+	const q3Vec3* vertices;
+	const q3HullHalfEdge* edges;
+	const q3HullFace* faces;
+	const q3HalfSpace* planes;
+	i32 vertexCount;
+	i32 edgeCount;
+	i32 faceCount;
+	q3Vec3 centroid;
+};
+
+//--------------------------------------------------------------------------------------------------
+// Face loops of the box, in the vertex order of q3Box::Render
+const q3HullHalfEdge k_boxEdges[ 24 ] = {
+	{ 1, 17, 2, 0 }, { 2, 8, 0, 0 }, { 3, 20, 1, 0 }, { 0, 13, 3, 0 },
+	{ 5, 10, 5, 1 }, { 6, 19, 4, 1 }, { 7, 15, 6, 1 }, { 4, 22, 7, 1 },
+	{ 9, 1, 1, 2 }, { 10, 16, 0, 2 }, { 11, 4, 4, 2 }, { 8, 21, 5, 2 },
+	{ 13, 18, 6, 3 }, { 14, 3, 2, 3 }, { 15, 23, 3, 3 }, { 12, 6, 7, 3 },
+	{ 17, 9, 4, 4 }, { 18, 0, 0, 4 }, { 19, 12, 2, 4 }, { 16, 5, 6, 4 },
+	{ 21, 2, 3, 5 }, { 22, 11, 1, 5 }, { 23, 7, 5, 5 }, { 20, 14, 7, 5 },
+};
+
+const q3HullFace k_boxFaces[ 6 ] = { { 0 }, { 4 }, { 8 }, { 12 }, { 16 }, { 20 } };
+
+// Triangles have a front and back face
+const q3HullHalfEdge k_triangleEdges[ 6 ] = {
+	{ 1, 5, 0, 0 }, { 2, 4, 1, 0 }, { 0, 3, 2, 0 },
+	{ 4, 2, 0, 1 }, { 5, 1, 2, 1 }, { 3, 0, 1, 1 },
+};
+
+const q3HullFace k_triangleFaces[ 2 ] = { { 0 }, { 3 } };
+
+//--------------------------------------------------------------------------------------------------
+inline void q3HullPolyhedron( const q3Hull* hull, q3Polyhedron* p )
+{
+	p->vertices = hull->vertices;
+	p->edges = hull->edges;
+	p->faces = hull->faces;
+	p->planes = hull->planes;
+	p->vertexCount = hull->vertexCount;
+	p->edgeCount = hull->edgeCount;
+	p->faceCount = hull->faceCount;
+	p->centroid = hull->centroid;
+}
+
+//--------------------------------------------------------------------------------------------------
+// vertices and planes must hold 8 and 6 elements
+void q3BoxPolyhedron( const q3Vec3& e, q3Vec3* vertices, q3HalfSpace* planes, q3Polyhedron* p )
+{
+	for ( i32 i = 0; i < 8; ++i )
+	{
+		vertices[ i ].Set(
+			(i & 4) ? e.x : -e.x,
+			(i & 2) ? e.y : -e.y,
+			(i & 1) ? e.z : -e.z
+			);
+	}
+
+	for ( i32 i = 0; i < 3; ++i )
+	{
+		q3Vec3 n( r32( 0.0 ), r32( 0.0 ), r32( 0.0 ) );
+		n[ i ] = r32( 1.0 );
+		planes[ i * 2 ] = q3HalfSpace( -n, e[ i ] );
+		planes[ i * 2 + 1 ] = q3HalfSpace( n, e[ i ] );
+	}
+
+	p->vertices = vertices;
+	p->edges = k_boxEdges;
+	p->faces = k_boxFaces;
+	p->planes = planes;
+	p->vertexCount = 8;
+	p->edgeCount = 24;
+	p->faceCount = 6;
+	p->centroid.SetAll( r32( 0.0 ) );
+}
+
+//--------------------------------------------------------------------------------------------------
+// planes must hold 2 elements, returns false for degenerate triangles
+bool q3TrianglePolyhedron( const q3Vec3* vertices, q3HalfSpace* planes, q3Polyhedron* p )
+{
+	q3Vec3 n = q3Cross( vertices[ 1 ] - vertices[ 0 ], vertices[ 2 ] - vertices[ 0 ] );
+	r32 area = q3Length( n );
+
+	if ( area < r32( 1.0e-8 ) )
+		return false;
+
+	n /= area;
+	planes[ 0 ] = q3HalfSpace( n, q3Dot( n, vertices[ 0 ] ) );
+	planes[ 1 ] = q3HalfSpace( -n, -planes[ 0 ].distance );
+
+	p->vertices = vertices;
+	p->edges = k_triangleEdges;
+	p->faces = k_triangleFaces;
+	p->planes = planes;
+	p->vertexCount = 3;
+	p->edgeCount = 6;
+	p->faceCount = 2;
+	p->centroid = (vertices[ 0 ] + vertices[ 1 ] + vertices[ 2 ]) / r32( 3.0 );
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Finds the face of a with the greatest separation from the vertices of b.
+// The vertices of b must be given in the space of a.
+r32 q3QueryFaces( const q3Polyhedron& a, const q3Vec3* bVertices, i32 bCount, i32* face )
+{
+	r32 sMax = -Q3_R32_MAX;
+
+	for ( i32 i = 0; i < a.faceCount; ++i )
+	{
+		const q3HalfSpace& h = a.planes[ i ];
+		r32 s = Q3_R32_MAX;
+
+		for ( i32 j = 0; j < bCount; ++j )
+			s = q3Min( s, h.Distance( bVertices[ j ] ) );
+
+		if ( s > sMax )
+		{
+			sMax = s;
+			*face = i;
+
+			if ( s > r32( 0.0 ) )
+				break;
+		}
+	}
+
+	return sMax;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Arcs a-b and c-d upon the Gauss map intersect when the two edges form a
+// face of the Minkowski difference. c and d are the negated normals of the
+// second edge.
+inline bool q3IsMinkowskiFace( const q3Vec3& a, const q3Vec3& b, const q3Vec3& c, const q3Vec3& d )
+{
+	q3Vec3 bxa = q3Cross( b, a );
+	q3Vec3 dxc = q3Cross( d, c );
+	r32 cba = q3Dot( c, bxa );
+	r32 dba = q3Dot( d, bxa );
+	r32 adc = q3Dot( a, dxc );
+	r32 bdc = q3Dot( b, dxc );
+
+	return cba * dba < r32( 0.0 ) && adc * bdc < r32( 0.0 ) && cba * bdc > r32( 0.0 );
+}
+
+//--------------------------------------------------------------------------------------------------
+// Gauss map arcs of an edge. The edge between the two faces of a triangle
+// spans half a circle, so it is split into two arcs through the outward
+// direction of the edge. Returns the number of arcs.
+i32 q3EdgeArcs( const q3Polyhedron& p, const q3Mat3& r, i32 edge, q3Vec3* arcs )
+{
+	const q3HullHalfEdge* e = p.edges + edge;
+	q3Vec3 u = p.planes[ e->face ].normal;
+	q3Vec3 v = p.planes[ p.edges[ e->twin ].face ].normal;
+
+	if ( q3Dot( u, v ) > r32( -1.0 ) + k_roundEpsilon )
+	{
+		arcs[ 0 ] = r * u;
+		arcs[ 1 ] = r * v;
+		return 1;
+	}
+
+	q3Vec3 d = p.vertices[ p.edges[ e->next ].origin ] - p.vertices[ e->origin ];
+	q3Vec3 o = q3Normalize( q3Cross( d, u ) );
+	arcs[ 0 ] = r * u;
+	arcs[ 1 ] = r * o;
+	arcs[ 2 ] = r * o;
+	arcs[ 3 ] = r * v;
+
+	return 2;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Finds the edge pair of greatest separation within the space of a. The
+// vertices of b must be given in the space of a, and r rotates b into a.
+r32 q3QueryEdges( const q3Polyhedron& a, const q3Polyhedron& b, const q3Vec3* bVertices, const q3Mat3& r, i32* edgeA, i32* edgeB, q3Vec3* axis )
+{
+	q3Mat3 identity;
+	q3Identity( identity );
+	q3Mat3 negate = r * r32( -1.0 );
+	r32 sMax = -Q3_R32_MAX;
+
+	for ( i32 i = 0; i < a.edgeCount; ++i )
+	{
+		const q3HullHalfEdge* ea = a.edges + i;
+
+		// Each edge is made of two half-edges
+		if ( ea->twin < i )
+			continue;
+
+		q3Vec3 arcsA[ 4 ];
+		i32 arcCountA = q3EdgeArcs( a, identity, i, arcsA );
+		q3Vec3 pa = a.vertices[ ea->origin ];
+		q3Vec3 da = a.vertices[ a.edges[ ea->next ].origin ] - pa;
+
+		for ( i32 j = 0; j < b.edgeCount; ++j )
+		{
+			const q3HullHalfEdge* eb = b.edges + j;
+
+			if ( eb->twin < j )
+				continue;
+
+			q3Vec3 arcsB[ 4 ];
+			i32 arcCountB = q3EdgeArcs( b, negate, j, arcsB );
+			bool minkowskiFace = false;
+
+			for ( i32 k = 0; k < arcCountA; ++k )
+			{
+				for ( i32 l = 0; l < arcCountB; ++l )
+				{
+					if ( q3IsMinkowskiFace( arcsA[ k * 2 ], arcsA[ k * 2 + 1 ], arcsB[ l * 2 ], arcsB[ l * 2 + 1 ] ) )
+						minkowskiFace = true;
+				}
+			}
+
+			if ( !minkowskiFace )
+				continue;
+
+			q3Vec3 pb = bVertices[ eb->origin ];
+			q3Vec3 db = bVertices[ b.edges[ eb->next ].origin ] - pb;
+			q3Vec3 n = q3Cross( da, db );
+			r32 l = q3Length( n );
+
+			// Parallel edges are covered by the face axes
+			if ( l < r32( 1.0e-5 ) * q3Length( da ) * q3Length( db ) )
+				continue;
+
+			n /= l;
+
+			if ( q3Dot( n, pa - a.centroid ) < r32( 0.0 ) )
+				n = -n;
+
+			r32 s = q3Dot( n, pb - pa );
+
+			if ( s > sMax )
+			{
+				sMax = s;
+				*edgeA = i;
+				*edgeB = j;
+				*axis = n;
+
+				if ( s > r32( 0.0 ) )
+					return s;
+			}
+		}
+	}
+
+	return sMax;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Keeps four of the contacts: the deepest, the furthest from it, and the
+// two that maximize the area of the resulting quad.
+i32 q3ReduceContacts( const q3Vec3& n, q3ClipVertex* points, r32* depths, i32 count )
+{
+	i32 index[ 4 ] = { 0, 0, 0, 0 };
+
+	for ( i32 i = 1; i < count; ++i )
+	{
+		if ( depths[ i ] < depths[ index[ 0 ] ] )
+			index[ 0 ] = i;
+	}
+
+	q3Vec3 a = points[ index[ 0 ] ].v;
+	r32 best = -Q3_R32_MAX;
+
+	for ( i32 i = 0; i < count; ++i )
+	{
+		r32 d = q3DistanceSq( points[ i ].v, a );
+
+		if ( d > best )
+		{
+			best = d;
+			index[ 1 ] = i;
+		}
+	}
+
+	q3Vec3 b = points[ index[ 1 ] ].v;
+	r32 areaMax = -Q3_R32_MAX;
+	r32 areaMin = Q3_R32_MAX;
+
+	for ( i32 i = 0; i < count; ++i )
+	{
+		r32 area = q3Dot( q3Cross( a - points[ i ].v, b - points[ i ].v ), n );
+
+		if ( area > areaMax )
+		{
+			areaMax = area;
+			index[ 2 ] = i;
+		}
+
+		if ( area < areaMin )
+		{
+			areaMin = area;
+			index[ 3 ] = i;
+		}
+	}
+
+	q3ClipVertex keptPoints[ 4 ];
+	r32 keptDepths[ 4 ];
+
+	for ( i32 i = 0; i < 4; ++i )
+	{
+		keptPoints[ i ] = points[ index[ i ] ];
+		keptDepths[ i ] = depths[ index[ i ] ];
+	}
+
+	for ( i32 i = 0; i < 4; ++i )
+	{
+		points[ i ] = keptPoints[ i ];
+		depths[ i ] = keptDepths[ i ];
+	}
+
+	return 4;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Clips the incident face of i against the side planes of the reference
+// face of r, flip is set when r is the second shape of the pair.
+void q3PolyhedraFaceContact( q3Manifold* m, const q3Polyhedron& r, const q3Transform& rtx, i32 face, const q3Polyhedron& i, const q3Transform& itx, bool flip )
+{
+	q3Vec3 n = q3Mul( rtx.rotation, r.planes[ face ].normal );
+	q3Vec3 ni = q3MulT( itx.rotation, n );
+
+	// Incident face is the most anti-parallel to the reference face
+	i32 incidentFace = 0;
+	r32 dMin = Q3_R32_MAX;
+
+	for ( i32 k = 0; k < i.faceCount; ++k )
+	{
+		r32 d = q3Dot( i.planes[ k ].normal, ni );
+
+		if ( d < dMin )
+		{
+			dMin = d;
+			incidentFace = k;
+		}
+	}
+
+	q3ClipVertex incident[ k_maxClipVertices ];
+	i32 incidentCount = 0;
+	i32 first = i.faces[ incidentFace ].edge;
+	i32 edge = first;
+	i32 prev = first;
+
+	// The loop ends upon the half-edge preceding the first
+	do
+	{
+		prev = edge;
+		edge = i.edges[ edge ].next;
+	} while ( edge != first );
+
+	do
+	{
+		q3ClipVertex* cv = incident + incidentCount++;
+		cv->v = q3Mul( itx, i.vertices[ i.edges[ edge ].origin ] );
+		cv->f.key = 0;
+		cv->f.inI = u8( prev );
+		cv->f.outI = u8( edge );
+		prev = edge;
+		edge = i.edges[ edge ].next;
+	} while ( edge != first );
+
+	q3HalfSpace planes[ Q3_MAX_HULL_VERTICES ];
+	u8 planeIds[ Q3_MAX_HULL_VERTICES ];
+	i32 planeCount = 0;
+	edge = r.faces[ face ].edge;
+
+	do
+	{
+		q3Vec3 p = q3Mul( rtx, r.vertices[ r.edges[ edge ].origin ] );
+		q3Vec3 q = q3Mul( rtx, r.vertices[ r.edges[ r.edges[ edge ].next ].origin ] );
+		planes[ planeCount ].Set( q3Normalize( q3Cross( q - p, n ) ), p );
+		planeIds[ planeCount++ ] = u8( edge );
+		edge = r.edges[ edge ].next;
+	} while ( edge != r.faces[ face ].edge );
+
+	q3ClipVertex out[ k_maxClipVertices ];
+	r32 depths[ k_maxClipVertices ];
+	i32 clipped = q3ClipPolygon( planes, planeIds, planeCount, incident, incidentCount, out );
+	r32 distance = q3Dot( n, q3Mul( rtx, r.planes[ face ].normal * r.planes[ face ].distance ) );
+	i32 outNum = 0;
+
+	// Keep incident vertices behind the reference face
+	for ( i32 k = 0; k < clipped; ++k )
+	{
+		r32 d = q3Dot( n, out[ k ].v ) - distance;
+
+		if ( d <= r32( 0.0 ) )
+		{
+			out[ outNum ] = out[ k ];
+			depths[ outNum++ ] = d;
+		}
+	}
+
+	if ( outNum > 8 )
+		outNum = q3ReduceContacts( n, out, depths, outNum );
+
+	m->contactCount = outNum;
+	m->normal = flip ? -n : n;
+
+	for ( i32 k = 0; k < outNum; ++k )
+	{
+		q3Contact* c = m->contacts + k;
+		q3FeaturePair pair = out[ k ].f;
+
+		if ( flip )
+		{
+			std::swap( pair.inI, pair.inR );
+			std::swap( pair.outI, pair.outR );
+		}
+
+		c->fp = pair;
+		c->position = out[ k ].v;
+		c->penetration = depths[ k ];
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+// The normal points from a to b
+void q3PolyhedraContact( q3Manifold* m, const q3Polyhedron& a, const q3Transform& atx, const q3Polyhedron& b, const q3Transform& btx )
+{
+	// Transform each into the space of the other
+	q3Transform ba = q3MulT( atx, btx );
+	q3Vec3 bVertices[ Q3_MAX_HULL_VERTICES ];
+	q3Vec3 aVertices[ Q3_MAX_HULL_VERTICES ];
+
+	for ( i32 i = 0; i < b.vertexCount; ++i )
+		bVertices[ i ] = q3Mul( ba, b.vertices[ i ] );
+
+	for ( i32 i = 0; i < a.vertexCount; ++i )
+		aVertices[ i ] = q3MulT( ba, a.vertices[ i ] );
+
+	i32 faceA = 0;
+	r32 aMax = q3QueryFaces( a, bVertices, b.vertexCount, &faceA );
+	if ( aMax > r32( 0.0 ) )
+		return;
+
+	i32 faceB = 0;
+	r32 bMax = q3QueryFaces( b, aVertices, a.vertexCount, &faceB );
+	if ( bMax > r32( 0.0 ) )
+		return;
+
+	i32 edgeA = -1;
+	i32 edgeB = -1;
+	q3Vec3 axis;
+	r32 eMax = q3QueryEdges( a, b, bVertices, ba.rotation, &edgeA, &edgeB, &axis );
+	if ( eMax > r32( 0.0 ) )
+		return;
+
+	// Artificial axis bias to improve frame coherence
+	const r32 kRelTol = r32( 0.95 );
+	const r32 kAbsTol = r32( 0.01 );
+	r32 faceMax = q3Max( aMax, bMax );
+
+	if ( edgeA != -1 && kRelTol * eMax > faceMax + kAbsTol )
+	{
+		q3Vec3 PA = q3Mul( atx, a.vertices[ a.edges[ edgeA ].origin ] );
+		q3Vec3 QA = q3Mul( atx, a.vertices[ a.edges[ a.edges[ edgeA ].next ].origin ] );
+		q3Vec3 PB = q3Mul( btx, b.vertices[ b.edges[ edgeB ].origin ] );
+		q3Vec3 QB = q3Mul( btx, b.vertices[ b.edges[ b.edges[ edgeB ].next ].origin ] );
+
+		q3Vec3 CA, CB;
+		q3EdgesContact( &CA, &CB, PA, QA, PB, QB );
+
+		m->normal = q3Mul( atx.rotation, axis );
+		m->contactCount = 1;
+
+		q3Contact* c = m->contacts;
+		q3FeaturePair pair;
+		pair.key = 0;
+		pair.inR = u8( edgeA );
+		pair.inI = u8( edgeB );
+		c->fp = pair;
+		c->penetration = eMax;
+		c->position = (CA + CB) * r32( 0.5 );
+	}
+
+	else if ( kRelTol * bMax > aMax + kAbsTol )
+		q3PolyhedraFaceContact( m, b, btx, faceB, a, atx, true );
+
+	else
+		q3PolyhedraFaceContact( m, a, atx, faceA, b, btx, false );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3HulltoHull( q3Manifold* m, q3Hull* a, q3Hull* b )
+{
+	q3Polyhedron pa, pb;
+	q3HullPolyhedron( a, &pa );
+	q3HullPolyhedron( b, &pb );
+
+	q3Transform atx = q3Mul( a->body->GetTransform( ), a->local );
+	q3Transform btx = q3Mul( b->body->GetTransform( ), b->local );
+
+	q3PolyhedraContact( m, pa, atx, pb, btx );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3BoxtoHull( q3Manifold* m, q3Box* a, q3Hull* b )
+{
+	q3Vec3 vertices[ 8 ];
+	q3HalfSpace planes[ 6 ];
+	q3Polyhedron pa, pb;
+	q3BoxPolyhedron( a->e, vertices, planes, &pa );
+	q3HullPolyhedron( b, &pb );
+
+	q3Transform atx = q3Mul( a->body->GetTransform( ), a->local );
+	q3Transform btx = q3Mul( b->body->GetTransform( ), b->local );
+
+	q3PolyhedraContact( m, pa, atx, pb, btx );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3HulltoTriangle( q3Manifold* m, q3Hull* a, const q3Vec3& v0, const q3Vec3& v1, const q3Vec3& v2 )
+{
+	q3Vec3 vertices[ 3 ] = { v0, v1, v2 };
+	q3HalfSpace planes[ 2 ];
+	q3Polyhedron pa, pb;
+	q3HullPolyhedron( a, &pa );
+
+	if ( !q3TrianglePolyhedron( vertices, planes, &pb ) )
+		return;
+
+	q3Transform identity;
+	q3Identity( identity );
+
+	q3PolyhedraContact( m, pa, q3Mul( a->body->GetTransform( ), a->local ), pb, identity );
+}
+
+//--------------------------------------------------------------------------------------------------
+// Side planes of a hull face, facing away from the face's interior
+i32 q3HullFaceSides( const q3Hull* hull, i32 face, q3HalfSpace* sides )
+{
+	const q3Vec3& n = hull->planes[ face ].normal;
+	i32 first = hull->faces[ face ].edge;
+	i32 edge = first;
+	i32 count = 0;
+
+	do
+	{
+		const q3HullHalfEdge* e = hull->edges + edge;
+		q3Vec3 p = hull->vertices[ e->origin ];
+		q3Vec3 q = hull->vertices[ hull->edges[ e->next ].origin ];
+		sides[ count++ ].Set( q3Normalize( q3Cross( q - p, n ) ), p );
+		edge = e->next;
+	} while ( edge != first );
+
+	return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Closest point upon the surface of a hull to a point outside of it, within
+// the space of the hull
+const q3Vec3 q3ClosestPointOnHull( const q3Hull* hull, const q3Vec3& p )
+{
+	q3Vec3 closest = p;
+	r32 distSq = Q3_R32_MAX;
+
+	for ( i32 i = 0; i < hull->faceCount; ++i )
+	{
+		r32 d = hull->planes[ i ].Distance( p );
+
+		if ( d <= r32( 0.0 ) )
+			continue;
+
+		// The projection is closest when within the face
+		q3HalfSpace sides[ Q3_MAX_HULL_VERTICES ];
+		i32 sideCount = q3HullFaceSides( hull, i, sides );
+		bool inside = true;
+
+		for ( i32 j = 0; j < sideCount; ++j )
+			inside = inside && sides[ j ].Distance( p ) <= r32( 0.0 );
+
+		if ( inside && d * d < distSq )
+		{
+			distSq = d * d;
+			closest = p - hull->planes[ i ].normal * d;
+		}
+	}
+
+	for ( i32 i = 0; i < hull->edgeCount; ++i )
+	{
+		const q3HullHalfEdge* e = hull->edges + i;
+
+		if ( e->twin < i )
+			continue;
+
+		q3Vec3 q = q3ClosestPointOnSegment( p, hull->vertices[ e->origin ], hull->vertices[ hull->edges[ e->next ].origin ] );
+		r32 l = q3DistanceSq( p, q );
+
+		if ( l < distSq )
+		{
+			distSq = l;
+			closest = q;
+		}
+	}
+
+	return closest;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Face of the hull with the greatest separation from a point
+inline r32 q3HullMaxSeparation( const q3Hull* hull, const q3Vec3& p, i32* face )
+{
+	r32 sMax = -Q3_R32_MAX;
+
+	for ( i32 i = 0; i < hull->faceCount; ++i )
+	{
+		r32 s = hull->planes[ i ].Distance( p );
+
+		if ( s > sMax )
+		{
+			sMax = s;
+			*face = i;
+		}
+	}
+
+	return sMax;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3SpheretoHull( q3Manifold* m, q3Sphere* a, q3Hull* b )
+{
+	// Work in the space of the hull
+	q3Transform btx = q3Mul( b->body->GetTransform( ), b->local );
+	q3Vec3 c = q3MulT( btx, q3Mul( a->body->GetTransform( ), a->local.position ) );
+	r32 r = a->radius;
+
+	i32 face = 0;
+	r32 s = q3HullMaxSeparation( b, c, &face );
+
+	if ( s > r )
+		return;
+
+	q3Vec3 n;
+	q3Vec3 q;
+	r32 penetration;
+
+	// Center within the hull, push out through the closest face
+	if ( s <= r32( 0.0 ) )
+	{
+		n = -b->planes[ face ].normal;
+		q = c + n * s;
+		penetration = s - r;
+	}
+
+	else
+	{
+		q = q3ClosestPointOnHull( b, c );
+		r32 distSq = q3DistanceSq( c, q );
+
+		if ( distSq > r * r )
+			return;
+
+		r32 dist = std::sqrt( distSq );
+		n = (q - c) / dist;
+		penetration = dist - r;
+	}
+
+	m->normal = q3Mul( btx.rotation, n );
+	q3PushContact( m, q3Mul( btx, (c + n * r + q) * r32( 0.5 ) ), penetration, 0 );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3CapsuletoHull( q3Manifold* m, q3Capsule* a, q3Hull* b )
+{
+	// Work in the space of the hull
+	q3Transform btx = q3Mul( b->body->GetTransform( ), b->local );
+	q3Transform atx = q3MulT( btx, a->body->GetTransform( ) );
+	q3Vec3 p0, p1;
+	a->GetSegment( &p0, &p1 );
+	p0 = q3Mul( atx, p0 );
+	p1 = q3Mul( atx, p1 );
+	r32 r = a->radius;
+
+	// Clip the segment against the hull's planes to test for intersection
+	q3Vec3 d = p1 - p0;
+	r32 t0 = r32( 0.0 );
+	r32 t1 = r32( 1.0 );
+	bool intersects = true;
+
+	for ( i32 i = 0; i < b->faceCount && intersects; ++i )
+	{
+		r32 da = b->planes[ i ].Distance( p0 );
+		r32 dd = q3Dot( b->planes[ i ].normal, d );
+
+		if ( q3Abs( dd ) < k_roundEpsilon )
+			intersects = da <= r32( 0.0 );
+
+		else
+		{
+			r32 t = -da / dd;
+
+			if ( dd > r32( 0.0 ) )
+				t1 = q3Min( t1, t );
+			else
+				t0 = q3Max( t0, t );
+
+			intersects = t0 <= t1;
+		}
+	}
+
+	i32 face = -1;
+
+	if ( !intersects )
+	{
+		// The closest points involve either a segment end or a hull edge
+		q3Vec3 cs, cb;
+		r32 distSq = Q3_R32_MAX;
+
+		for ( i32 i = 0; i < 2; ++i )
+		{
+			q3Vec3 p = i ? p1 : p0;
+			q3Vec3 q = q3ClosestPointOnHull( b, p );
+			r32 l = q3DistanceSq( p, q );
+
+			if ( l < distSq )
+			{
+				distSq = l;
+				cs = p;
+				cb = q;
+			}
+		}
+
+		for ( i32 i = 0; i < b->edgeCount; ++i )
+		{
+			const q3HullHalfEdge* e = b->edges + i;
+
+			if ( e->twin < i )
+				continue;
+
+			q3Vec3 ps, pb;
+			q3SegmentsClosestPoints( &ps, &pb, p0, p1, b->vertices[ e->origin ], b->vertices[ b->edges[ e->next ].origin ] );
+			r32 l = q3DistanceSq( ps, pb );
+
+			if ( l < distSq )
+			{
+				distSq = l;
+				cs = ps;
+				cb = pb;
+			}
+		}
+
+		if ( distSq > r * r )
+			return;
+
+		r32 dist = std::sqrt( distSq );
+
+		if ( dist < k_roundEpsilon )
+			return;
+
+		q3Vec3 n = (cs - cb) / dist;
+
+		// Resting upon a face can support two contacts
+		for ( i32 i = 0; i < b->faceCount; ++i )
+		{
+			if ( q3Dot( n, b->planes[ i ].normal ) > r32( 1.0 ) - k_roundEpsilon )
+				face = i;
+		}
+
+		if ( face == -1 )
+		{
+			m->normal = q3Mul( btx.rotation, -n );
+			q3PushContact( m, q3Mul( btx, (cs - n * r + cb) * r32( 0.5 ) ), dist - r, 0 );
+			return;
+		}
+	}
+
+	// Segment within the hull, push out through the face of least penetration
+	else
+	{
+		r32 sMax = -Q3_R32_MAX;
+
+		for ( i32 i = 0; i < b->faceCount; ++i )
+		{
+			r32 s = q3Min( b->planes[ i ].Distance( p0 ), b->planes[ i ].Distance( p1 ) ) - r;
+
+			if ( s > sMax )
+			{
+				sMax = s;
+				face = i;
+			}
+		}
+	}
+
+	q3HalfSpace sides[ Q3_MAX_HULL_VERTICES ];
+	i32 sideCount = q3HullFaceSides( b, face, sides );
+
+	if ( !q3SegmenttoFace( m, p0, p1, r, sides, sideCount, b->planes[ face ] ) )
+		return;
+
+	m->normal = q3Mul( btx.rotation, -b->planes[ face ].normal );
+
+	for ( i32 i = 0; i < m->contactCount; ++i )
+		m->contacts[ i ].position = q3Mul( btx, m->contacts[ i ].position );
+}
+
+//--------------------------------------------------------------------------------------------------
+// Planes
+//--------------------------------------------------------------------------------------------------
+// Planes collide by keeping the points of the other shape found below them,
+// each point making a contact keyed by its index. This never requires more
+// than a handful of dot products.
+void q3SpheretoPlane( q3Manifold* m, q3Sphere* a, q3Plane* b )
+{
+	q3HalfSpace plane = b->GetPlane( b->body->GetTransform( ) );
+	q3Vec3 c = q3Mul( a->body->GetTransform( ), a->local.position );
+	r32 r = a->radius;
+	r32 d = plane.Distance( c );
+
+	if ( d > r )
+		return;
+
+	m->normal = -plane.normal;
+	q3PushContact( m, c - plane.normal * (r32( 0.5 ) * (r + d)), d - r, 0 );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3CapsuletoPlane( q3Manifold* m, q3Capsule* a, q3Plane* b )
+{
+	q3HalfSpace plane = b->GetPlane( b->body->GetTransform( ) );
+	q3Transform atx = a->body->GetTransform( );
+	q3Vec3 p[ 2 ];
+	a->GetSegment( p, p + 1 );
+	r32 r = a->radius;
+
+	for ( i32 i = 0; i < 2; ++i )
+	{
+		q3Vec3 q = q3Mul( atx, p[ i ] );
+		r32 d = plane.Distance( q );
+
+		if ( d <= r )
+			q3PushContact( m, q - plane.normal * (r32( 0.5 ) * (r + d)), d - r, i );
+	}
+
+	m->normal = -plane.normal;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3BoxtoPlane( q3Manifold* m, q3Box* a, q3Plane* b )
+{
+	q3HalfSpace plane = b->GetPlane( b->body->GetTransform( ) );
+	q3Transform atx = q3Mul( a->body->GetTransform( ), a->local );
+	q3Vec3 e = a->e;
+
+	// Projected radius of the box along the normal
+	q3Vec3 n = q3MulT( atx.rotation, plane.normal );
+	r32 r = e.x * q3Abs( n.x ) + e.y * q3Abs( n.y ) + e.z * q3Abs( n.z );
+
+	if ( plane.Distance( atx.position ) > r )
+		return;
+
+	for ( i32 i = 0; i < 8; ++i )
+	{
+		q3Vec3 v(
+			(i & 4) ? e.x : -e.x,
+			(i & 2) ? e.y : -e.y,
+			(i & 1) ? e.z : -e.z
+			);
+
+		v = q3Mul( atx, v );
+		r32 d = plane.Distance( v );
+
+		if ( d <= r32( 0.0 ) )
+			q3PushContact( m, v, d, i );
+	}
+
+	m->normal = -plane.normal;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3HulltoPlane( q3Manifold* m, q3Hull* a, q3Plane* b )
+{
+	q3HalfSpace plane = b->GetPlane( b->body->GetTransform( ) );
+	q3Transform atx = q3Mul( a->body->GetTransform( ), a->local );
+
+	// Work in the space of the hull
+	q3HalfSpace h;
+	h.Set( q3MulT( atx.rotation, plane.normal ), q3MulT( atx, plane.Origin( ) ) );
+
+	if ( h.Distance( a->vertices[ a->GetSupport( -h.normal ) ] ) > r32( 0.0 ) )
+		return;
+
+	q3ClipVertex points[ Q3_MAX_HULL_VERTICES ];
+	r32 depths[ Q3_MAX_HULL_VERTICES ];
+	i32 count = 0;
+
+	for ( i32 i = 0; i < a->vertexCount; ++i )
+	{
+		r32 d = h.Distance( a->vertices[ i ] );
+
+		if ( d <= r32( 0.0 ) )
+		{
+			points[ count ].v = q3Mul( atx, a->vertices[ i ] );
+			points[ count ].f.key = i;
+			depths[ count++ ] = d;
+		}
+	}
+
+	if ( count > 8 )
+		count = q3ReduceContacts( plane.normal, points, depths, count );
+
+	for ( i32 i = 0; i < count; ++i )
+		q3PushContact( m, points[ i ].v, depths[ i ], points[ i ].f.key );
+
+	m->normal = -plane.normal;
+}
+
+//--------------------------------------------------------------------------------------------------
+// q3Collide
+//--------------------------------------------------------------------------------------------------
+bool q3Overlap( q3Shape* a, q3Shape* b, i32 childB )
+{
+	assert( a->type <= b->type );
+
+	if ( a->type == eBoxShape && b->type == eBoxShape )
+		return q3BoxtoBoxOverlap( (q3Box*)a, (q3Box*)b );
+
+	// The remaining routines are cheap next to the box SAT and clipping, or
+	// involve triangles and hulls that sensors seldom touch
+	q3Manifold m;
+	m.contactCount = 0;
+	m.margin = r32( 0.0 );
+	q3Collide( &m, a, b, childB );
+
+	return m.contactCount > 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Collide( q3Manifold* m, q3Shape* a, q3Shape* b, i32 childB )
+{
+	assert( a->type <= b->type );
+
+	if ( b->type == ePlaneShape )
+	{
+		switch ( a->type )
+		{
+		case eSphereShape:
+			q3SpheretoPlane( m, (q3Sphere*)a, (q3Plane*)b );
+			break;
+
+		case eCapsuleShape:
+			q3CapsuletoPlane( m, (q3Capsule*)a, (q3Plane*)b );
+			break;
+
+		case eBoxShape:
+			q3BoxtoPlane( m, (q3Box*)a, (q3Plane*)b );
+			break;
+
+		case eHullShape:
+			q3HulltoPlane( m, (q3Hull*)a, (q3Plane*)b );
+			break;
+
+		default:
+			// Planes only collide with shapes of finite volume
+			break;
+		}
+
+		return;
+	}
+
+	// Triangles of meshes and heightfields are collided in world space
+	if ( b->type == eMeshShape || b->type == eHeightfieldShape )
+	{
+		q3Vec3 v0, v1, v2;
+
+		if ( b->type == eMeshShape )
+			((q3Mesh*)b)->GetTriangle( childB, &v0, &v1, &v2 );
+		else
+			((q3Heightfield*)b)->GetTriangle( childB, &v0, &v1, &v2 );
+
+		q3Transform btx = b->body->GetTransform( );
+		v0 = q3Mul( btx, v0 );
+		v1 = q3Mul( btx, v1 );
+		v2 = q3Mul( btx, v2 );
+
+		switch ( a->type )
+		{
+		case eSphereShape:
+			q3SpheretoTriangle( m, (q3Sphere*)a, v0, v1, v2 );
+			break;
+
+		case eCapsuleShape:
+			q3CapsuletoTriangle( m, (q3Capsule*)a, v0, v1, v2 );
+			break;
+
+		case eBoxShape:
+			q3BoxtoTriangle( m, (q3Box*)a, v0, v1, v2 );
+			break;
+
+		case eHullShape:
+			q3HulltoTriangle( m, (q3Hull*)a, v0, v1, v2 );
+			break;
+
+		default:
+			// Meshes and heightfields are static and never collide with one another
+			break;
+		}
+
+		return;
+	}
+
+	switch ( a->type )
+	{
+	case eSphereShape:
+		switch ( b->type )
+		{
+		case eSphereShape:
+			q3SpheretoSphere( m, (q3Sphere*)a, (q3Sphere*)b );
+			break;
+
+		case eCapsuleShape:
+			q3SpheretoCapsule( m, (q3Sphere*)a, (q3Capsule*)b );
+			break;
+
+		case eBoxShape:
+			q3SpheretoBox( m, (q3Sphere*)a, (q3Box*)b );
+			break;
+
+		case eHullShape:
+			q3SpheretoHull( m, (q3Sphere*)a, (q3Hull*)b );
+			break;
+
+		default:
+			break;
+		}
+		break;
+
+	case eCapsuleShape:
+		switch ( b->type )
+		{
+		case eCapsuleShape:
+			q3CapsuletoCapsule( m, (q3Capsule*)a, (q3Capsule*)b );
+			break;
+
+		case eBoxShape:
+			q3CapsuletoBox( m, (q3Capsule*)a, (q3Box*)b );
+			break;
+
+		case eHullShape:
+			q3CapsuletoHull( m, (q3Capsule*)a, (q3Hull*)b );
+			break;
+
+		default:
+			break;
+		}
+		break;
+
+	case eBoxShape:
+		switch ( b->type )
+		{
+		case eBoxShape:
+			q3BoxtoBox( m, (q3Box*)a, (q3Box*)b );
+			break;
+
+		case eHullShape:
+			q3BoxtoHull( m, (q3Box*)a, (q3Hull*)b );
+			break;
+
+		default:
+			break;
+		}
+		break;
+
+	case eHullShape:
+		q3HulltoHull( m, (q3Hull*)a, (q3Hull*)b );
+		break;
+
+	default:
+		break;
+	}
+}
@@ -27,13 +27,52 @@
 #ifndef Q3COLLIDE_H
 #define Q3COLLIDE_H
 
+#include "q3Sphere.h"
+#include "q3Capsule.h"
 #include "q3Box.h"
+#include "q3Hull.h"
+#include "q3Mesh.h"
+#include "q3Heightfield.h"
+#include "q3Plane.h"
 
 //--------------------------------------------------------------------------------------------------
 // q3Collide
 //--------------------------------------------------------------------------------------------------
 struct q3Manifold;
 
+// Shapes must be ordered by type, see q3ShapeType. childB selects a
+// triangle of b when b is a mesh or heightfield.
+void q3Collide( q3Manifold* m, q3Shape* a, q3Shape* b, i32 childB );
+
+// Only reports whether two shapes overlap, used by sensors
+bool q3Overlap( q3Shape* a, q3Shape* b, i32 childB );
+
 void q3BoxtoBox( q3Manifold* m, q3Box* a, q3Box* b );
+bool q3BoxtoBoxOverlap( q3Box* a, q3Box* b );
+
+// Triangles are given in world space and are two-sided
+void q3BoxtoTriangle( q3Manifold* m, q3Box* a, const q3Vec3& v0, const q3Vec3& v1, const q3Vec3& v2 );
+
+// Rounded shapes produce one or two contacts
+void q3SpheretoSphere( q3Manifold* m, q3Sphere* a, q3Sphere* b );
+void q3SpheretoCapsule( q3Manifold* m, q3Sphere* a, q3Capsule* b );
+void q3SpheretoBox( q3Manifold* m, q3Sphere* a, q3Box* b );
+void q3SpheretoTriangle( q3Manifold* m, q3Sphere* a, const q3Vec3& v0, const q3Vec3& v1, const q3Vec3& v2 );
+void q3CapsuletoCapsule( q3Manifold* m, q3Capsule* a, q3Capsule* b );
+void q3CapsuletoBox( q3Manifold* m, q3Capsule* a, q3Box* b );
+void q3CapsuletoTriangle( q3Manifold* m, q3Capsule* a, const q3Vec3& v0, const q3Vec3& v1, const q3Vec3& v2 );
+
+// Boxes, hulls and triangles share a SAT upon their polyhedral features
+void q3SpheretoHull( q3Manifold* m, q3Sphere* a, q3Hull* b );
+void q3CapsuletoHull( q3Manifold* m, q3Capsule* a, q3Hull* b );
+void q3BoxtoHull( q3Manifold* m, q3Box* a, q3Hull* b );
+void q3HulltoHull( q3Manifold* m, q3Hull* a, q3Hull* b );
+void q3HulltoTriangle( q3Manifold* m, q3Hull* a, const q3Vec3& v0, const q3Vec3& v1, const q3Vec3& v2 );
+
+// Planes keep the points of the other shape found below them
+void q3SpheretoPlane( q3Manifold* m, q3Sphere* a, q3Plane* b );
+void q3CapsuletoPlane( q3Manifold* m, q3Capsule* a, q3Plane* b );
+void q3BoxtoPlane( q3Manifold* m, q3Box* a, q3Plane* b );
+void q3HulltoPlane( q3Manifold* m, q3Hull* a, q3Plane* b );
 
 #endif // Q3COLLIDE_H
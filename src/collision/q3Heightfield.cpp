@@ -0,0 +1,284 @@
+//--------------------------------------------------------------------------------------------------
+/**
+@file	q3Heightfield.cpp
+
+@author	Randy Gaul
+@date	10/19/2026
+
+	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+
+	This software is provided 'as-is', without any express or implied
+	warranty. In no event will the authors be held liable for any damages
+	arising from the use of this software.
+
+	Permission is granted to anyone to use this software for any purpose,
+	including commercial applications, and to alter it and redistribute it
+	freely, subject to the following restrictions:
+	  1. The origin of this software must not be misrepresented; you must not
+	     claim that you wrote the original software. If you use this software
+	     in a product, an acknowledgment in the product documentation would be
+	     appreciated but is not required.
+	  2. Altered source versions must be plainly marked as such, and must not
+	     be misrepresented as being the original software.
+	  3. This notice may not be removed or altered from any source distribution.
+*/
+//--------------------------------------------------------------------------------------------------
+
+#include "q3Heightfield.h"
+#include "../common/q3Memory.h"
+
+//--------------------------------------------------------------------------------------------------
+// q3Heightfield
+//--------------------------------------------------------------------------------------------------
+void q3Heightfield::Build( const r32* heightData, i32 numRows, i32 numColumns, const q3Vec3& gridScale )
+{
+	rows = numRows;
+	columns = numColumns;
+	scale = gridScale;
+	heights = (r32*)q3Alloc( sizeof( r32 ) * rows * columns );
+	memcpy( heights, heightData, sizeof( r32 ) * rows * columns );
+
+	r32 lo = Q3_R32_MAX;
+	r32 hi = -Q3_R32_MAX;
+
+	for ( i32 i = 0; i < rows * columns; ++i )
+	{
+		lo = q3Min( lo, heights[ i ] * scale.y );
+		hi = q3Max( hi, heights[ i ] * scale.y );
+	}
+
+	bounds.min = q3Vec3( r32( 0.0 ), lo, r32( 0.0 ) );
+	bounds.max = q3Vec3( r32( columns - 1 ) * scale.x, hi, r32( rows - 1 ) * scale.z );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Heightfield::Free( )
+{
+	q3Free( heights );
+}
+
+//--------------------------------------------------------------------------------------------------
+// Triangles in the space of the heightfield
+static void q3GetCellTriangle( const q3Heightfield* hf, i32 index, q3Vec3* a, q3Vec3* b, q3Vec3* c )
+{
+	assert( index >= 0 && index < hf->GetTriangleCount( ) );
+
+	i32 cell = index >> 1;
+	i32 row = cell / (hf->columns - 1);
+	i32 column = cell - row * (hf->columns - 1);
+	r32 x0 = r32( column ) * hf->scale.x;
+	r32 x1 = r32( column + 1 ) * hf->scale.x;
+	r32 z0 = r32( row ) * hf->scale.z;
+	r32 z1 = r32( row + 1 ) * hf->scale.z;
+
+	// Both triangles share the diagonal from ( x0, z0 ) to ( x1, z1 ) and
+	// wind counter-clockwise when viewed from above
+	*a = q3Vec3( x0, hf->GetHeight( row, column ), z0 );
+	*c = q3Vec3( x1, hf->GetHeight( row + 1, column + 1 ), z1 );
+
+	if ( index & 1 )
+	{
+		*b = *c;
+		*c = q3Vec3( x1, hf->GetHeight( row, column + 1 ), z0 );
+	}
+
+	else
+		*b = q3Vec3( x0, hf->GetHeight( row + 1, column ), z1 );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Heightfield::GetTriangle( i32 index, q3Vec3* a, q3Vec3* b, q3Vec3* c ) const
+{
+	q3GetCellTriangle( this, index, a, b, c );
+	*a = q3Mul( local, *a );
+	*b = q3Mul( local, *b );
+	*c = q3Mul( local, *c );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Heightfield::ComputeTriangleAABB( const q3Transform& tx, i32 index, q3AABB* aabb ) const
+{
+	q3Vec3 a, b, c;
+	GetTriangle( index, &a, &b, &c );
+	a = q3Mul( tx, a );
+	b = q3Mul( tx, b );
+	c = q3Mul( tx, c );
+
+	aabb->min = q3Min( a, q3Min( b, c ) );
+	aabb->max = q3Max( a, q3Max( b, c ) );
+}
+
+//--------------------------------------------------------------------------------------------------
+bool q3Heightfield::TestPoint( const q3Transform& tx, const q3Vec3& p ) const
+{
+	// Like mesh triangles the surface does not enclose any volume
+	Q3_UNUSED( tx );
+	Q3_UNUSED( p );
+
+	return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Marches the cells under the ray in order, so the first cell with a hit
+// holds the closest hit.
+// Resources:
+// A Fast Voxel Traversal Algorithm for Ray Tracing, Amanatides and Woo
+bool q3Heightfield::Raycast( const q3Transform& tx, q3RaycastData* raycast ) const
+{
+	q3Transform world = q3Mul( tx, local );
+	q3RaycastData ray;
+	ray.start = q3MulT( world, raycast->start );
+	ray.dir = q3MulT( world.rotation, raycast->dir );
+
+	r32 tmin = r32( 0.0 );
+	r32 tmax = raycast->t;
+
+	if ( !q3RaytoAABB( ray.start, ray.dir, bounds, &tmin, &tmax ) )
+		return false;
+
+	ray.t = tmax;
+
+	// Starting cell, clamped since the entry point lies on the bounds
+	q3Vec3 p = ray.start + ray.dir * tmin;
+	i32 column = q3Min( q3Max( i32( p.x / scale.x ), 0 ), columns - 2 );
+	i32 row = q3Min( q3Max( i32( p.z / scale.z ), 0 ), rows - 2 );
+
+	const r32 k_epsilon = r32( 1.0e-8 );
+	i32 stepX = 0;
+	i32 stepZ = 0;
+	r32 nextX = Q3_R32_MAX;
+	r32 nextZ = Q3_R32_MAX;
+	r32 deltaX = Q3_R32_MAX;
+	r32 deltaZ = Q3_R32_MAX;
+
+	if ( ray.dir.x > k_epsilon )
+	{
+		stepX = 1;
+		deltaX = scale.x / ray.dir.x;
+		nextX = (r32( column + 1 ) * scale.x - ray.start.x) / ray.dir.x;
+	}
+
+	else if ( ray.dir.x < -k_epsilon )
+	{
+		stepX = -1;
+		deltaX = -scale.x / ray.dir.x;
+		nextX = (r32( column ) * scale.x - ray.start.x) / ray.dir.x;
+	}
+
+	if ( ray.dir.z > k_epsilon )
+	{
+		stepZ = 1;
+		deltaZ = scale.z / ray.dir.z;
+		nextZ = (r32( row + 1 ) * scale.z - ray.start.z) / ray.dir.z;
+	}
+
+	else if ( ray.dir.z < -k_epsilon )
+	{
+		stepZ = -1;
+		deltaZ = -scale.z / ray.dir.z;
+		nextZ = (r32( row ) * scale.z - ray.start.z) / ray.dir.z;
+	}
+
+	r32 tEnter = tmin;
+
+	for ( ; ; )
+	{
+		r32 tExit = q3Min( q3Min( nextX, nextZ ), tmax );
+
+		// Skip cells whose height range the ray passes over or under
+		r32 y0 = ray.start.y + ray.dir.y * tEnter;
+		r32 y1 = ray.start.y + ray.dir.y * tExit;
+		r32 h0 = GetHeight( row, column );
+		r32 h1 = GetHeight( row, column + 1 );
+		r32 h2 = GetHeight( row + 1, column );
+		r32 h3 = GetHeight( row + 1, column + 1 );
+		r32 lo = q3Min( q3Min( h0, h1 ), q3Min( h2, h3 ) );
+		r32 hi = q3Max( q3Max( h0, h1 ), q3Max( h2, h3 ) );
+
+		if ( q3Min( y0, y1 ) <= hi && q3Max( y0, y1 ) >= lo )
+		{
+			bool hit = false;
+			i32 index = 2 * (row * (columns - 1) + column);
+
+			for ( i32 i = 0; i < 2; ++i )
+			{
+				q3Vec3 a, b, c;
+				q3GetCellTriangle( this, index + i, &a, &b, &c );
+
+				if ( q3RaycastTriangle( a, b, c, &ray ) )
+				{
+					hit = true;
+					ray.t = ray.toi;
+				}
+			}
+
+			if ( hit )
+			{
+				raycast->toi = ray.toi;
+				raycast->normal = q3Mul( world.rotation, ray.normal );
+				return true;
+			}
+		}
+
+		if ( tExit >= tmax )
+			return false;
+
+		tEnter = tExit;
+
+		if ( nextX < nextZ )
+		{
+			column += stepX;
+			nextX += deltaX;
+
+			if ( column < 0 || column > columns - 2 )
+				return false;
+		}
+
+		else
+		{
+			row += stepZ;
+			nextZ += deltaZ;
+
+			if ( row < 0 || row > rows - 2 )
+				return false;
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Heightfield::ComputeAABB( const q3Transform& tx, q3AABB* aabb ) const
+{
+	*aabb = q3Mul( q3Mul( tx, local ), bounds );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Heightfield::ComputeMass( q3MassData* md ) const
+{
+	// Heightfields are only attached to static bodies
+	md->center = local.position;
+	md->inertia = q3Diagonal( r32( 0.0 ) );
+	md->mass = r32( 0.0 );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Heightfield::Render( const q3Transform& tx, bool awake, q3Render* render ) const
+{
+	Q3_UNUSED( awake );
+
+	q3Transform world = q3Mul( tx, local );
+	i32 count = GetTriangleCount( );
+
+	for ( i32 i = 0; i < count; ++i )
+	{
+		q3Vec3 a, b, c;
+		q3GetCellTriangle( this, i, &a, &b, &c );
+		a = q3Mul( world, a );
+		b = q3Mul( world, b );
+		c = q3Mul( world, c );
+
+		q3Vec3 n = q3Normalize( q3Cross( b - a, c - a ) );
+
+		render->SetTriNormal( n.x, n.y, n.z );
+		render->Triangle( a.x, a.y, a.z, b.x, b.y, b.z, c.x, c.y, c.z );
+	}
+}
@@ -0,0 +1,108 @@
+//--------------------------------------------------------------------------------------------------
+/**
+@file	q3Heightfield.h
+
+@author	Randy Gaul
+@date	10/19/2026
+
+	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+
+	This software is provided 'as-is', without any express or implied
+	warranty. In no event will the authors be held liable for any damages
+	arising from the use of this software.
+
+	Permission is granted to anyone to use this software for any purpose,
+	including commercial applications, and to alter it and redistribute it
+	freely, subject to the following restrictions:
+	  1. The origin of this software must not be misrepresented; you must not
+	     claim that you wrote the original software. If you use this software
+	     in a product, an acknowledgment in the product documentation would be
+	     appreciated but is not required.
+	  2. Altered source versions must be plainly marked as such, and must not
+	     be misrepresented as being the original software.
+	  3. This notice may not be removed or altered from any source distribution.
+*/
+//--------------------------------------------------------------------------------------------------
+
+#ifndef Q3HEIGHTFIELD_H
+#define Q3HEIGHTFIELD_H
+
+#include "q3Shape.h"
+
+//--------------------------------------------------------------------------------------------------
+// q3Heightfield
+//--------------------------------------------------------------------------------------------------
+// Heightfields are a regular grid of height samples used for terrain. Only
+// the heights are stored, so a heightfield takes a fraction of the memory of
+// an equivalent mesh. Sample ( row, column ) lies at the point
+// ( column * scale.x, height * scale.y, row * scale.z ) in the space of the
+// heightfield. Every grid cell is split into two triangles along the
+// diagonal, which collide just like the two-sided triangles of a q3Mesh.
+// Heightfields may only be attached to static bodies and have no mass.
+struct q3Heightfield : public q3Shape
+{
+	r32* heights; // rows * columns samples, row major
+	i32 rows;
+	i32 columns;
+	q3Vec3 scale;
+	q3AABB bounds; // In the space of the heightfield
+
+	r32 GetHeight( i32 row, i32 column ) const;
+
+	// Triangles of cell ( row, column ) are 2 * (row * (columns - 1) + column)
+	// and the index following it.
+	i32 GetTriangleCount( ) const;
+
+	// Retrieves a triangle in the space of the heightfield's owning body
+	void GetTriangle( i32 index, q3Vec3* a, q3Vec3* b, q3Vec3* c ) const;
+	void ComputeTriangleAABB( const q3Transform& tx, i32 index, q3AABB* aabb ) const;
+
+	// Reports the triangles of all cells whose footprint and height range
+	// overlap aabb, where aabb is in the space of the heightfield's owning
+	// body. Calls cb->TreeCallBack( index ).
+	template <typename T>
+	void Query( T* cb, const q3AABB& aabb ) const;
+
+	bool TestPoint( const q3Transform& tx, const q3Vec3& p ) const;
+	bool Raycast( const q3Transform& tx, q3RaycastData* raycast ) const;
+	void ComputeAABB( const q3Transform& tx, q3AABB* aabb ) const;
+	void ComputeMass( q3MassData* md ) const;
+	void Render( const q3Transform& tx, bool awake, q3Render* render ) const;
+
+	// Copies the height samples and computes the bounds
+	void Build( const r32* heightData, i32 numRows, i32 numColumns, const q3Vec3& gridScale );
+	void Free( );
+};
+
+//--------------------------------------------------------------------------------------------------
+// q3HeightfieldDef
+//--------------------------------------------------------------------------------------------------
+class q3HeightfieldDef : public q3ShapeDef
+{
+public:
+	q3HeightfieldDef( )
+	{
+		m_heights = NULL;
+		m_rows = 0;
+		m_columns = 0;
+		m_scale = q3Vec3( r32( 1.0 ), r32( 1.0 ), r32( 1.0 ) );
+	}
+
+	// Heights are given row by row, each row holding columns samples.
+	// scale holds the x spacing of columns, a multiplier applied to all
+	// heights, and the z spacing of rows. The heights are copied upon
+	// q3Body::AddHeightfield, so only need to be valid until then.
+	void Set( const q3Transform& tx, const r32* heights, i32 rows, i32 columns, const q3Vec3& scale );
+
+private:
+	const r32* m_heights;
+	i32 m_rows;
+	i32 m_columns;
+	q3Vec3 m_scale;
+
+	friend class q3Body;
+};
+
+#include "q3Heightfield.inl"
+
+#endif // Q3HEIGHTFIELD_H
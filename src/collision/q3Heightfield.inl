@@ -0,0 +1,94 @@
+//--------------------------------------------------------------------------------------------------
+// q3Heightfield.inl
+//
+//	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+//
+//	This software is provided 'as-is', without any express or implied
+//	warranty. In no event will the authors be held liable for any damages
+//	arising from the use of this software.
+//
+//	Permission is granted to anyone to use this software for any purpose,
+//	including commercial applications, and to alter it and redistribute it
+//	freely, subject to the following restrictions:
+//	  1. The origin of this software must not be misrepresented; you must not
+//	     claim that you wrote the original software. If you use this software
+//	     in a product, an acknowledgment in the product documentation would be
+//	     appreciated but is not required.
+//	  2. Altered source versions must be plainly marked as such, and must not
+//	     be misrepresented as being the original software.
+//	  3. This notice may not be removed or altered from any source distribution.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+// q3Heightfield
+//--------------------------------------------------------------------------------------------------
+inline r32 q3Heightfield::GetHeight( i32 row, i32 column ) const
+{
+	assert( row >= 0 && row < rows );
+	assert( column >= 0 && column < columns );
+
+	return heights[ row * columns + column ] * scale.y;
+}
+
+//--------------------------------------------------------------------------------------------------
+inline i32 q3Heightfield::GetTriangleCount( ) const
+{
+	return 2 * (rows - 1) * (columns - 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+template <typename T>
+void q3Heightfield::Query( T* cb, const q3AABB& aabb ) const
+{
+	// Cells are found in heightfield space
+	q3AABB hfAABB = q3Mul( q3Inverse( local ), aabb );
+
+	if ( !q3AABBtoAABB( hfAABB, bounds ) )
+		return;
+
+	// Clamp before converting to integers to keep huge bounds in range
+	i32 c0 = i32( q3Max( hfAABB.min.x / scale.x, r32( 0.0 ) ) );
+	i32 c1 = i32( q3Min( hfAABB.max.x / scale.x, r32( columns - 2 ) ) );
+	i32 r0 = i32( q3Max( hfAABB.min.z / scale.z, r32( 0.0 ) ) );
+	i32 r1 = i32( q3Min( hfAABB.max.z / scale.z, r32( rows - 2 ) ) );
+
+	for ( i32 r = r0; r <= r1; ++r )
+	{
+		for ( i32 c = c0; c <= c1; ++c )
+		{
+			r32 h0 = GetHeight( r, c );
+			r32 h1 = GetHeight( r, c + 1 );
+			r32 h2 = GetHeight( r + 1, c );
+			r32 h3 = GetHeight( r + 1, c + 1 );
+			r32 lo = q3Min( q3Min( h0, h1 ), q3Min( h2, h3 ) );
+			r32 hi = q3Max( q3Max( h0, h1 ), q3Max( h2, h3 ) );
+
+			if ( hfAABB.max.y < lo || hfAABB.min.y > hi )
+				continue;
+
+			i32 index = 2 * (r * (columns - 1) + c);
+
+			if ( !cb->TreeCallBack( index ) )
+				return;
+
+			if ( !cb->TreeCallBack( index + 1 ) )
+				return;
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+// q3HeightfieldDef
+//--------------------------------------------------------------------------------------------------
+inline void q3HeightfieldDef::Set( const q3Transform& tx, const r32* heights, i32 rows, i32 columns, const q3Vec3& scale )
+{
+	assert( heights );
+	assert( rows > 1 && columns > 1 );
+	assert( scale.x > r32( 0.0 ) && scale.z > r32( 0.0 ) );
+
+	m_tx = tx;
+	m_heights = heights;
+	m_rows = rows;
+	m_columns = columns;
+	m_scale = scale;
+}
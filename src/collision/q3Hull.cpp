@@ -0,0 +1,685 @@
+//--------------------------------------------------------------------------------------------------
+/**
+@file	q3Hull.cpp
+
+@author	Randy Gaul
+@date	10/19/2026
+
+	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+
+	This software is provided 'as-is', without any express or implied
+	warranty. In no event will the authors be held liable for any damages
+	arising from the use of this software.
+
+	Permission is granted to anyone to use this software for any purpose,
+	including commercial applications, and to alter it and redistribute it
+	freely, subject to the following restrictions:
+	  1. The origin of this software must not be misrepresented; you must not
+	     claim that you wrote the original software. If you use this software
+	     in a product, an acknowledgment in the product documentation would be
+	     appreciated but is not required.
+	  2. Altered source versions must be plainly marked as such, and must not
+	     be misrepresented as being the original software.
+	  3. This notice may not be removed or altered from any source distribution.
+*/
+//--------------------------------------------------------------------------------------------------
+
+#include "q3Hull.h"
+#include "../common/q3Memory.h"
+
+//--------------------------------------------------------------------------------------------------
+// q3Hull construction
+//--------------------------------------------------------------------------------------------------
+// Hulls are small, so a simple incremental algorithm is used. Triangles are
+// added one point at a time, and coplanar triangles are merged into faces
+// once all points are processed.
+const i32 k_maxHullTriangles = 4 * Q3_MAX_HULL_VERTICES;
+
+struct q3HullTriangle
+{
+	i32 v[ 3 ];
+	q3HalfSpace plane;
+};
+
+//--------------------------------------------------------------------------------------------------
+static q3HullTriangle q3MakeHullTriangle( const q3Vec3* points, i32 a, i32 b, i32 c )
+{
+	q3HullTriangle t;
+	t.v[ 0 ] = a;
+	t.v[ 1 ] = b;
+	t.v[ 2 ] = c;
+	t.plane.Set( points[ a ], points[ b ], points[ c ] );
+
+	return t;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Returns true if triangle t contains the directed edge a to b
+static bool q3HasEdge( const q3HullTriangle& t, i32 a, i32 b )
+{
+	for ( i32 i = 0; i < 3; ++i )
+	{
+		if ( t.v[ i ] == a && t.v[ (i + 1) % 3 ] == b )
+			return true;
+	}
+
+	return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Triangulated hull of the points, oriented counter-clockwise from outside
+static i32 q3BuildHullTriangles( const q3Vec3* points, i32 count, r32 tolerance, q3HullTriangle* triangles )
+{
+	// Initial tetrahedron from extreme points
+	i32 i0 = 0;
+
+	for ( i32 i = 1; i < count; ++i )
+	{
+		if ( points[ i ].x < points[ i0 ].x )
+			i0 = i;
+	}
+
+	i32 i1 = i0;
+	r32 best = r32( 0.0 );
+
+	for ( i32 i = 0; i < count; ++i )
+	{
+		r32 d = q3DistanceSq( points[ i ], points[ i0 ] );
+
+		if ( d > best )
+		{
+			best = d;
+			i1 = i;
+		}
+	}
+
+	i32 i2 = i0;
+	best = r32( 0.0 );
+
+	for ( i32 i = 0; i < count; ++i )
+	{
+		r32 d = q3LengthSq( q3Cross( points[ i1 ] - points[ i0 ], points[ i ] - points[ i0 ] ) );
+
+		if ( d > best )
+		{
+			best = d;
+			i2 = i;
+		}
+	}
+
+	q3HalfSpace base;
+	base.Set( points[ i0 ], points[ i1 ], points[ i2 ] );
+	i32 i3 = i0;
+	best = r32( 0.0 );
+
+	for ( i32 i = 0; i < count; ++i )
+	{
+		r32 d = q3Abs( base.Distance( points[ i ] ) );
+
+		if ( d > best )
+		{
+			best = d;
+			i3 = i;
+		}
+	}
+
+	// Hulls must have volume
+	assert( best > tolerance );
+
+	if ( base.Distance( points[ i3 ] ) > r32( 0.0 ) )
+	{
+		i32 temp = i1;
+		i1 = i2;
+		i2 = temp;
+	}
+
+	i32 triangleCount = 4;
+	triangles[ 0 ] = q3MakeHullTriangle( points, i0, i1, i2 );
+	triangles[ 1 ] = q3MakeHullTriangle( points, i0, i3, i1 );
+	triangles[ 2 ] = q3MakeHullTriangle( points, i1, i3, i2 );
+	triangles[ 3 ] = q3MakeHullTriangle( points, i2, i3, i0 );
+
+	q3HullTriangle buffer[ k_maxHullTriangles ];
+	bool visible[ k_maxHullTriangles ];
+	i32 stack[ k_maxHullTriangles ];
+	bool done[ Q3_MAX_HULL_VERTICES ];
+
+	for ( i32 i = 0; i < count; ++i )
+		done[ i ] = i == i0 || i == i1 || i == i2 || i == i3;
+
+	while ( true )
+	{
+		// The furthest point is added first, this keeps the visible region
+		// of each new point connected and the hull free of slivers
+		i32 p = -1;
+		i32 seed = 0;
+		r32 dMax = tolerance;
+
+		for ( i32 i = 0; i < count; ++i )
+		{
+			if ( done[ i ] )
+				continue;
+
+			for ( i32 j = 0; j < triangleCount; ++j )
+			{
+				r32 d = triangles[ j ].plane.Distance( points[ i ] );
+
+				if ( d > dMax )
+				{
+					dMax = d;
+					p = i;
+					seed = j;
+				}
+			}
+		}
+
+		// Remaining points lie within the hull
+		if ( p == -1 )
+			break;
+
+		done[ p ] = true;
+
+		// Flood the visible triangles from the seed
+		for ( i32 i = 0; i < triangleCount; ++i )
+			visible[ i ] = false;
+
+		i32 sp = 0;
+		stack[ sp++ ] = seed;
+		visible[ seed ] = true;
+
+		while ( sp )
+		{
+			const q3HullTriangle& t = triangles[ stack[ --sp ] ];
+
+			for ( i32 i = 0; i < triangleCount; ++i )
+			{
+				if ( visible[ i ] || triangles[ i ].plane.Distance( points[ p ] ) <= r32( 0.0 ) )
+					continue;
+
+				for ( i32 j = 0; j < 3; ++j )
+				{
+					if ( q3HasEdge( triangles[ i ], t.v[ (j + 1) % 3 ], t.v[ j ] ) )
+					{
+						visible[ i ] = true;
+						stack[ sp++ ] = i;
+						break;
+					}
+				}
+			}
+		}
+
+		// Keep hidden triangles and connect the horizon to the new point
+		i32 newCount = 0;
+
+		for ( i32 i = 0; i < triangleCount; ++i )
+		{
+			if ( !visible[ i ] )
+				buffer[ newCount++ ] = triangles[ i ];
+		}
+
+		for ( i32 i = 0; i < triangleCount; ++i )
+		{
+			if ( !visible[ i ] )
+				continue;
+
+			for ( i32 j = 0; j < 3; ++j )
+			{
+				i32 a = triangles[ i ].v[ j ];
+				i32 b = triangles[ i ].v[ (j + 1) % 3 ];
+
+				for ( i32 k = 0; k < triangleCount; ++k )
+				{
+					if ( !visible[ k ] && q3HasEdge( triangles[ k ], b, a ) )
+					{
+						assert( newCount < k_maxHullTriangles );
+						buffer[ newCount++ ] = q3MakeHullTriangle( points, a, b, p );
+						break;
+					}
+				}
+			}
+		}
+
+		triangleCount = newCount;
+
+		for ( i32 i = 0; i < triangleCount; ++i )
+			triangles[ i ] = buffer[ i ];
+	}
+
+	return triangleCount;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Hull::Build( const q3Vec3* points, i32 count )
+{
+	assert( count >= 4 && count <= Q3_MAX_HULL_VERTICES );
+
+	q3Vec3 lo = points[ 0 ];
+	q3Vec3 hi = points[ 0 ];
+
+	for ( i32 i = 1; i < count; ++i )
+	{
+		lo = q3Min( lo, points[ i ] );
+		hi = q3Max( hi, points[ i ] );
+	}
+
+	// Points this close to a plane are considered to lie upon it
+	r32 tolerance = r32( 1.0e-4 ) * q3Length( hi - lo );
+
+	q3HullTriangle triangles[ k_maxHullTriangles ];
+	i32 triangleCount = q3BuildHullTriangles( points, count, tolerance, triangles );
+
+	// Merge neighboring coplanar triangles into faces
+	i32 group[ k_maxHullTriangles ];
+	i32 stack[ k_maxHullTriangles ];
+	i32 groupCount = 0;
+
+	for ( i32 i = 0; i < triangleCount; ++i )
+		group[ i ] = -1;
+
+	for ( i32 i = 0; i < triangleCount; ++i )
+	{
+		if ( group[ i ] != -1 )
+			continue;
+
+		const q3HalfSpace& plane = triangles[ i ].plane;
+		i32 sp = 0;
+		stack[ sp++ ] = i;
+		group[ i ] = groupCount;
+
+		while ( sp )
+		{
+			const q3HullTriangle& t = triangles[ stack[ --sp ] ];
+
+			for ( i32 j = 0; j < triangleCount; ++j )
+			{
+				if ( group[ j ] != -1 )
+					continue;
+
+				const q3HullTriangle& u = triangles[ j ];
+				bool adjacent = false;
+
+				for ( i32 k = 0; k < 3; ++k )
+					adjacent = adjacent || q3HasEdge( u, t.v[ (k + 1) % 3 ], t.v[ k ] );
+
+				if ( !adjacent || q3Dot( u.plane.normal, plane.normal ) < r32( 0.999 ) )
+					continue;
+
+				bool coplanar = true;
+
+				for ( i32 k = 0; k < 3; ++k )
+					coplanar = coplanar && q3Abs( plane.Distance( points[ u.v[ k ] ] ) ) < r32( 10.0 ) * tolerance;
+
+				if ( coplanar )
+				{
+					group[ j ] = groupCount;
+					stack[ sp++ ] = j;
+				}
+			}
+		}
+
+		++groupCount;
+	}
+
+	assert( groupCount <= Q3_MAX_HULL_FACES );
+
+	// Trace the boundary of each group into a loop of point indices
+	i32 loops[ Q3_MAX_HULL_EDGES ];
+	i32 loopStart[ Q3_MAX_HULL_FACES + 1 ];
+	i32 loopCount = 0;
+
+	for ( i32 g = 0; g < groupCount; ++g )
+	{
+		i32 boundary[ k_maxHullTriangles * 3 ][ 2 ];
+		i32 boundaryCount = 0;
+
+		for ( i32 i = 0; i < triangleCount; ++i )
+		{
+			if ( group[ i ] != g )
+				continue;
+
+			for ( i32 k = 0; k < 3; ++k )
+			{
+				i32 a = triangles[ i ].v[ k ];
+				i32 b = triangles[ i ].v[ (k + 1) % 3 ];
+				bool interior = false;
+
+				for ( i32 j = 0; j < triangleCount; ++j )
+					interior = interior || (group[ j ] == g && q3HasEdge( triangles[ j ], b, a ));
+
+				if ( !interior )
+				{
+					boundary[ boundaryCount ][ 0 ] = a;
+					boundary[ boundaryCount ][ 1 ] = b;
+					++boundaryCount;
+				}
+			}
+		}
+
+		loopStart[ g ] = loopCount;
+		i32 v = boundary[ 0 ][ 0 ];
+
+		for ( i32 i = 0; i < boundaryCount; ++i )
+		{
+			loops[ loopCount++ ] = v;
+
+			for ( i32 j = 0; j < boundaryCount; ++j )
+			{
+				if ( boundary[ j ][ 0 ] == v )
+				{
+					v = boundary[ j ][ 1 ];
+					break;
+				}
+			}
+		}
+
+		// Faces must be simple polygons
+		assert( v == boundary[ 0 ][ 0 ] );
+	}
+
+	loopStart[ groupCount ] = loopCount;
+
+	// Vertices shared by only two faces lie upon an edge and are dropped,
+	// unless this would leave one of the faces with fewer than 3 vertices
+	i32 used[ Q3_MAX_HULL_VERTICES ];
+	i32 live[ Q3_MAX_HULL_FACES ];
+
+	for ( i32 i = 0; i < count; ++i )
+		used[ i ] = 0;
+
+	for ( i32 i = 0; i < loopCount; ++i )
+		++used[ loops[ i ] ];
+
+	for ( i32 g = 0; g < groupCount; ++g )
+		live[ g ] = loopStart[ g + 1 ] - loopStart[ g ];
+
+	for ( i32 i = 0; i < count; ++i )
+	{
+		if ( used[ i ] != 2 )
+			continue;
+
+		bool drop = true;
+
+		for ( i32 g = 0; g < groupCount; ++g )
+		{
+			for ( i32 j = loopStart[ g ]; j < loopStart[ g + 1 ]; ++j )
+				drop = drop && (loops[ j ] != i || live[ g ] > 3);
+		}
+
+		if ( !drop )
+			continue;
+
+		used[ i ] = 0;
+
+		for ( i32 g = 0; g < groupCount; ++g )
+		{
+			for ( i32 j = loopStart[ g ]; j < loopStart[ g + 1 ]; ++j )
+			{
+				if ( loops[ j ] == i )
+					--live[ g ];
+			}
+		}
+	}
+
+	i32 remap[ Q3_MAX_HULL_VERTICES ];
+	vertexCount = 0;
+
+	for ( i32 i = 0; i < count; ++i )
+		remap[ i ] = used[ i ] ? vertexCount++ : -1;
+
+	vertices = (q3Vec3*)q3Alloc( sizeof( q3Vec3 ) * vertexCount );
+
+	for ( i32 i = 0; i < count; ++i )
+	{
+		if ( remap[ i ] != -1 )
+			vertices[ remap[ i ] ] = points[ i ];
+	}
+
+	// Half-edges of each face loop, skipping dropped vertices
+	q3HullHalfEdge halfEdges[ Q3_MAX_HULL_EDGES ];
+	edgeCount = 0;
+	faceCount = groupCount;
+	faces = (q3HullFace*)q3Alloc( sizeof( q3HullFace ) * faceCount );
+	planes = (q3HalfSpace*)q3Alloc( sizeof( q3HalfSpace ) * faceCount );
+
+	for ( i32 g = 0; g < groupCount; ++g )
+	{
+		i32 first = edgeCount;
+
+		for ( i32 i = loopStart[ g ]; i < loopStart[ g + 1 ]; ++i )
+		{
+			if ( remap[ loops[ i ] ] == -1 )
+				continue;
+
+			q3HullHalfEdge* edge = halfEdges + edgeCount++;
+			edge->origin = u8( remap[ loops[ i ] ] );
+			edge->face = u8( g );
+			edge->next = u8( edgeCount );
+		}
+
+		halfEdges[ edgeCount - 1 ].next = u8( first );
+		faces[ g ].edge = u8( first );
+
+		// Newell's method is robust for polygons with many vertices
+		q3Vec3 n( r32( 0.0 ), r32( 0.0 ), r32( 0.0 ) );
+		q3Vec3 c( r32( 0.0 ), r32( 0.0 ), r32( 0.0 ) );
+
+		for ( i32 i = first; i < edgeCount; ++i )
+		{
+			const q3Vec3& a = vertices[ halfEdges[ i ].origin ];
+			const q3Vec3& b = vertices[ halfEdges[ halfEdges[ i ].next ].origin ];
+			n += q3Cross( a, b );
+			c += a;
+		}
+
+		c /= r32( edgeCount - first );
+		planes[ g ].Set( q3Normalize( n ), c );
+	}
+
+	for ( i32 i = 0; i < edgeCount; ++i )
+	{
+		u8 a = halfEdges[ i ].origin;
+		u8 b = halfEdges[ halfEdges[ i ].next ].origin;
+
+		for ( i32 j = 0; j < edgeCount; ++j )
+		{
+			if ( halfEdges[ j ].origin == b && halfEdges[ halfEdges[ j ].next ].origin == a )
+			{
+				halfEdges[ i ].twin = u8( j );
+				break;
+			}
+		}
+	}
+
+	edges = (q3HullHalfEdge*)q3Alloc( sizeof( q3HullHalfEdge ) * edgeCount );
+	memcpy( edges, halfEdges, sizeof( q3HullHalfEdge ) * edgeCount );
+
+	// Mass properties from the tetrahedra joining each face to a point
+	// within the hull
+	// Resources:
+	// How to find the inertia tensor (or other mass properties) of a 3D solid body represented by a triangle mesh, Jonathan Blow and Atman J Binstock
+	q3Vec3 ref( r32( 0.0 ), r32( 0.0 ), r32( 0.0 ) );
+
+	for ( i32 i = 0; i < vertexCount; ++i )
+		ref += vertices[ i ];
+
+	ref /= r32( vertexCount );
+
+	q3Mat3 covariance = q3Diagonal( r32( 0.0 ) );
+	q3Vec3 center( r32( 0.0 ), r32( 0.0 ), r32( 0.0 ) );
+	volume = r32( 0.0 );
+
+	for ( i32 f = 0; f < faceCount; ++f )
+	{
+		const q3HullHalfEdge* e0 = edges + faces[ f ].edge;
+		const q3HullHalfEdge* e1 = edges + e0->next;
+		const q3HullHalfEdge* e2 = edges + e1->next;
+		q3Vec3 a = vertices[ e0->origin ] - ref;
+
+		while ( e2 != e0 )
+		{
+			q3Vec3 b = vertices[ e1->origin ] - ref;
+			q3Vec3 c = vertices[ e2->origin ] - ref;
+			q3Vec3 s = a + b + c;
+			r32 det = q3Dot( a, q3Cross( b, c ) );
+
+			volume += det / r32( 6.0 );
+			center += s * (det / r32( 24.0 ));
+			covariance += (q3OuterProduct( a, a ) + q3OuterProduct( b, b ) + q3OuterProduct( c, c ) + q3OuterProduct( s, s )) * (det / r32( 120.0 ));
+
+			e1 = e2;
+			e2 = edges + e2->next;
+		}
+	}
+
+	center /= volume;
+	covariance -= q3OuterProduct( center, center ) * volume;
+	centroid = ref + center;
+
+	q3Mat3 identity;
+	q3Identity( identity );
+	inertia = identity * (covariance.ex.x + covariance.ey.y + covariance.ez.z) - covariance;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Hull::Free( )
+{
+	q3Free( planes );
+	q3Free( faces );
+	q3Free( edges );
+	q3Free( vertices );
+}
+
+//--------------------------------------------------------------------------------------------------
+// q3Hull
+//--------------------------------------------------------------------------------------------------
+bool q3Hull::TestPoint( const q3Transform& tx, const q3Vec3& p ) const
+{
+	q3Vec3 p0 = q3MulT( q3Mul( tx, local ), p );
+
+	for ( i32 i = 0; i < faceCount; ++i )
+	{
+		if ( planes[ i ].Distance( p0 ) > r32( 0.0 ) )
+			return false;
+	}
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+bool q3Hull::Raycast( const q3Transform& tx, q3RaycastData* raycast ) const
+{
+	q3Transform world = q3Mul( tx, local );
+	q3Vec3 d = q3MulT( world.rotation, raycast->dir );
+	q3Vec3 p = q3MulT( world, raycast->start );
+	const r32 epsilon = r32( 1.0e-8 );
+	r32 tmin = r32( 0.0 );
+	r32 tmax = raycast->t;
+	i32 face = -1;
+
+	// Clip the ray against every face plane
+	for ( i32 i = 0; i < faceCount; ++i )
+	{
+		r32 numerator = -planes[ i ].Distance( p );
+		r32 denominator = q3Dot( planes[ i ].normal, d );
+
+		if ( q3Abs( denominator ) < epsilon )
+		{
+			if ( numerator < r32( 0.0 ) )
+				return false;
+		}
+
+		else
+		{
+			r32 t = numerator / denominator;
+
+			// Entering the half-space
+			if ( denominator < r32( 0.0 ) )
+			{
+				if ( t > tmin )
+				{
+					tmin = t;
+					face = i;
+				}
+			}
+
+			else
+				tmax = q3Min( tmax, t );
+
+			if ( tmin > tmax )
+				return false;
+		}
+	}
+
+	// Ray starts within the hull
+	if ( face == -1 )
+		return false;
+
+	raycast->toi = tmin;
+	raycast->normal = q3Mul( world.rotation, planes[ face ].normal );
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Hull::ComputeAABB( const q3Transform& tx, q3AABB* aabb ) const
+{
+	q3Transform world = q3Mul( tx, local );
+	q3Vec3 min( Q3_R32_MAX, Q3_R32_MAX, Q3_R32_MAX );
+	q3Vec3 max( -Q3_R32_MAX, -Q3_R32_MAX, -Q3_R32_MAX );
+
+	for ( i32 i = 0; i < vertexCount; ++i )
+	{
+		q3Vec3 v = q3Mul( world, vertices[ i ] );
+		min = q3Min( min, v );
+		max = q3Max( max, v );
+	}
+
+	aabb->min = min;
+	aabb->max = max;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Hull::ComputeMass( q3MassData* md ) const
+{
+	r32 mass = volume * density;
+	q3Vec3 center = q3Mul( local, centroid );
+
+	// Transform tensor to local space
+	q3Mat3 I = local.rotation * (inertia * density) * q3Transpose( local.rotation );
+	q3Mat3 identity;
+	q3Identity( identity );
+	I += (identity * q3Dot( center, center ) - q3OuterProduct( center, center )) * mass;
+
+	md->center = center;
+	md->inertia = I;
+	md->mass = mass;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Hull::Render( const q3Transform& tx, bool awake, q3Render* render ) const
+{
+	Q3_UNUSED( awake );
+
+	q3Transform world = q3Mul( tx, local );
+
+	for ( i32 i = 0; i < faceCount; ++i )
+	{
+		q3Vec3 n = q3Mul( world.rotation, planes[ i ].normal );
+		const q3HullHalfEdge* e0 = edges + faces[ i ].edge;
+		const q3HullHalfEdge* e1 = edges + e0->next;
+		const q3HullHalfEdge* e2 = edges + e1->next;
+		q3Vec3 a = q3Mul( world, vertices[ e0->origin ] );
+
+		render->SetTriNormal( n.x, n.y, n.z );
+
+		while ( e2 != e0 )
+		{
+			q3Vec3 b = q3Mul( world, vertices[ e1->origin ] );
+			q3Vec3 c = q3Mul( world, vertices[ e2->origin ] );
+			render->Triangle( a.x, a.y, a.z, b.x, b.y, b.z, c.x, c.y, c.z );
+
+			e1 = e2;
+			e2 = edges + e2->next;
+		}
+	}
+}
@@ -0,0 +1,114 @@
+//--------------------------------------------------------------------------------------------------
+/**
+@file	q3Hull.h
+
+@author	Randy Gaul
+@date	10/19/2026
+
+	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+
+	This software is provided 'as-is', without any express or implied
+	warranty. In no event will the authors be held liable for any damages
+	arising from the use of this software.
+
+	Permission is granted to anyone to use this software for any purpose,
+	including commercial applications, and to alter it and redistribute it
+	freely, subject to the following restrictions:
+	  1. The origin of this software must not be misrepresented; you must not
+	     claim that you wrote the original software. If you use this software
+	     in a product, an acknowledgment in the product documentation would be
+	     appreciated but is not required.
+	  2. Altered source versions must be plainly marked as such, and must not
+	     be misrepresented as being the original software.
+	  3. This notice may not be removed or altered from any source distribution.
+*/
+//--------------------------------------------------------------------------------------------------
+
+#ifndef Q3HULL_H
+#define Q3HULL_H
+
+#include "q3Shape.h"
+
+//--------------------------------------------------------------------------------------------------
+// q3Hull
+//--------------------------------------------------------------------------------------------------
+// Hulls use 8 bit indices for their topology, which caps the size of a hull.
+// A hull with V vertices has at most 2V - 4 faces and 6V - 12 half-edges.
+#define Q3_MAX_HULL_VERTICES 32
+#define Q3_MAX_HULL_FACES (2 * Q3_MAX_HULL_VERTICES - 4)
+#define Q3_MAX_HULL_EDGES (6 * Q3_MAX_HULL_VERTICES - 12)
+
+// Edges are stored as pairs of half-edges. The half-edges of each face form
+// a counter-clockwise loop when viewed from outside the hull.
+struct q3HullHalfEdge
+{
+	u8 next;
+	u8 twin;
+	u8 origin;
+	u8 face;
+};
+
+struct q3HullFace
+{
+	u8 edge; // First half-edge of the face's loop
+};
+
+// A convex polyhedron with polygonal faces. Hulls are built from a cloud of
+// points, with coplanar triangles merged into single faces so that contact
+// clipping sees the same faces a modeler would.
+struct q3Hull : public q3Shape
+{
+	q3Vec3* vertices;
+	q3HullHalfEdge* edges;
+	q3HullFace* faces;
+	q3HalfSpace* planes;
+	i32 vertexCount;
+	i32 edgeCount;
+	i32 faceCount;
+
+	// Mass properties for a density of one, computed upon Build
+	q3Vec3 centroid;
+	q3Mat3 inertia; // About the centroid
+	r32 volume;
+
+	// Index of the vertex furthest along dir, in the space of the hull
+	i32 GetSupport( const q3Vec3& dir ) const;
+
+	bool TestPoint( const q3Transform& tx, const q3Vec3& p ) const;
+	bool Raycast( const q3Transform& tx, q3RaycastData* raycast ) const;
+	void ComputeAABB( const q3Transform& tx, q3AABB* aabb ) const;
+	void ComputeMass( q3MassData* md ) const;
+	void Render( const q3Transform& tx, bool awake, q3Render* render ) const;
+
+	// Computes the convex hull of the points along with its mass properties
+	void Build( const q3Vec3* points, i32 count );
+	void Free( );
+};
+
+//--------------------------------------------------------------------------------------------------
+// q3HullDef
+//--------------------------------------------------------------------------------------------------
+class q3HullDef : public q3ShapeDef
+{
+public:
+	q3HullDef( )
+	{
+		m_points = NULL;
+		m_count = 0;
+	}
+
+	// The hull of the points is computed upon q3Body::AddHull, so the
+	// points only need to be valid until then. Points within the hull
+	// are discarded. The points must not all lie within one plane.
+	void Set( const q3Transform& tx, const q3Vec3* points, i32 count );
+
+private:
+	const q3Vec3* m_points;
+	i32 m_count;
+
+	friend class q3Body;
+};
+
+#include "q3Hull.inl"
+
+#endif // Q3HULL_H
@@ -0,0 +1,55 @@
+//--------------------------------------------------------------------------------------------------
+// q3Hull.inl
+//
+//	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+//
+//	This software is provided 'as-is', without any express or implied
+//	warranty. In no event will the authors be held liable for any damages
+//	arising from the use of this software.
+//
+//	Permission is granted to anyone to use this software for any purpose,
+//	including commercial applications, and to alter it and redistribute it
+//	freely, subject to the following restrictions:
+//	  1. The origin of this software must not be misrepresented; you must not
+//	     claim that you wrote the original software. If you use this software
+//	     in a product, an acknowledgment in the product documentation would be
+//	     appreciated but is not required.
+//	  2. Altered source versions must be plainly marked as such, and must not
+//	     be misrepresented as being the original software.
+//	  3. This notice may not be removed or altered from any source distribution.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+// q3Hull
+//--------------------------------------------------------------------------------------------------
+inline i32 q3Hull::GetSupport( const q3Vec3& dir ) const
+{
+	i32 index = 0;
+	r32 maxProjection = q3Dot( vertices[ 0 ], dir );
+
+	for ( i32 i = 1; i < vertexCount; ++i )
+	{
+		r32 projection = q3Dot( vertices[ i ], dir );
+
+		if ( projection > maxProjection )
+		{
+			index = i;
+			maxProjection = projection;
+		}
+	}
+
+	return index;
+}
+
+//--------------------------------------------------------------------------------------------------
+// q3HullDef
+//--------------------------------------------------------------------------------------------------
+inline void q3HullDef::Set( const q3Transform& tx, const q3Vec3* points, i32 count )
+{
+	assert( points );
+	assert( count >= 4 && count <= Q3_MAX_HULL_VERTICES );
+
+	m_tx = tx;
+	m_points = points;
+	m_count = count;
+}
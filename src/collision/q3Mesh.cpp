@@ -0,0 +1,283 @@
+//--------------------------------------------------------------------------------------------------
+/**
+@file	q3Mesh.cpp
+
+@author	Randy Gaul
+@date	10/19/2026
+
+	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+
+	This software is provided 'as-is', without any express or implied
+	warranty. In no event will the authors be held liable for any damages
+	arising from the use of this software.
+
+	Permission is granted to anyone to use this software for any purpose,
+	including commercial applications, and to alter it and redistribute it
+	freely, subject to the following restrictions:
+	  1. The origin of this software must not be misrepresented; you must not
+	     claim that you wrote the original software. If you use this software
+	     in a product, an acknowledgment in the product documentation would be
+	     appreciated but is not required.
+	  2. Altered source versions must be plainly marked as such, and must not
+	     be misrepresented as being the original software.
+	  3. This notice may not be removed or altered from any source distribution.
+*/
+//--------------------------------------------------------------------------------------------------
+
+#include <algorithm>
+
+#include "q3Mesh.h"
+#include "../common/q3Memory.h"
+
+//--------------------------------------------------------------------------------------------------
+// q3Mesh
+//--------------------------------------------------------------------------------------------------
+const i32 k_meshLeafSize = 2;
+
+//--------------------------------------------------------------------------------------------------
+struct q3MeshCentroidSort
+{
+	bool operator( )( i32 a, i32 b ) const
+	{
+		return centroids[ a ][ axis ] < centroids[ b ][ axis ];
+	}
+
+	const q3Vec3* centroids;
+	i32 axis;
+};
+
+//--------------------------------------------------------------------------------------------------
+// Top down median split of the triangles order[ first, first + count ).
+// Returns the index of the new node.
+static i32 q3BuildMeshNode( q3Mesh* mesh, i32* order, const q3Vec3* centroids, i32 first, i32 count )
+{
+	i32 id = mesh->nodeCount++;
+	q3AABB aabb;
+	q3AABB centroidAABB;
+	aabb.min = centroidAABB.min = q3Vec3( Q3_R32_MAX, Q3_R32_MAX, Q3_R32_MAX );
+	aabb.max = centroidAABB.max = q3Vec3( -Q3_R32_MAX, -Q3_R32_MAX, -Q3_R32_MAX );
+
+	for ( i32 i = first; i < first + count; ++i )
+	{
+		const i32* tri = mesh->indices + order[ i ] * 3;
+
+		for ( i32 j = 0; j < 3; ++j )
+		{
+			aabb.min = q3Min( aabb.min, mesh->vertices[ tri[ j ] ] );
+			aabb.max = q3Max( aabb.max, mesh->vertices[ tri[ j ] ] );
+		}
+
+		centroidAABB.min = q3Min( centroidAABB.min, centroids[ order[ i ] ] );
+		centroidAABB.max = q3Max( centroidAABB.max, centroids[ order[ i ] ] );
+	}
+
+	mesh->nodes[ id ].aabb = aabb;
+
+	if ( count <= k_meshLeafSize )
+	{
+		mesh->nodes[ id ].index = first;
+		mesh->nodes[ id ].count = count;
+		return id;
+	}
+
+	// Split along the longest axis of the centroid bounds
+	q3Vec3 d = centroidAABB.max - centroidAABB.min;
+	q3MeshCentroidSort sort;
+	sort.centroids = centroids;
+	sort.axis = 0;
+
+	if ( d.y > d.x && d.y >= d.z )
+		sort.axis = 1;
+
+	else if ( d.z > d.x && d.z > d.y )
+		sort.axis = 2;
+
+	i32 half = count / 2;
+	std::nth_element( order + first, order + first + half, order + first + count, sort );
+
+	q3BuildMeshNode( mesh, order, centroids, first, half );
+	i32 right = q3BuildMeshNode( mesh, order, centroids, first + half, count - half );
+
+	mesh->nodes[ id ].index = right;
+	mesh->nodes[ id ].count = 0;
+
+	return id;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Mesh::Build( const q3Vec3* vertexData, i32 numVertices, const i32* indexData, i32 numTriangles )
+{
+	vertexCount = numVertices;
+	triangleCount = numTriangles;
+	vertices = (q3Vec3*)q3Alloc( sizeof( q3Vec3 ) * vertexCount );
+	indices = (i32*)q3Alloc( sizeof( i32 ) * 3 * triangleCount );
+	memcpy( vertices, vertexData, sizeof( q3Vec3 ) * vertexCount );
+	memcpy( indices, indexData, sizeof( i32 ) * 3 * triangleCount );
+
+	// A binary tree with at least one triangle per leaf
+	nodes = (q3MeshNode*)q3Alloc( sizeof( q3MeshNode ) * (2 * triangleCount - 1) );
+	nodeCount = 0;
+
+	i32* order = (i32*)q3Alloc( sizeof( i32 ) * triangleCount );
+	q3Vec3* centroids = (q3Vec3*)q3Alloc( sizeof( q3Vec3 ) * triangleCount );
+
+	for ( i32 i = 0; i < triangleCount; ++i )
+	{
+		const i32* tri = indices + i * 3;
+		assert( tri[ 0 ] >= 0 && tri[ 0 ] < vertexCount );
+		assert( tri[ 1 ] >= 0 && tri[ 1 ] < vertexCount );
+		assert( tri[ 2 ] >= 0 && tri[ 2 ] < vertexCount );
+
+		order[ i ] = i;
+		centroids[ i ] = (vertices[ tri[ 0 ] ] + vertices[ tri[ 1 ] ] + vertices[ tri[ 2 ] ]) * r32( 1.0 / 3.0 );
+	}
+
+	q3BuildMeshNode( this, order, centroids, 0, triangleCount );
+
+	// Store triangles in leaf order so each leaf references a contiguous range
+	i32* sorted = (i32*)q3Alloc( sizeof( i32 ) * 3 * triangleCount );
+
+	for ( i32 i = 0; i < triangleCount; ++i )
+	{
+		sorted[ i * 3 ] = indices[ order[ i ] * 3 ];
+		sorted[ i * 3 + 1 ] = indices[ order[ i ] * 3 + 1 ];
+		sorted[ i * 3 + 2 ] = indices[ order[ i ] * 3 + 2 ];
+	}
+
+	q3Free( indices );
+	indices = sorted;
+
+	q3Free( centroids );
+	q3Free( order );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Mesh::Free( )
+{
+	q3Free( nodes );
+	q3Free( indices );
+	q3Free( vertices );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Mesh::ComputeTriangleAABB( const q3Transform& tx, i32 index, q3AABB* aabb ) const
+{
+	q3Vec3 a, b, c;
+	GetTriangle( index, &a, &b, &c );
+	a = q3Mul( tx, a );
+	b = q3Mul( tx, b );
+	c = q3Mul( tx, c );
+
+	aabb->min = q3Min( a, q3Min( b, c ) );
+	aabb->max = q3Max( a, q3Max( b, c ) );
+}
+
+//--------------------------------------------------------------------------------------------------
+bool q3Mesh::TestPoint( const q3Transform& tx, const q3Vec3& p ) const
+{
+	// Triangles do not enclose any volume
+	Q3_UNUSED( tx );
+	Q3_UNUSED( p );
+
+	return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+bool q3Mesh::Raycast( const q3Transform& tx, q3RaycastData* raycast ) const
+{
+	// Cast in mesh space and keep the closest hit
+	q3Transform world = q3Mul( tx, local );
+	q3RaycastData ray;
+	ray.start = q3MulT( world, raycast->start );
+	ray.dir = q3MulT( world.rotation, raycast->dir );
+	ray.t = raycast->t;
+
+	bool hit = false;
+	q3Vec3 normal;
+
+	const i32 k_stackCapacity = 256;
+	i32 stack[ k_stackCapacity ];
+	i32 sp = 1;
+
+	*stack = 0;
+
+	while ( sp )
+	{
+		// k_stackCapacity too small
+		assert( sp < k_stackCapacity );
+
+		i32 id = stack[ --sp ];
+		const q3MeshNode* n = nodes + id;
+
+		r32 tmin = r32( 0.0 );
+		r32 tmax = ray.t;
+
+		if ( !q3RaytoAABB( ray.start, ray.dir, n->aabb, &tmin, &tmax ) )
+			continue;
+
+		if ( n->count )
+		{
+			for ( i32 i = n->index; i < n->index + n->count; ++i )
+			{
+				const i32* tri = indices + i * 3;
+
+				if ( q3RaycastTriangle( vertices[ tri[ 0 ] ], vertices[ tri[ 1 ] ], vertices[ tri[ 2 ] ], &ray ) )
+				{
+					hit = true;
+					ray.t = ray.toi;
+					normal = ray.normal;
+				}
+			}
+		}
+
+		else
+		{
+			stack[ sp++ ] = id + 1;
+			stack[ sp++ ] = n->index;
+		}
+	}
+
+	if ( hit )
+	{
+		raycast->toi = ray.t;
+		raycast->normal = q3Mul( world.rotation, normal );
+	}
+
+	return hit;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Mesh::ComputeAABB( const q3Transform& tx, q3AABB* aabb ) const
+{
+	*aabb = q3Mul( q3Mul( tx, local ), nodes[ 0 ].aabb );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Mesh::ComputeMass( q3MassData* md ) const
+{
+	// Meshes are only attached to static bodies
+	md->center = local.position;
+	md->inertia = q3Diagonal( r32( 0.0 ) );
+	md->mass = r32( 0.0 );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Mesh::Render( const q3Transform& tx, bool awake, q3Render* render ) const
+{
+	Q3_UNUSED( awake );
+
+	q3Transform world = q3Mul( tx, local );
+
+	for ( i32 i = 0; i < triangleCount; ++i )
+	{
+		const i32* tri = indices + i * 3;
+		q3Vec3 a = q3Mul( world, vertices[ tri[ 0 ] ] );
+		q3Vec3 b = q3Mul( world, vertices[ tri[ 1 ] ] );
+		q3Vec3 c = q3Mul( world, vertices[ tri[ 2 ] ] );
+
+		q3Vec3 n = q3Normalize( q3Cross( b - a, c - a ) );
+
+		render->SetTriNormal( n.x, n.y, n.z );
+		render->Triangle( a.x, a.y, a.z, b.x, b.y, b.z, c.x, c.y, c.z );
+	}
+}
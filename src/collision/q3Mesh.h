@@ -0,0 +1,107 @@
+//--------------------------------------------------------------------------------------------------
+/**
+@file	q3Mesh.h
+
+@author	Randy Gaul
+@date	10/19/2026
+
+	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+
+	This software is provided 'as-is', without any express or implied
+	warranty. In no event will the authors be held liable for any damages
+	arising from the use of this software.
+
+	Permission is granted to anyone to use this software for any purpose,
+	including commercial applications, and to alter it and redistribute it
+	freely, subject to the following restrictions:
+	  1. The origin of this software must not be misrepresented; you must not
+	     claim that you wrote the original software. If you use this software
+	     in a product, an acknowledgment in the product documentation would be
+	     appreciated but is not required.
+	  2. Altered source versions must be plainly marked as such, and must not
+	     be misrepresented as being the original software.
+	  3. This notice may not be removed or altered from any source distribution.
+*/
+//--------------------------------------------------------------------------------------------------
+
+#ifndef Q3MESH_H
+#define Q3MESH_H
+
+#include "q3Shape.h"
+
+//--------------------------------------------------------------------------------------------------
+// q3Mesh
+//--------------------------------------------------------------------------------------------------
+// Nodes of a mesh BVH are stored depth first. The left child of a branch
+// immediately follows its parent, so only the right child is stored.
+struct q3MeshNode
+{
+	q3AABB aabb;
+	i32 index;	// First triangle for leaves, right child for branches
+	i32 count;	// Number of triangles within a leaf, zero for branches
+};
+
+// Triangle meshes are static collision geometry for level and terrain data.
+// Meshes may only be attached to static bodies and have no mass. Every
+// triangle collides individually and is two-sided. The mesh is placed
+// within a static BVH upon creation, which is never modified afterwards.
+struct q3Mesh : public q3Shape
+{
+	q3Vec3* vertices;
+	i32* indices; // three per triangle
+	q3MeshNode* nodes;
+	i32 vertexCount;
+	i32 triangleCount;
+	i32 nodeCount;
+
+	// Retrieves a triangle in the space of the mesh's owning body
+	void GetTriangle( i32 index, q3Vec3* a, q3Vec3* b, q3Vec3* c ) const;
+	void ComputeTriangleAABB( const q3Transform& tx, i32 index, q3AABB* aabb ) const;
+
+	// Reports all triangles potentially overlapping aabb, where aabb is
+	// in the space of the mesh's owning body. Calls cb->TreeCallBack( index ).
+	template <typename T>
+	void Query( T* cb, const q3AABB& aabb ) const;
+
+	bool TestPoint( const q3Transform& tx, const q3Vec3& p ) const;
+	bool Raycast( const q3Transform& tx, q3RaycastData* raycast ) const;
+	void ComputeAABB( const q3Transform& tx, q3AABB* aabb ) const;
+	void ComputeMass( q3MassData* md ) const;
+	void Render( const q3Transform& tx, bool awake, q3Render* render ) const;
+
+	// Copies the triangle data and builds the BVH
+	void Build( const q3Vec3* vertexData, i32 numVertices, const i32* indexData, i32 numTriangles );
+	void Free( );
+};
+
+//--------------------------------------------------------------------------------------------------
+// q3MeshDef
+//--------------------------------------------------------------------------------------------------
+class q3MeshDef : public q3ShapeDef
+{
+public:
+	q3MeshDef( )
+	{
+		m_vertices = NULL;
+		m_indices = NULL;
+		m_vertexCount = 0;
+		m_triangleCount = 0;
+	}
+
+	// Each triangle is made of three indices into the vertex array. The
+	// data is copied upon q3Body::AddMesh, so the arrays only need to be
+	// valid until then.
+	void Set( const q3Transform& tx, const q3Vec3* vertices, i32 vertexCount, const i32* indices, i32 triangleCount );
+
+private:
+	const q3Vec3* m_vertices;
+	const i32* m_indices;
+	i32 m_vertexCount;
+	i32 m_triangleCount;
+
+	friend class q3Body;
+};
+
+#include "q3Mesh.inl"
+
+#endif // Q3MESH_H
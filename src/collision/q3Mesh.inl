@@ -0,0 +1,89 @@
+//--------------------------------------------------------------------------------------------------
+// q3Mesh.inl
+//
+//	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+//
+//	This software is provided 'as-is', without any express or implied
+//	warranty. In no event will the authors be held liable for any damages
+//	arising from the use of this software.
+//
+//	Permission is granted to anyone to use this software for any purpose,
+//	including commercial applications, and to alter it and redistribute it
+//	freely, subject to the following restrictions:
+//	  1. The origin of this software must not be misrepresented; you must not
+//	     claim that you wrote the original software. If you use this software
+//	     in a product, an acknowledgment in the product documentation would be
+//	     appreciated but is not required.
+//	  2. Altered source versions must be plainly marked as such, and must not
+//	     be misrepresented as being the original software.
+//	  3. This notice may not be removed or altered from any source distribution.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+// q3Mesh
+//--------------------------------------------------------------------------------------------------
+inline void q3Mesh::GetTriangle( i32 index, q3Vec3* a, q3Vec3* b, q3Vec3* c ) const
+{
+	assert( index >= 0 && index < triangleCount );
+
+	const i32* tri = indices + index * 3;
+	*a = q3Mul( local, vertices[ tri[ 0 ] ] );
+	*b = q3Mul( local, vertices[ tri[ 1 ] ] );
+	*c = q3Mul( local, vertices[ tri[ 2 ] ] );
+}
+
+//--------------------------------------------------------------------------------------------------
+template <typename T>
+void q3Mesh::Query( T* cb, const q3AABB& aabb ) const
+{
+	// Nodes are stored in mesh space
+	q3AABB meshAABB = q3Mul( q3Inverse( local ), aabb );
+
+	const i32 k_stackCapacity = 256;
+	i32 stack[ k_stackCapacity ];
+	i32 sp = 1;
+
+	*stack = 0;
+
+	while ( sp )
+	{
+		// k_stackCapacity too small
+		assert( sp < k_stackCapacity );
+
+		i32 id = stack[ --sp ];
+		const q3MeshNode* n = nodes + id;
+
+		if ( !q3AABBtoAABB( meshAABB, n->aabb ) )
+			continue;
+
+		if ( n->count )
+		{
+			for ( i32 i = 0; i < n->count; ++i )
+			{
+				if ( !cb->TreeCallBack( n->index + i ) )
+					return;
+			}
+		}
+
+		else
+		{
+			stack[ sp++ ] = id + 1;
+			stack[ sp++ ] = n->index;
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+// q3MeshDef
+//--------------------------------------------------------------------------------------------------
+inline void q3MeshDef::Set( const q3Transform& tx, const q3Vec3* vertices, i32 vertexCount, const i32* indices, i32 triangleCount )
+{
+	assert( vertices && vertexCount > 0 );
+	assert( indices && triangleCount > 0 );
+
+	m_tx = tx;
+	m_vertices = vertices;
+	m_vertexCount = vertexCount;
+	m_indices = indices;
+	m_triangleCount = triangleCount;
+}
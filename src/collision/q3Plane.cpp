@@ -0,0 +1,99 @@
+//--------------------------------------------------------------------------------------------------
+/**
+@file	q3Plane.cpp
+
+@author	Randy Gaul
+@date	10/19/2026
+
+	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+
+	This software is provided 'as-is', without any express or implied
+	warranty. In no event will the authors be held liable for any damages
+	arising from the use of this software.
+
+	Permission is granted to anyone to use this software for any purpose,
+	including commercial applications, and to alter it and redistribute it
+	freely, subject to the following restrictions:
+	  1. The origin of this software must not be misrepresented; you must not
+	     claim that you wrote the original software. If you use this software
+	     in a product, an acknowledgment in the product documentation would be
+	     appreciated but is not required.
+	  2. Altered source versions must be plainly marked as such, and must not
+	     be misrepresented as being the original software.
+	  3. This notice may not be removed or altered from any source distribution.
+*/
+//--------------------------------------------------------------------------------------------------
+
+#include "q3Plane.h"
+
+//--------------------------------------------------------------------------------------------------
+// q3Plane
+//--------------------------------------------------------------------------------------------------
+bool q3Plane::TestPoint( const q3Transform& tx, const q3Vec3& p ) const
+{
+	return GetPlane( tx ).Distance( p ) <= r32( 0.0 );
+}
+
+//--------------------------------------------------------------------------------------------------
+bool q3Plane::Raycast( const q3Transform& tx, q3RaycastData* raycast ) const
+{
+	q3HalfSpace plane = GetPlane( tx );
+	r32 d = plane.Distance( raycast->start );
+	r32 denominator = q3Dot( plane.normal, raycast->dir );
+
+	// Ray starts within the solid or points away from the plane
+	if ( d <= r32( 0.0 ) || denominator >= r32( 0.0 ) )
+		return false;
+
+	r32 t = -d / denominator;
+
+	if ( t > raycast->t )
+		return false;
+
+	raycast->toi = t;
+	raycast->normal = plane.normal;
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Plane::ComputeAABB( const q3Transform& tx, q3AABB* aabb ) const
+{
+	Q3_UNUSED( tx );
+
+	aabb->min.SetAll( -Q3_R32_MAX );
+	aabb->max.SetAll( Q3_R32_MAX );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Plane::ComputeMass( q3MassData* md ) const
+{
+	// Planes are only attached to static bodies
+	md->center = local.position;
+	md->inertia = q3Diagonal( r32( 0.0 ) );
+	md->mass = r32( 0.0 );
+}
+
+//--------------------------------------------------------------------------------------------------
+const r32 kPlaneRenderExtent = r32( 100.0 );
+
+//--------------------------------------------------------------------------------------------------
+void q3Plane::Render( const q3Transform& tx, bool awake, q3Render* render ) const
+{
+	Q3_UNUSED( awake );
+
+	q3Transform world = q3Mul( tx, local );
+	q3Vec3 x = world.rotation.ex * kPlaneRenderExtent;
+	q3Vec3 z = world.rotation.ez * kPlaneRenderExtent;
+	q3Vec3 n = world.rotation.ey;
+	q3Vec3 v[ 4 ] = {
+		world.position - x - z,
+		world.position - x + z,
+		world.position + x + z,
+		world.position + x - z
+	};
+
+	render->SetTriNormal( n.x, n.y, n.z );
+	render->Triangle( v[ 0 ].x, v[ 0 ].y, v[ 0 ].z, v[ 1 ].x, v[ 1 ].y, v[ 1 ].z, v[ 2 ].x, v[ 2 ].y, v[ 2 ].z );
+	render->Triangle( v[ 0 ].x, v[ 0 ].y, v[ 0 ].z, v[ 2 ].x, v[ 2 ].y, v[ 2 ].z, v[ 3 ].x, v[ 3 ].y, v[ 3 ].z );
+}
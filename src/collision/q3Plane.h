@@ -0,0 +1,66 @@
+//--------------------------------------------------------------------------------------------------
+/**
+@file	q3Plane.h
+
+@author	Randy Gaul
+@date	10/19/2026
+
+	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+
+	This software is provided 'as-is', without any express or implied
+	warranty. In no event will the authors be held liable for any damages
+	arising from the use of this software.
+
+	Permission is granted to anyone to use this software for any purpose,
+	including commercial applications, and to alter it and redistribute it
+	freely, subject to the following restrictions:
+	  1. The origin of this software must not be misrepresented; you must not
+	     claim that you wrote the original software. If you use this software
+	     in a product, an acknowledgment in the product documentation would be
+	     appreciated but is not required.
+	  2. Altered source versions must be plainly marked as such, and must not
+	     be misrepresented as being the original software.
+	  3. This notice may not be removed or altered from any source distribution.
+*/
+//--------------------------------------------------------------------------------------------------
+
+#ifndef Q3PLANE_H
+#define Q3PLANE_H
+
+#include "q3Shape.h"
+
+//--------------------------------------------------------------------------------------------------
+// q3Plane
+//--------------------------------------------------------------------------------------------------
+// An infinite half-space, the solid lies below the local xz plane. The
+// outward normal is the local y axis. Planes are kept out of the broad-
+// phase and are tested directly against bodies that move, which is far
+// cheaper than a large static box acting as the ground.
+struct q3Plane : public q3Shape
+{
+	// The plane in world space for the body transform tx
+	const q3HalfSpace GetPlane( const q3Transform& tx ) const;
+
+	bool TestPoint( const q3Transform& tx, const q3Vec3& p ) const;
+	bool Raycast( const q3Transform& tx, q3RaycastData* raycast ) const;
+	void ComputeAABB( const q3Transform& tx, q3AABB* aabb ) const;
+	void ComputeMass( q3MassData* md ) const;
+	void Render( const q3Transform& tx, bool awake, q3Render* render ) const;
+};
+
+//--------------------------------------------------------------------------------------------------
+// q3PlaneDef
+//--------------------------------------------------------------------------------------------------
+class q3PlaneDef : public q3ShapeDef
+{
+public:
+	// The plane passes through tx.position with the normal tx.rotation.ey
+	void Set( const q3Transform& tx );
+
+	// The plane is given in the space of the body
+	void Set( const q3HalfSpace& plane );
+};
+
+#include "q3Plane.inl"
+
+#endif // Q3PLANE_H
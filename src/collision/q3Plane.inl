@@ -0,0 +1,50 @@
+//--------------------------------------------------------------------------------------------------
+// q3Plane.inl
+//
+//	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+//
+//	This software is provided 'as-is', without any express or implied
+//	warranty. In no event will the authors be held liable for any damages
+//	arising from the use of this software.
+//
+//	Permission is granted to anyone to use this software for any purpose,
+//	including commercial applications, and to alter it and redistribute it
+//	freely, subject to the following restrictions:
+//	  1. The origin of this software must not be misrepresented; you must not
+//	     claim that you wrote the original software. If you use this software
+//	     in a product, an acknowledgment in the product documentation would be
+//	     appreciated but is not required.
+//	  2. Altered source versions must be plainly marked as such, and must not
+//	     be misrepresented as being the original software.
+//	  3. This notice may not be removed or altered from any source distribution.
+//--------------------------------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------------------------------
+// q3Plane
+//--------------------------------------------------------------------------------------------------
+inline const q3HalfSpace q3Plane::GetPlane( const q3Transform& tx ) const
+{
+	q3Transform world = q3Mul( tx, local );
+	q3HalfSpace plane;
+	plane.Set( world.rotation.ey, world.position );
+
+	return plane;
+}
+
+//--------------------------------------------------------------------------------------------------
+// q3PlaneDef
+//--------------------------------------------------------------------------------------------------
+inline void q3PlaneDef::Set( const q3Transform& tx )
+{
+	m_tx = tx;
+}
+
+//--------------------------------------------------------------------------------------------------
+inline void q3PlaneDef::Set( const q3HalfSpace& plane )
+{
+	q3Vec3 x, z;
+	q3ComputeBasis( plane.normal, &z, &x );
+
+	m_tx.rotation = q3Mat3( x, plane.normal, z );
+	m_tx.position = plane.Origin( );
+}
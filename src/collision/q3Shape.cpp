@@ -0,0 +1,201 @@
+//--------------------------------------------------------------------------------------------------
+/**
+@file	q3Shape.cpp
+
+@author	Randy Gaul
+@date	10/19/2026
+
+	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+
+	This software is provided 'as-is', without any express or implied
+	warranty. In no event will the authors be held liable for any damages
+	arising from the use of this software.
+
+	Permission is granted to anyone to use this software for any purpose,
+	including commercial applications, and to alter it and redistribute it
+	freely, subject to the following restrictions:
+	  1. The origin of this software must not be misrepresented; you must not
+	     claim that you wrote the original software. If you use this software
+	     in a product, an acknowledgment in the product documentation would be
+	     appreciated but is not required.
+	  2. Altered source versions must be plainly marked as such, and must not
+	     be misrepresented as being the original software.
+	  3. This notice may not be removed or altered from any source distribution.
+*/
+//--------------------------------------------------------------------------------------------------
+
+#include "q3Shape.h"
+#include "q3Sphere.h"
+#include "q3Capsule.h"
+#include "q3Box.h"
+#include "q3Hull.h"
+#include "q3Mesh.h"
+#include "q3Heightfield.h"
+#include "q3Plane.h"
+
+//--------------------------------------------------------------------------------------------------
+// q3Shape
+//--------------------------------------------------------------------------------------------------
+bool q3Shape::TestPoint( const q3Transform& tx, const q3Vec3& p ) const
+{
+	switch ( type )
+	{
+	case eSphereShape:
+		return ((const q3Sphere*)this)->TestPoint( tx, p );
+
+	case eCapsuleShape:
+		return ((const q3Capsule*)this)->TestPoint( tx, p );
+
+	case eBoxShape:
+		return ((const q3Box*)this)->TestPoint( tx, p );
+
+	case eHullShape:
+		return ((const q3Hull*)this)->TestPoint( tx, p );
+
+	case eMeshShape:
+		return ((const q3Mesh*)this)->TestPoint( tx, p );
+
+	case eHeightfieldShape:
+		return ((const q3Heightfield*)this)->TestPoint( tx, p );
+
+	case ePlaneShape:
+		return ((const q3Plane*)this)->TestPoint( tx, p );
+	}
+
+	return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+bool q3Shape::Raycast( const q3Transform& tx, q3RaycastData* raycast ) const
+{
+	switch ( type )
+	{
+	case eSphereShape:
+		return ((const q3Sphere*)this)->Raycast( tx, raycast );
+
+	case eCapsuleShape:
+		return ((const q3Capsule*)this)->Raycast( tx, raycast );
+
+	case eBoxShape:
+		return ((const q3Box*)this)->Raycast( tx, raycast );
+
+	case eHullShape:
+		return ((const q3Hull*)this)->Raycast( tx, raycast );
+
+	case eMeshShape:
+		return ((const q3Mesh*)this)->Raycast( tx, raycast );
+
+	case eHeightfieldShape:
+		return ((const q3Heightfield*)this)->Raycast( tx, raycast );
+
+	case ePlaneShape:
+		return ((const q3Plane*)this)->Raycast( tx, raycast );
+	}
+
+	return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Shape::ComputeAABB( const q3Transform& tx, q3AABB* aabb ) const
+{
+	switch ( type )
+	{
+	case eSphereShape:
+		((const q3Sphere*)this)->ComputeAABB( tx, aabb );
+		break;
+
+	case eCapsuleShape:
+		((const q3Capsule*)this)->ComputeAABB( tx, aabb );
+		break;
+
+	case eBoxShape:
+		((const q3Box*)this)->ComputeAABB( tx, aabb );
+		break;
+
+	case eHullShape:
+		((const q3Hull*)this)->ComputeAABB( tx, aabb );
+		break;
+
+	case eMeshShape:
+		((const q3Mesh*)this)->ComputeAABB( tx, aabb );
+		break;
+
+	case eHeightfieldShape:
+		((const q3Heightfield*)this)->ComputeAABB( tx, aabb );
+		break;
+
+	case ePlaneShape:
+		((const q3Plane*)this)->ComputeAABB( tx, aabb );
+		break;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Shape::ComputeMass( q3MassData* md ) const
+{
+	switch ( type )
+	{
+	case eSphereShape:
+		((const q3Sphere*)this)->ComputeMass( md );
+		break;
+
+	case eCapsuleShape:
+		((const q3Capsule*)this)->ComputeMass( md );
+		break;
+
+	case eBoxShape:
+		((const q3Box*)this)->ComputeMass( md );
+		break;
+
+	case eHullShape:
+		((const q3Hull*)this)->ComputeMass( md );
+		break;
+
+	case eMeshShape:
+		((const q3Mesh*)this)->ComputeMass( md );
+		break;
+
+	case eHeightfieldShape:
+		((const q3Heightfield*)this)->ComputeMass( md );
+		break;
+
+	case ePlaneShape:
+		((const q3Plane*)this)->ComputeMass( md );
+		break;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Shape::Render( const q3Transform& tx, bool awake, q3Render* render ) const
+{
+	switch ( type )
+	{
+	case eSphereShape:
+		((const q3Sphere*)this)->Render( tx, awake, render );
+		break;
+
+	case eCapsuleShape:
+		((const q3Capsule*)this)->Render( tx, awake, render );
+		break;
+
+	case eBoxShape:
+		((const q3Box*)this)->Render( tx, awake, render );
+		break;
+
+	case eHullShape:
+		((const q3Hull*)this)->Render( tx, awake, render );
+		break;
+
+	case eMeshShape:
+		((const q3Mesh*)this)->Render( tx, awake, render );
+		break;
+
+	case eHeightfieldShape:
+		((const q3Heightfield*)this)->Render( tx, awake, render );
+		break;
+
+	case ePlaneShape:
+		((const q3Plane*)this)->Render( tx, awake, render );
+		break;
+	}
+}
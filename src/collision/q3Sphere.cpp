@@ -0,0 +1,139 @@
+//--------------------------------------------------------------------------------------------------
+/**
+@file	q3Sphere.cpp
+
+@author	Randy Gaul
+@date	10/19/2026
+
+	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+
+	This software is provided 'as-is', without any express or implied
+	warranty. In no event will the authors be held liable for any damages
+	arising from the use of this software.
+
+	Permission is granted to anyone to use this software for any purpose,
+	including commercial applications, and to alter it and redistribute it
+	freely, subject to the following restrictions:
+	  1. The origin of this software must not be misrepresented; you must not
+	     claim that you wrote the original software. If you use this software
+	     in a product, an acknowledgment in the product documentation would be
+	     appreciated but is not required.
+	  2. Altered source versions must be plainly marked as such, and must not
+	     be misrepresented as being the original software.
+	  3. This notice may not be removed or altered from any source distribution.
+*/
+//--------------------------------------------------------------------------------------------------
+
+#include "q3Sphere.h"
+
+//--------------------------------------------------------------------------------------------------
+// q3Sphere
+//--------------------------------------------------------------------------------------------------
+bool q3Sphere::TestPoint( const q3Transform& tx, const q3Vec3& p ) const
+{
+	q3Vec3 center = q3Mul( tx, local.position );
+
+	return q3DistanceSq( p, center ) <= radius * radius;
+}
+
+//--------------------------------------------------------------------------------------------------
+bool q3Sphere::Raycast( const q3Transform& tx, q3RaycastData* raycast ) const
+{
+	q3Vec3 center = q3Mul( tx, local.position );
+	q3Vec3 m = raycast->start - center;
+	r32 b = q3Dot( m, raycast->dir );
+	r32 c = q3Dot( m, m ) - radius * radius;
+
+	// Ray starts outside and points away from the sphere
+	if ( c > r32( 0.0 ) && b > r32( 0.0 ) )
+		return false;
+
+	r32 discriminant = b * b - c;
+
+	if ( discriminant < r32( 0.0 ) )
+		return false;
+
+	r32 t = -b - std::sqrt( discriminant );
+
+	// Ray starts within the sphere
+	if ( t < r32( 0.0 ) )
+		return false;
+
+	if ( t > raycast->t )
+		return false;
+
+	raycast->toi = t;
+	raycast->normal = q3Normalize( m + raycast->dir * t );
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Sphere::ComputeAABB( const q3Transform& tx, q3AABB* aabb ) const
+{
+	q3Vec3 center = q3Mul( tx, local.position );
+	q3Vec3 r( radius, radius, radius );
+
+	aabb->min = center - r;
+	aabb->max = center + r;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Sphere::ComputeMass( q3MassData* md ) const
+{
+	r32 r2 = radius * radius;
+	r32 mass = r32( 4.0 / 3.0 ) * q3PI * r2 * radius * density;
+	q3Mat3 I = q3Diagonal( r32( 2.0 / 5.0 ) * mass * r2 );
+
+	// Transform tensor to local space, rotation has no effect
+	q3Mat3 identity;
+	q3Identity( identity );
+	I += (identity * q3Dot( local.position, local.position ) - q3OuterProduct( local.position, local.position )) * mass;
+
+	md->center = local.position;
+	md->inertia = I;
+	md->mass = mass;
+}
+
+//--------------------------------------------------------------------------------------------------
+const i32 kSphereRings = 8;
+const i32 kSphereSectors = 12;
+
+//--------------------------------------------------------------------------------------------------
+void q3Sphere::Render( const q3Transform& tx, bool awake, q3Render* render ) const
+{
+	Q3_UNUSED( awake );
+
+	q3Transform world = q3Mul( tx, local );
+
+	for ( i32 i = 0; i < kSphereRings; ++i )
+	{
+		r32 theta0 = q3PI * r32( i ) / r32( kSphereRings );
+		r32 theta1 = q3PI * r32( i + 1 ) / r32( kSphereRings );
+
+		for ( i32 j = 0; j < kSphereSectors; ++j )
+		{
+			r32 phi0 = r32( 2.0 ) * q3PI * r32( j ) / r32( kSphereSectors );
+			r32 phi1 = r32( 2.0 ) * q3PI * r32( j + 1 ) / r32( kSphereSectors );
+
+			q3Vec3 n[ 4 ] = {
+				q3Vec3( std::sin( theta0 ) * std::cos( phi0 ), std::cos( theta0 ), std::sin( theta0 ) * std::sin( phi0 ) ),
+				q3Vec3( std::sin( theta1 ) * std::cos( phi0 ), std::cos( theta1 ), std::sin( theta1 ) * std::sin( phi0 ) ),
+				q3Vec3( std::sin( theta1 ) * std::cos( phi1 ), std::cos( theta1 ), std::sin( theta1 ) * std::sin( phi1 ) ),
+				q3Vec3( std::sin( theta0 ) * std::cos( phi1 ), std::cos( theta0 ), std::sin( theta0 ) * std::sin( phi1 ) )
+			};
+
+			q3Vec3 v[ 4 ];
+
+			for ( i32 k = 0; k < 4; ++k )
+				v[ k ] = q3Mul( world, n[ k ] * radius );
+
+			q3Vec3 normal = q3Mul( world.rotation, n[ 0 ] + n[ 2 ] );
+			normal = q3Normalize( normal );
+
+			render->SetTriNormal( normal.x, normal.y, normal.z );
+			render->Triangle( v[ 0 ].x, v[ 0 ].y, v[ 0 ].z, v[ 2 ].x, v[ 2 ].y, v[ 2 ].z, v[ 1 ].x, v[ 1 ].y, v[ 1 ].z );
+			render->Triangle( v[ 0 ].x, v[ 0 ].y, v[ 0 ].z, v[ 3 ].x, v[ 3 ].y, v[ 3 ].z, v[ 2 ].x, v[ 2 ].y, v[ 2 ].z );
+		}
+	}
+}
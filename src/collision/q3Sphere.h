@@ -0,0 +1,68 @@
+//--------------------------------------------------------------------------------------------------
+/**
+@file	q3Sphere.h
+
+@author	Randy Gaul
+@date	10/19/2026
+
+	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+
+	This software is provided 'as-is', without any express or implied
+	warranty. In no event will the authors be held liable for any damages
+	arising from the use of this software.
+
+	Permission is granted to anyone to use this software for any purpose,
+	including commercial applications, and to alter it and redistribute it
+	freely, subject to the following restrictions:
+	  1. The origin of this software must not be misrepresented; you must not
+	     claim that you wrote the original software. If you use this software
+	     in a product, an acknowledgment in the product documentation would be
+	     appreciated but is not required.
+	  2. Altered source versions must be plainly marked as such, and must not
+	     be misrepresented as being the original software.
+	  3. This notice may not be removed or altered from any source distribution.
+*/
+//--------------------------------------------------------------------------------------------------
+
+#ifndef Q3SPHERE_H
+#define Q3SPHERE_H
+
+#include "q3Shape.h"
+
+//--------------------------------------------------------------------------------------------------
+// q3Sphere
+//--------------------------------------------------------------------------------------------------
+// Spheres are centered upon the origin of their local transform
+struct q3Sphere : public q3Shape
+{
+	r32 radius;
+
+	bool TestPoint( const q3Transform& tx, const q3Vec3& p ) const;
+	bool Raycast( const q3Transform& tx, q3RaycastData* raycast ) const;
+	void ComputeAABB( const q3Transform& tx, q3AABB* aabb ) const;
+	void ComputeMass( q3MassData* md ) const;
+	void Render( const q3Transform& tx, bool awake, q3Render* render ) const;
+};
+
+//--------------------------------------------------------------------------------------------------
+// q3SphereDef
+//--------------------------------------------------------------------------------------------------
+class q3SphereDef : public q3ShapeDef
+{
+public:
+	q3SphereDef( )
+	{
+		m_radius = r32( 0.5 );
+	}
+
+	void Set( const q3Transform& tx, r32 radius );
+
+private:
+	r32 m_radius;
+
+	friend class q3Body;
+};
+
+#include "q3Sphere.inl"
+
+#endif // Q3SPHERE_H
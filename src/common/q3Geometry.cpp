@@ -71,3 +71,91 @@ const q3Vec3 q3HalfSpace::Projected( const q3Vec3& p ) const
 {
 	return p - normal * Distance( p );
 }
+
+//--------------------------------------------------------------------------------------------------
+// q3RaycastData
+//--------------------------------------------------------------------------------------------------
+// Resources:
+// Fast, Minimum Storage Ray/Triangle Intersection, Moller and Trumbore
+bool q3RaycastTriangle( const q3Vec3& a, const q3Vec3& b, const q3Vec3& c, q3RaycastData* raycast )
+{
+	const r32 k_epsilon = r32( 1.0e-8 );
+	q3Vec3 ab = b - a;
+	q3Vec3 ac = c - a;
+	q3Vec3 p = q3Cross( raycast->dir, ac );
+	r32 det = q3Dot( ab, p );
+
+	// Ray is parallel to the triangle
+	if ( q3Abs( det ) < k_epsilon )
+		return false;
+
+	r32 invDet = r32( 1.0 ) / det;
+	q3Vec3 s = raycast->start - a;
+	r32 u = q3Dot( s, p ) * invDet;
+
+	if ( u < r32( 0.0 ) || u > r32( 1.0 ) )
+		return false;
+
+	q3Vec3 q = q3Cross( s, ab );
+	r32 v = q3Dot( raycast->dir, q ) * invDet;
+
+	if ( v < r32( 0.0 ) || u + v > r32( 1.0 ) )
+		return false;
+
+	r32 t = q3Dot( ac, q ) * invDet;
+
+	if ( t < r32( 0.0 ) || t > raycast->t )
+		return false;
+
+	q3Vec3 n = q3Normalize( q3Cross( ab, ac ) );
+
+	if ( q3Dot( n, raycast->dir ) > r32( 0.0 ) )
+		n = -n;
+
+	raycast->toi = t;
+	raycast->normal = n;
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+bool q3RaytoAABB( const q3Vec3& p, const q3Vec3& d, const q3AABB& aabb, r32* tmin, r32* tmax )
+{
+	const r32 k_epsilon = r32( 1.0e-8 );
+	r32 t0 = *tmin;
+	r32 t1 = *tmax;
+
+	for ( i32 i = 0; i < 3; ++i )
+	{
+		if ( q3Abs( d[ i ] ) < k_epsilon )
+		{
+			if ( p[ i ] < aabb.min[ i ] || p[ i ] > aabb.max[ i ] )
+				return false;
+		}
+
+		else
+		{
+			r32 invD = r32( 1.0 ) / d[ i ];
+			r32 tNear = (aabb.min[ i ] - p[ i ]) * invD;
+			r32 tFar = (aabb.max[ i ] - p[ i ]) * invD;
+
+			if ( tNear > tFar )
+			{
+				r32 temp = tNear;
+				tNear = tFar;
+				tFar = temp;
+			}
+
+			t0 = q3Max( t0, tNear );
+			t1 = q3Min( t1, tFar );
+
+			if ( t0 > t1 )
+				return false;
+		}
+	}
+
+	*tmin = t0;
+	*tmax = t1;
+
+	return true;
+}
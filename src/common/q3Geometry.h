@@ -82,6 +82,14 @@ struct q3RaycastData
 	const q3Vec3 GetImpactPoint( ) const;
 };
 
+// Intersects a ray with the two-sided triangle abc. Upon a hit within
+// [0, raycast->t] toi and normal are written, with normal facing the ray.
+bool q3RaycastTriangle( const q3Vec3& a, const q3Vec3& b, const q3Vec3& c, q3RaycastData* raycast );
+
+// Clips the ray segment p + d * [tmin, tmax] against aabb. Returns false
+// if the segment misses, otherwise tmin and tmax are the clipped times.
+bool q3RaytoAABB( const q3Vec3& p, const q3Vec3& d, const q3AABB& aabb, r32* tmin, r32* tmax );
+
 #include "q3Geometry.inl"
 
 #endif // Q3GEOMETRY_H
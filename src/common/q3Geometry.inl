@@ -55,6 +55,18 @@ inline bool q3AABBtoAABB( const q3AABB& a, const q3AABB& b )
 	return true;
 }
 
+//--------------------------------------------------------------------------------------------------
+// Returns true if any part of the aabb lies on or behind the plane
+inline bool q3AABBtoPlane( const q3AABB& aabb, const q3HalfSpace& plane )
+{
+	q3Vec3 c = (aabb.min + aabb.max) * r32( 0.5 );
+	q3Vec3 e = (aabb.max - aabb.min) * r32( 0.5 );
+	const q3Vec3& n = plane.normal;
+	r32 r = e.x * q3Abs( n.x ) + e.y * q3Abs( n.y ) + e.z * q3Abs( n.z );
+
+	return plane.Distance( c ) <= r;
+}
+
 //--------------------------------------------------------------------------------------------------
 inline bool q3AABB::Contains( const q3AABB& other ) const
 {
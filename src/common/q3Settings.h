@@ -41,4 +41,43 @@
 
 #define Q3_PENETRATION_SLOP r32( 0.05 )
 
+// Impacts a bullet may resolve within a single step
+#define Q3_MAX_TOI_SUBSTEPS 4
+
+// Upper bound on the samples taken along the sweep of a bullet
+#define Q3_MAX_TOI_SAMPLES 64
+
+// Largest manifold whose normal constraints the block solver solves together
+#define Q3_MAX_BLOCK_CONTACTS 4
+
+// Relative softening of the block solver's mass matrix diagonal
+#define Q3_BLOCK_SOFTNESS r32( 1.0e-3 )
+
+// Stiffness and damping of soft contacts when the scene sub-steps
+#define Q3_CONTACT_HERTZ r32( 30.0 )
+#define Q3_CONTACT_DAMPING_RATIO r32( 10.0 )
+
+// Largest velocity a soft contact may use to push shapes apart
+#define Q3_MAX_PUSHOUT r32( 3.0 )
+
+// Final iterations that treat the lower body of each contact as immovable
+// when shock propagation is enabled
+#define Q3_SHOCK_ITERATIONS 1
+
+// Islands are gathered until they hold at least this many bodies and then
+// solved together, so scenes of many tiny islands do not set up the solver
+// once for each of them
+#define Q3_ISLAND_BATCH_BODIES 64
+
+// Lowest quality a scene over its step budget degrades to, and the rates at
+// which quality is lost per overrun step and regained per step well within
+// budget
+#define Q3_MIN_QUALITY r32( 0.25 )
+#define Q3_QUALITY_DECAY r32( 0.75 )
+#define Q3_QUALITY_RECOVERY r32( 0.05 )
+
+// While degraded, touching shapes whose relative motion over a step stays
+// below this keep their previous manifold instead of being collided again
+#define Q3_COHERENCE_TOLERANCE r32( 0.01 )
+
 #endif // Q3SETTINGS_H
@@ -27,13 +27,19 @@
 #include "q3Body.h"
 #include "../scene/q3Scene.h"
 #include "q3Contact.h"
+#include "q3Island.h"
 #include "../broadphase/q3BroadPhase.h"
 #include "../collision/q3Box.h"
+#include "../collision/q3Hull.h"
+#include "../collision/q3Mesh.h"
+#include "../collision/q3Heightfield.h"
+#include "../collision/q3Plane.h"
 
 //--------------------------------------------------------------------------------------------------
 // q3Body
 //--------------------------------------------------------------------------------------------------
 q3Body::q3Body( const q3BodyDef& def, q3Scene* scene )
+	: m_shapeTree( 4, r32( 0.1 ) )
 {
 	m_linearVelocity = def.linearVelocity;
 	m_angularVelocity = def.angularVelocity;
@@ -42,6 +48,7 @@ q3Body::q3Body( const q3BodyDef& def, q3Scene* scene )
 	m_q.Set( q3Normalize( def.axis ), def.angle );
 	m_tx.rotation = m_q.ToMat3( );
 	m_tx.position = def.position;
+	m_qInertia = q3Quaternion( r32( 0.0 ), r32( 0.0 ), r32( 0.0 ), r32( 0.0 ) );
 	m_sleepTime = r32( 0.0 );
 	m_gravityScale = def.gravityScale;
 	m_layers = def.layers;
@@ -87,47 +94,127 @@ q3Body::q3Body( const q3BodyDef& def, q3Scene* scene )
 	if ( def.lockAxisZ )
 		m_flags |= eLockAxisZ;
 
-	m_boxes = NULL;
+	if ( def.bullet && (m_flags & eDynamic) )
+		m_flags |= eBullet;
+
+	m_shapes = NULL;
+	m_shapeCount = 0;
+	m_broadPhaseIndex = -1;
 	m_contactList = NULL;
+	m_islandSet = NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+q3Body::~q3Body( )
+{
+	assert( !m_shapes );
 }
 
 //--------------------------------------------------------------------------------------------------
 const q3Box* q3Body::AddBox( const q3BoxDef& def )
 {
-	q3AABB aabb;
 	q3Box* box = (q3Box*)m_scene->m_heap.Allocate( sizeof( q3Box ) );
-	box->local = def.m_tx;
+	box->type = eBoxShape;
 	box->e = def.m_e;
-	box->next = m_boxes;
-	m_boxes = box;
-	box->ComputeAABB( m_tx, &aabb );
 
-	box->body = this;
-	box->friction = def.m_friction;
-	box->restitution = def.m_restitution;
-	box->density = def.m_density;
-	box->sensor = def.m_sensor;
+	AddShape( box, def );
 
-	CalculateMassData( );
+	return box;
+}
 
-	m_scene->m_contactManager.m_broadphase.InsertBox( box, aabb );
-	m_scene->m_newBox = true;
+//--------------------------------------------------------------------------------------------------
+const q3Sphere* q3Body::AddSphere( const q3SphereDef& def )
+{
+	q3Sphere* sphere = (q3Sphere*)m_scene->m_heap.Allocate( sizeof( q3Sphere ) );
+	sphere->type = eSphereShape;
+	sphere->radius = def.m_radius;
 
-	return box;
+	AddShape( sphere, def );
+
+	return sphere;
 }
 
 //--------------------------------------------------------------------------------------------------
-void q3Body::RemoveBox( const q3Box* box )
+const q3Capsule* q3Body::AddCapsule( const q3CapsuleDef& def )
+{
+	q3Capsule* capsule = (q3Capsule*)m_scene->m_heap.Allocate( sizeof( q3Capsule ) );
+	capsule->type = eCapsuleShape;
+	capsule->h = def.m_h;
+	capsule->radius = def.m_radius;
+
+	AddShape( capsule, def );
+
+	return capsule;
+}
+
+//--------------------------------------------------------------------------------------------------
+const q3Hull* q3Body::AddHull( const q3HullDef& def )
+{
+	q3Hull* hull = (q3Hull*)m_scene->m_heap.Allocate( sizeof( q3Hull ) );
+	hull->type = eHullShape;
+	hull->Build( def.m_points, def.m_count );
+
+	AddShape( hull, def );
+
+	return hull;
+}
+
+//--------------------------------------------------------------------------------------------------
+const q3Mesh* q3Body::AddMesh( const q3MeshDef& def )
 {
-	assert( box );
-	assert( box->body == this );
+	// Triangles have no volume and can only collide with dynamic shapes
+	assert( m_flags & eStatic );
 
-	q3Box* node = m_boxes;
+	q3Mesh* mesh = (q3Mesh*)m_scene->m_heap.Allocate( sizeof( q3Mesh ) );
+	mesh->type = eMeshShape;
+	mesh->Build( def.m_vertices, def.m_vertexCount, def.m_indices, def.m_triangleCount );
+
+	AddShape( mesh, def );
+
+	return mesh;
+}
+
+//--------------------------------------------------------------------------------------------------
+const q3Heightfield* q3Body::AddHeightfield( const q3HeightfieldDef& def )
+{
+	// Triangles have no volume and can only collide with dynamic shapes
+	assert( m_flags & eStatic );
+
+	q3Heightfield* heightfield = (q3Heightfield*)m_scene->m_heap.Allocate( sizeof( q3Heightfield ) );
+	heightfield->type = eHeightfieldShape;
+	heightfield->Build( def.m_heights, def.m_rows, def.m_columns, def.m_scale );
+
+	AddShape( heightfield, def );
+
+	return heightfield;
+}
+
+//--------------------------------------------------------------------------------------------------
+const q3Plane* q3Body::AddPlane( const q3PlaneDef& def )
+{
+	// Planes have no volume and can only collide with dynamic shapes
+	assert( m_flags & eStatic );
+
+	q3Plane* plane = (q3Plane*)m_scene->m_heap.Allocate( sizeof( q3Plane ) );
+	plane->type = ePlaneShape;
+
+	AddShape( plane, def );
+
+	return plane;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Body::RemoveShape( const q3Shape* shape )
+{
+	assert( shape );
+	assert( shape->body == this );
+
+	q3Shape* node = m_shapes;
 
 	bool found = false;
-	if ( node == box )
+	if ( node == shape )
 	{
-		m_boxes = node->next;
+		m_shapes = node->next;
 		found = true;
 	}
 
@@ -135,9 +222,9 @@ void q3Body::RemoveBox( const q3Box* box )
 	{
 		while ( node )
 		{
-			if ( node->next == box )
+			if ( node->next == shape )
 			{
-				node->next = box->next;
+				node->next = shape->next;
 				found = true;
 				break;
 			}
@@ -156,36 +243,76 @@ void q3Body::RemoveBox( const q3Box* box )
 		q3ContactConstraint* contact = edge->constraint;
 		edge = edge->next;
 
-		q3Box* A = contact->A;
-		q3Box* B = contact->B;
+		q3Shape* A = contact->A;
+		q3Shape* B = contact->B;
 
-		if ( box == A || box == B )
+		if ( shape == A || shape == B )
 			m_scene->m_contactManager.RemoveContact( contact );
 	}
 
-	m_scene->m_contactManager.m_broadphase.RemoveBox( box );
+	q3BroadPhase* broadphase = &m_scene->m_contactManager.m_broadphase;
+
+	if ( shape->type == ePlaneShape )
+		broadphase->RemovePlane( (q3Shape*)shape );
+
+	else
+		m_shapeTree.Remove( shape->treeIndex );
+
+	--m_shapeCount;
+
+	q3AABB aabb;
+	if ( ComputeAABB( &aabb ) )
+	{
+		broadphase->Update( m_broadPhaseIndex, aabb );
+		broadphase->TouchProxy( m_broadPhaseIndex );
+	}
+
+	else if ( m_broadPhaseIndex != -1 )
+		broadphase->RemoveBody( this );
 
 	CalculateMassData( );
 
-	m_scene->m_heap.Free( (void*)box );
+	FreeShape( (q3Shape*)shape );
 }
 
 //--------------------------------------------------------------------------------------------------
-void q3Body::RemoveAllBoxes( )
+void q3Body::RemoveBox( const q3Box* box )
 {
-	while ( m_boxes )
+	RemoveShape( box );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Body::RemoveAllShapes( )
+{
+	while ( m_shapes )
 	{
-		q3Box* next = m_boxes->next;
+		q3Shape* next = m_shapes->next;
 
-		m_scene->m_contactManager.m_broadphase.RemoveBox( m_boxes );
-		m_scene->m_heap.Free( (void*)m_boxes );
+		if ( m_shapes->type == ePlaneShape )
+			m_scene->m_contactManager.m_broadphase.RemovePlane( m_shapes );
 
-		m_boxes = next;
+		else
+			m_shapeTree.Remove( m_shapes->treeIndex );
+
+		FreeShape( m_shapes );
+
+		m_shapes = next;
 	}
 
+	m_shapeCount = 0;
+
+	if ( m_broadPhaseIndex != -1 )
+		m_scene->m_contactManager.m_broadphase.RemoveBody( this );
+
 	m_scene->m_contactManager.RemoveContactsFromBody( this );
 }
 
+//--------------------------------------------------------------------------------------------------
+void q3Body::RemoveAllBoxes( )
+{
+	RemoveAllShapes( );
+}
+
 //--------------------------------------------------------------------------------------------------
 void q3Body::ApplyLinearForce( const q3Vec3& force )
 {
@@ -233,6 +360,11 @@ void q3Body::SetToAwake( )
 	{
 		m_flags |= eAwake;
 		m_sleepTime = r32( 0.0 );
+
+		if ( m_islandSet )
+			m_islandSet->awake = true;
+
+		m_scene->m_contactManager.WakeContacts( this );
 	}
 }
 
@@ -245,6 +377,11 @@ void q3Body::SetToSleep( )
 	q3Identity( m_angularVelocity );
 	q3Identity( m_force );
 	q3Identity( m_torque );
+
+	// The proxy returns to the awake tree once Step gathers the body's
+	// island, since waking can happen while the broadphase finds pairs
+	if ( m_scene )
+		m_scene->m_contactManager.m_broadphase.SetBodyAwake( this, false );
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -253,6 +390,22 @@ bool q3Body::IsAwake( ) const
 	return m_flags & eAwake ? true : false;
 }
 
+//--------------------------------------------------------------------------------------------------
+void q3Body::SetBullet( bool flag )
+{
+	if ( flag && (m_flags & eDynamic) )
+		m_flags |= eBullet;
+
+	else
+		m_flags &= ~eBullet;
+}
+
+//--------------------------------------------------------------------------------------------------
+bool q3Body::IsBullet( ) const
+{
+	return m_flags & eBullet ? true : false;
+}
+
 //--------------------------------------------------------------------------------------------------
 r32 q3Body::GetMass( ) const
 {
@@ -380,6 +533,9 @@ void q3Body::SetTransform( const q3Vec3& position )
 	m_worldCenter = position;
 
 	SynchronizeProxies( );
+
+	if ( m_shapeCount > 1 )
+		m_scene->m_contactManager.m_broadphase.TouchProxy( m_broadPhaseIndex );
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -390,6 +546,9 @@ void q3Body::SetTransform( const q3Vec3& position, const q3Vec3& axis, r32 angle
 	m_tx.rotation = m_q.ToMat3( );
 
 	SynchronizeProxies( );
+
+	if ( m_shapeCount > 1 )
+		m_scene->m_contactManager.m_broadphase.TouchProxy( m_broadPhaseIndex );
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -450,12 +609,12 @@ r32 q3Body::GetAngularDamping( r32 damping ) const
 void q3Body::Render( q3Render* render ) const
 {
 	bool awake = IsAwake( );
-	q3Box* box = m_boxes;
+	q3Shape* shape = m_shapes;
 
-	while ( box )
+	while ( shape )
 	{
-		box->Render( m_tx, awake, render );
-		box = box->next;
+		shape->Render( m_tx, awake, render );
+		shape = shape->next;
 	}
 }
 
@@ -496,33 +655,160 @@ void q3Body::Dump( FILE* file, i32 index ) const
 	fprintf( file, "\tbd.lockAxisX = bool( %d );\n", m_flags & eLockAxisX );
 	fprintf( file, "\tbd.lockAxisY = bool( %d );\n", m_flags & eLockAxisY );
 	fprintf( file, "\tbd.lockAxisZ = bool( %d );\n", m_flags & eLockAxisZ );
+	fprintf( file, "\tbd.bullet = bool( %d );\n", m_flags & eBullet );
 	fprintf( file, "\tbodies[ %d ] = scene.CreateBody( bd );\n\n", index );
 
-	q3Box* box = m_boxes;
-
-	while ( box )
+	for ( q3Shape* shape = m_shapes; shape; shape = shape->next )
 	{
 		fprintf( file, "\t{\n" );
-		fprintf( file, "\t\tq3BoxDef sd;\n" );
-		fprintf( file, "\t\tsd.SetFriction( r32( %.15lf ) );\n", box->friction );
-		fprintf( file, "\t\tsd.SetRestitution( r32( %.15lf ) );\n", box->restitution );
-		fprintf( file, "\t\tsd.SetDensity( r32( %.15lf ) );\n", box->density );
-		i32 sensor = (int)box->sensor;
+
+		switch ( shape->type )
+		{
+		case eSphereShape:
+			fprintf( file, "\t\tq3SphereDef sd;\n" );
+			break;
+
+		case eCapsuleShape:
+			fprintf( file, "\t\tq3CapsuleDef sd;\n" );
+			break;
+
+		case eBoxShape:
+			fprintf( file, "\t\tq3BoxDef sd;\n" );
+			break;
+
+		case eHullShape:
+			fprintf( file, "\t\tq3HullDef sd;\n" );
+			break;
+
+		case eMeshShape:
+			fprintf( file, "\t\tq3MeshDef sd;\n" );
+			break;
+
+		case eHeightfieldShape:
+			fprintf( file, "\t\tq3HeightfieldDef sd;\n" );
+			break;
+
+		case ePlaneShape:
+			fprintf( file, "\t\tq3PlaneDef sd;\n" );
+			break;
+		}
+
+		fprintf( file, "\t\tsd.SetFriction( r32( %.15lf ) );\n", shape->friction );
+		fprintf( file, "\t\tsd.SetRestitution( r32( %.15lf ) );\n", shape->restitution );
+		fprintf( file, "\t\tsd.SetDensity( r32( %.15lf ) );\n", shape->density );
+		i32 sensor = (int)shape->sensor;
 		fprintf( file, "\t\tsd.SetSensor( bool( %d ) );\n", sensor );
-		fprintf( file, "\t\tq3Transform boxTx;\n" );
-		q3Transform boxTx = box->local;
-		q3Vec3 xAxis = boxTx.rotation.ex;
-		q3Vec3 yAxis = boxTx.rotation.ey;
-		q3Vec3 zAxis = boxTx.rotation.ez;
+		fprintf( file, "\t\tq3Transform tx;\n" );
+		q3Transform tx = shape->local;
+		q3Vec3 xAxis = tx.rotation.ex;
+		q3Vec3 yAxis = tx.rotation.ey;
+		q3Vec3 zAxis = tx.rotation.ez;
 		fprintf( file, "\t\tq3Vec3 xAxis( r32( %.15lf ), r32( %.15lf ), r32( %.15lf ) );\n", xAxis.x, xAxis.y, xAxis.z );
 		fprintf( file, "\t\tq3Vec3 yAxis( r32( %.15lf ), r32( %.15lf ), r32( %.15lf ) );\n", yAxis.x, yAxis.y, yAxis.z );
 		fprintf( file, "\t\tq3Vec3 zAxis( r32( %.15lf ), r32( %.15lf ), r32( %.15lf ) );\n", zAxis.x, zAxis.y, zAxis.z );
-		fprintf( file, "\t\tboxTx.rotation.SetRows( xAxis, yAxis, zAxis );\n" );
-		fprintf( file, "\t\tboxTx.position.Set( r32( %.15lf ), r32( %.15lf ), r32( %.15lf ) );\n", boxTx.position.x, boxTx.position.y, boxTx.position.z );
-		fprintf( file, "\t\tsd.Set( boxTx, q3Vec3( r32( %.15lf ), r32( %.15lf ), r32( %.15lf ) ) );\n", box->e.x * 2.0f, box->e.y * 2.0f, box->e.z * 2.0f );
-		fprintf( file, "\t\tbodies[ %d ]->AddBox( sd );\n", index );
+		fprintf( file, "\t\ttx.rotation.SetRows( xAxis, yAxis, zAxis );\n" );
+		fprintf( file, "\t\ttx.position.Set( r32( %.15lf ), r32( %.15lf ), r32( %.15lf ) );\n", tx.position.x, tx.position.y, tx.position.z );
+
+		switch ( shape->type )
+		{
+		case eSphereShape:
+		{
+			const q3Sphere* sphere = (const q3Sphere*)shape;
+			fprintf( file, "\t\tsd.Set( tx, r32( %.15lf ) );\n", sphere->radius );
+			fprintf( file, "\t\tbodies[ %d ]->AddSphere( sd );\n", index );
+		}
+			break;
+
+		case eCapsuleShape:
+		{
+			const q3Capsule* capsule = (const q3Capsule*)shape;
+			fprintf( file, "\t\tsd.Set( tx, r32( %.15lf ), r32( %.15lf ) );\n", capsule->h * 2.0f, capsule->radius );
+			fprintf( file, "\t\tbodies[ %d ]->AddCapsule( sd );\n", index );
+		}
+			break;
+
+		case eBoxShape:
+		{
+			const q3Box* box = (const q3Box*)shape;
+			fprintf( file, "\t\tsd.Set( tx, q3Vec3( r32( %.15lf ), r32( %.15lf ), r32( %.15lf ) ) );\n", box->e.x * 2.0f, box->e.y * 2.0f, box->e.z * 2.0f );
+			fprintf( file, "\t\tbodies[ %d ]->AddBox( sd );\n", index );
+		}
+			break;
+
+		case eHullShape:
+		{
+			const q3Hull* hull = (const q3Hull*)shape;
+			fprintf( file, "\t\tstatic const q3Vec3 points[ %d ] = {\n", hull->vertexCount );
+
+			for ( i32 i = 0; i < hull->vertexCount; ++i )
+			{
+				const q3Vec3& v = hull->vertices[ i ];
+				fprintf( file, "\t\t\tq3Vec3( r32( %.15lf ), r32( %.15lf ), r32( %.15lf ) ),\n", v.x, v.y, v.z );
+			}
+
+			fprintf( file, "\t\t};\n" );
+			fprintf( file, "\t\tsd.Set( tx, points, %d );\n", hull->vertexCount );
+			fprintf( file, "\t\tbodies[ %d ]->AddHull( sd );\n", index );
+		}
+			break;
+
+		case eMeshShape:
+		{
+			const q3Mesh* mesh = (const q3Mesh*)shape;
+			fprintf( file, "\t\tstatic const q3Vec3 vertices[ %d ] = {\n", mesh->vertexCount );
+
+			for ( i32 i = 0; i < mesh->vertexCount; ++i )
+			{
+				const q3Vec3& v = mesh->vertices[ i ];
+				fprintf( file, "\t\t\tq3Vec3( r32( %.15lf ), r32( %.15lf ), r32( %.15lf ) ),\n", v.x, v.y, v.z );
+			}
+
+			fprintf( file, "\t\t};\n" );
+			fprintf( file, "\t\tstatic const i32 indices[ %d ] = {\n", mesh->triangleCount * 3 );
+
+			for ( i32 i = 0; i < mesh->triangleCount; ++i )
+			{
+				const i32* tri = mesh->indices + i * 3;
+				fprintf( file, "\t\t\t%d, %d, %d,\n", tri[ 0 ], tri[ 1 ], tri[ 2 ] );
+			}
+
+			fprintf( file, "\t\t};\n" );
+			fprintf( file, "\t\tsd.Set( tx, vertices, %d, indices, %d );\n", mesh->vertexCount, mesh->triangleCount );
+			fprintf( file, "\t\tbodies[ %d ]->AddMesh( sd );\n", index );
+		}
+			break;
+
+		case eHeightfieldShape:
+		{
+			const q3Heightfield* heightfield = (const q3Heightfield*)shape;
+			i32 rows = heightfield->rows;
+			i32 columns = heightfield->columns;
+			fprintf( file, "\t\tstatic const r32 heights[ %d ] = {\n", rows * columns );
+
+			for ( i32 i = 0; i < rows; ++i )
+			{
+				fprintf( file, "\t\t\t" );
+
+				for ( i32 j = 0; j < columns; ++j )
+					fprintf( file, "r32( %.15lf ), ", heightfield->heights[ i * columns + j ] );
+
+				fprintf( file, "\n" );
+			}
+
+			const q3Vec3& scale = heightfield->scale;
+			fprintf( file, "\t\t};\n" );
+			fprintf( file, "\t\tsd.Set( tx, heights, %d, %d, q3Vec3( r32( %.15lf ), r32( %.15lf ), r32( %.15lf ) ) );\n", rows, columns, scale.x, scale.y, scale.z );
+			fprintf( file, "\t\tbodies[ %d ]->AddHeightfield( sd );\n", index );
+		}
+			break;
+
+		case ePlaneShape:
+			fprintf( file, "\t\tsd.Set( tx );\n" );
+			fprintf( file, "\t\tbodies[ %d ]->AddPlane( sd );\n", index );
+			break;
+		}
+
 		fprintf( file, "\t}\n" );
-		box = box->next;
 	}
 
 	fprintf( file, "}\n\n" );
@@ -535,6 +821,10 @@ void q3Body::CalculateMassData( )
 	m_invInertiaModel = q3Diagonal( r32( 0.0 ) );
 	m_invInertiaWorld = q3Diagonal( r32( 0.0 ) );
 	m_invMass = r32( 0.0 );
+	m_flags |= eIsotropicInertia | eDiagonalInertia;
+
+	// No orientation matches, forcing the world inertia to be recomputed
+	m_qInertia = q3Quaternion( r32( 0.0 ), r32( 0.0 ), r32( 0.0 ), r32( 0.0 ) );
 	m_mass = r32( 0.0 );
 	r32 mass = r32( 0.0 );
 
@@ -548,13 +838,13 @@ void q3Body::CalculateMassData( )
 	q3Vec3 lc;
 	q3Identity( lc );
 
-	for ( q3Box* box = m_boxes; box; box = box->next)
+	for ( q3Shape* shape = m_shapes; shape; shape = shape->next )
 	{
-		if ( box->density == r32( 0.0 ) )
+		if ( shape->density == r32( 0.0 ) )
 			continue;
 
 		q3MassData md;
-		box->ComputeMass( &md );
+		shape->ComputeMass( &md );
 		mass += md.mass;
 		inertia += md.inertia;
 		lc += md.center * md.mass;
@@ -578,6 +868,21 @@ void q3Body::CalculateMassData( )
 
 		if ( m_flags & eLockAxisZ )
 			q3Identity( m_invInertiaModel.ez );
+
+		const q3Mat3& m = m_invInertiaModel;
+		bool diagonal = m.ex.y == r32( 0.0 ) && m.ex.z == r32( 0.0 )
+			&& m.ey.x == r32( 0.0 ) && m.ey.z == r32( 0.0 )
+			&& m.ez.x == r32( 0.0 ) && m.ez.y == r32( 0.0 );
+
+		if ( !diagonal )
+			m_flags &= ~(eIsotropicInertia | eDiagonalInertia);
+
+		else if ( m.ex.x != m.ey.y || m.ex.x != m.ez.z )
+			m_flags &= ~eIsotropicInertia;
+
+		// Rotation leaves an isotropic inertia unchanged
+		if ( m_flags & eIsotropicInertia )
+			m_invInertiaWorld = m_invInertiaModel;
 	}
 	else
 	{
@@ -591,6 +896,34 @@ void q3Body::CalculateMassData( )
 	m_worldCenter = q3Mul( m_tx, lc );
 }
 
+//--------------------------------------------------------------------------------------------------
+void q3Body::UpdateInvInertiaWorld( )
+{
+	if ( m_flags & eIsotropicInertia )
+		return;
+
+	// Only a change of orientation changes the world inertia
+	if ( m_q.x == m_qInertia.x && m_q.y == m_qInertia.y && m_q.z == m_qInertia.z && m_q.w == m_qInertia.w )
+		return;
+
+	m_qInertia = m_q;
+	const q3Mat3& r = m_tx.rotation;
+
+	if ( m_flags & eDiagonalInertia )
+	{
+		// R * D * R^T as the columns of R scaled by the diagonal of D
+		q3Vec3 a = r.ex * m_invInertiaModel.ex.x;
+		q3Vec3 b = r.ey * m_invInertiaModel.ey.y;
+		q3Vec3 c = r.ez * m_invInertiaModel.ez.z;
+		m_invInertiaWorld.ex = a * r.ex.x + b * r.ey.x + c * r.ez.x;
+		m_invInertiaWorld.ey = a * r.ex.y + b * r.ey.y + c * r.ez.y;
+		m_invInertiaWorld.ez = a * r.ex.z + b * r.ey.z + c * r.ez.z;
+	}
+
+	else
+		m_invInertiaWorld = r * m_invInertiaModel * q3Transpose( r );
+}
+
 //--------------------------------------------------------------------------------------------------
 void q3Body::SynchronizeProxies( )
 {
@@ -598,14 +931,122 @@ void q3Body::SynchronizeProxies( )
 
 	m_tx.position = m_worldCenter - q3Mul( m_tx.rotation, m_localCenter );
 
+	if ( m_broadPhaseIndex == -1 )
+		return;
+
 	q3AABB aabb;
-	q3Transform tx = m_tx;
+	ComputeAABB( &aabb );
 
-	q3Box* box = m_boxes;
-	while ( box )
+	// Leave room for speculative contacts along the motion of the next step
+	if ( m_scene->m_enableSpeculative )
 	{
-		box->ComputeAABB( tx, &aabb );
-		broadphase->Update( box->broadPhaseIndex, aabb );
-		box = box->next;
+		q3Vec3 d = m_linearVelocity * m_scene->m_dt;
+		aabb.min = q3Min( aabb.min, aabb.min + d );
+		aabb.max = q3Max( aabb.max, aabb.max + d );
 	}
+
+	broadphase->Update( m_broadPhaseIndex, aabb );
+
+	// Shapes of a compound body move relative to other bodies even while
+	// the body stays within its fat AABB, so shape pairs are searched again
+	if ( m_shapeCount > 1 && (m_flags & eAwake) )
+		broadphase->TouchProxy( m_broadPhaseIndex );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Body::AddShape( q3Shape* shape, const q3ShapeDef& def )
+{
+	shape->local = def.m_tx;
+	shape->next = m_shapes;
+	m_shapes = shape;
+	++m_shapeCount;
+
+	shape->body = this;
+	shape->friction = def.m_friction;
+	shape->restitution = def.m_restitution;
+	shape->density = def.m_density;
+	shape->sensor = def.m_sensor;
+	shape->userData = NULL;
+
+	CalculateMassData( );
+
+	q3BroadPhase* broadphase = &m_scene->m_contactManager.m_broadphase;
+
+	if ( shape->type == ePlaneShape )
+	{
+		shape->treeIndex = -1;
+		broadphase->InsertPlane( shape );
+
+		// Bodies only look for planes when their proxy moves
+		for ( q3Body* body = m_scene->m_bodyList; body; body = body->m_next )
+		{
+			if ( body->m_broadPhaseIndex != -1 )
+				broadphase->TouchProxy( body->m_broadPhaseIndex );
+		}
+
+		m_scene->m_newBox = true;
+		return;
+	}
+
+	q3AABB aabb;
+	q3Transform identity;
+	q3Identity( identity );
+	shape->ComputeAABB( identity, &aabb );
+	shape->treeIndex = m_shapeTree.Insert( aabb, shape );
+	ComputeAABB( &aabb );
+
+	if ( m_broadPhaseIndex == -1 )
+		broadphase->InsertBody( this, aabb );
+
+	else
+	{
+		// Existing shape pairs against this body must be found again
+		broadphase->Update( m_broadPhaseIndex, aabb );
+		broadphase->TouchProxy( m_broadPhaseIndex );
+	}
+
+	m_scene->m_newBox = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Body::FreeShape( q3Shape* shape )
+{
+	switch ( shape->type )
+	{
+	case eHullShape:
+		((q3Hull*)shape)->Free( );
+		break;
+
+	case eMeshShape:
+		((q3Mesh*)shape)->Free( );
+		break;
+
+	case eHeightfieldShape:
+		((q3Heightfield*)shape)->Free( );
+		break;
+
+	default:
+		break;
+	}
+
+	m_scene->m_heap.Free( (void*)shape );
+}
+
+//--------------------------------------------------------------------------------------------------
+bool q3Body::ComputeAABB( q3AABB* aabb ) const
+{
+	bool found = false;
+
+	for ( q3Shape* shape = m_shapes; shape; shape = shape->next )
+	{
+		if ( shape->type == ePlaneShape )
+			continue;
+
+		q3AABB shapeAABB;
+		shape->ComputeAABB( m_tx, &shapeAABB );
+		*aabb = found ? q3Combine( *aabb, shapeAABB ) : shapeAABB;
+		found = true;
+	}
+
+	return found;
 }
@@ -31,16 +31,32 @@
 
 #include "../math/q3Math.h"
 #include "../math/q3Transform.h"
+#include "../broadphase/q3DynamicAABBTree.h"
 
 //--------------------------------------------------------------------------------------------------
 // q3Body
 //--------------------------------------------------------------------------------------------------
 class q3Scene;
 struct q3BodyDef;
+class q3ShapeDef;
+class q3SphereDef;
+class q3CapsuleDef;
 class q3BoxDef;
+class q3HullDef;
+class q3MeshDef;
+class q3HeightfieldDef;
+class q3PlaneDef;
 struct q3ContactEdge;
+struct q3IslandSet;
 class q3Render;
+struct q3Shape;
+struct q3Sphere;
+struct q3Capsule;
 struct q3Box;
+struct q3Hull;
+struct q3Mesh;
+struct q3Heightfield;
+struct q3Plane;
 
 enum q3BodyType
 {
@@ -59,12 +75,39 @@ public:
 	// will be created until the next q3Scene::Step( ) call.
 	const q3Box* AddBox( const q3BoxDef& def );
 
-	// Removes this box from the body and broadphase. Forces the body
+	// Adds a sphere or capsule to this body. Like boxes these are defined
+	// in the local space of the body. Rounded shapes collide much more
+	// cheaply than boxes and are well suited to debris and characters.
+	const q3Sphere* AddSphere( const q3SphereDef& def );
+	const q3Capsule* AddCapsule( const q3CapsuleDef& def );
+
+	// Adds the convex hull of a cloud of points to this body. Hulls can
+	// represent rocks, wedges and other convex shapes that boxes cannot,
+	// at a greater cost for collision.
+	const q3Hull* AddHull( const q3HullDef& def );
+
+	// Adds a static triangle mesh to this body, which must be static.
+	// The mesh data is copied and placed into a BVH. A single mesh can
+	// stand in for large numbers of static boxes.
+	const q3Mesh* AddMesh( const q3MeshDef& def );
+
+	// Adds a heightfield to this body, which must be static. Only the
+	// height samples are copied, making heightfields the cheapest way to
+	// represent large terrains.
+	const q3Heightfield* AddHeightfield( const q3HeightfieldDef& def );
+
+	// Adds an infinite plane to this body, which must be static. Planes
+	// are not placed in the broadphase, making them the cheapest ground.
+	const q3Plane* AddPlane( const q3PlaneDef& def );
+
+	// Removes this shape from the body and broadphase. Forces the body
 	// to recompute its mass if the body is dynamic. Frees the memory
-	// pointed to by the box pointer.
+	// pointed to by the shape pointer.
+	void RemoveShape( const q3Shape* shape );
 	void RemoveBox( const q3Box* box );
 
-	// Removes all boxes from this body and the broadphase.
+	// Removes all shapes from this body and the broadphase.
+	void RemoveAllShapes( );
 	void RemoveAllBoxes( );
 
 	void ApplyLinearForce( const q3Vec3& force );
@@ -75,6 +118,11 @@ public:
 	void SetToAwake( );
 	void SetToSleep( );
 	bool IsAwake( ) const;
+
+	// Bullets are swept against static and kinematic bodies to prevent
+	// tunneling. Only dynamic bodies can be bullets.
+	void SetBullet( bool flag );
+	bool IsBullet( ) const;
 	r32 GetGravityScale( ) const;
 	void SetGravityScale( r32 scale );
 	const q3Vec3 GetLocalPoint( const q3Vec3& p ) const;
@@ -129,6 +177,9 @@ private:
 		eLockAxisX	= 0x100,
 		eLockAxisY	= 0x200,
 		eLockAxisZ	= 0x400,
+		eBullet		= 0x800,
+		eIsotropicInertia	= 0x1000,	// Inverse inertia the same in every frame
+		eDiagonalInertia	= 0x2000,	// Inverse inertia diagonal in the model frame
 	};
 
 	q3Mat3 m_invInertiaModel;
@@ -143,18 +194,33 @@ private:
 	q3Quaternion m_q;
 	q3Vec3 m_localCenter;
 	q3Vec3 m_worldCenter;
+	q3Vec3 m_worldCenter0;	// Start of the step, the sweep of a bullet begins here
+	q3Quaternion m_q0;
+	q3Quaternion m_qInertia;	// Orientation m_invInertiaWorld was computed at
 	r32 m_sleepTime;
 	r32 m_gravityScale;
 	i32 m_layers;
 	i32 m_flags;
 
-	q3Box* m_boxes;
+	q3Shape* m_shapes;
+	i32 m_shapeCount;
+
+	// Bodies own a single proxy in the broadphase. Shapes are stored in a
+	// local space tree to find overlapping shape pairs of compound bodies.
+	q3DynamicAABBTree m_shapeTree;
+	i32 m_broadPhaseIndex;
+
 	void *m_userData;
 	q3Scene* m_scene;
 	q3Body* m_next;
 	q3Body* m_prev;
 	i32 m_islandIndex;
 
+	// Island set of the body and its neighbors within the set's body list
+	q3IslandSet* m_islandSet;
+	q3Body* m_islandNext;
+	q3Body* m_islandPrev;
+
 	r32 m_linearDamping;
 	r32 m_angularDamping;
 
@@ -164,12 +230,22 @@ private:
 	friend struct q3Manifold;
 	friend class q3ContactManager;
 	friend struct q3Island;
+	friend struct q3ContactHeightSort;
 	friend struct q3ContactSolver;
+	friend struct q3TOISolver;
+	friend class q3BroadPhase;
 
 	q3Body( const q3BodyDef& def, q3Scene* scene );
+	~q3Body( );
 
 	void CalculateMassData( );
+	void UpdateInvInertiaWorld( );
 	void SynchronizeProxies( );
+	// Bounds all shapes except planes. Returns false if the body holds
+	// no other shapes.
+	bool ComputeAABB( q3AABB* aabb ) const;
+	void AddShape( q3Shape* shape, const q3ShapeDef& def );
+	void FreeShape( q3Shape* shape );
 };
 
 //--------------------------------------------------------------------------------------------------
@@ -199,6 +275,7 @@ struct q3BodyDef
 		lockAxisX = false;
 		lockAxisY = false;
 		lockAxisZ = false;
+		bullet = false;
 
 		linearDamping = r32( 0.0 );
 		angularDamping = r32( 0.1 );
@@ -229,6 +306,7 @@ struct q3BodyDef
 	bool lockAxisX;		// Locked rotation on the x axis.
 	bool lockAxisY;		// Locked rotation on the y axis.
 	bool lockAxisZ;		// Locked rotation on the z axis.
+	bool bullet;		// Continuous collision against static and kinematic bodies. Fast moving dynamic bodies only.
 };
 
 #endif // Q3BODY_H
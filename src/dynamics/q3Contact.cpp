@@ -29,7 +29,7 @@
 //--------------------------------------------------------------------------------------------------
 // q3Contact
 //--------------------------------------------------------------------------------------------------
-void q3Manifold::SetPair( q3Box *a, q3Box *b )
+void q3Manifold::SetPair( q3Shape *a, q3Shape *b )
 {
 	A = a;
 	B = b;
@@ -41,10 +41,28 @@ void q3Manifold::SetPair( q3Box *a, q3Box *b )
 void q3ContactConstraint::SolveCollision( void )
 {
 	manifold.contactCount = 0;
+	bool touching = false;
 
-	q3BoxtoBox( &manifold, A, B );
+	// Sensors are never solved, so only overlap is needed
+	if ( manifold.sensor )
+	{
+		manifold.normal.SetAll( r32( 0.0 ) );
+		touching = q3Overlap( A, B, childB );
+	}
+
+	else
+	{
+		q3Collide( &manifold, A, B, childB );
+
+		// Only touching shapes are colliding, speculative contacts alone are not
+		for ( i32 i = 0; i < manifold.contactCount; ++i )
+		{
+			if ( manifold.contacts[ i ].penetration <= r32( 0.0 ) )
+				touching = true;
+		}
+	}
 
-	if ( manifold.contactCount > 0 )
+	if ( touching )
 	{
 		if ( m_flags & eColliding )
 			m_flags |= eWasColliding;
@@ -36,19 +36,19 @@
 // q3Contact
 //--------------------------------------------------------------------------------------------------
 class q3Body;
-struct q3Box;
+struct q3Shape;
 struct q3ContactConstraint;
 
 // Restitution mixing. The idea is to use the maximum bounciness, so bouncy
 // objects will never not bounce during collisions.
-inline r32 q3MixRestitution( const q3Box* A, const q3Box* B )
+inline r32 q3MixRestitution( const q3Shape* A, const q3Shape* B )
 {
 	return q3Max( A->restitution, B->restitution );
 }
 
 // Friction mixing. The idea is to allow a very low friction value to
 // drive down the mixing result. Example: anything slides on ice.
-inline r32 q3MixFriction( const q3Box* A, const q3Box* B )
+inline r32 q3MixFriction( const q3Shape* A, const q3Shape* B )
 {
 	return std::sqrt( A->friction * B->friction );
 }
@@ -92,16 +92,25 @@ struct q3Contact
 
 struct q3Manifold
 {
-	void SetPair( q3Box *a, q3Box *b );
+	void SetPair( q3Shape *a, q3Shape *b );
 
-	q3Box *A;
-	q3Box *B;
+	q3Shape *A;
+	q3Shape *B;
 
 	q3Vec3 normal;				// From A to B
 	q3Vec3 tangentVectors[ 2 ];	// Tangent vectors
 	q3Contact contacts[ 8 ];
 	i32 contactCount;
 
+	// Friction solved once at the center of the contacts, see
+	// q3Scene::SetEnableCentralFriction
+	r32 tangentImpulse[ 2 ];
+	r32 twistImpulse;
+
+	// Contacts are kept up to this separation. Separated contacts have
+	// a positive penetration and are speculative.
+	r32 margin;
+
 	q3Manifold* next;
 	q3Manifold* prev;
 
@@ -120,14 +129,19 @@ struct q3ContactConstraint
 {
 	void SolveCollision( void );
 
-	q3Box *A, *B;
+	q3Shape *A, *B;
 	q3Body *bodyA, *bodyB;
+	i32 childB;		// Triangle of B for meshes and heightfields, otherwise zero
 
 	q3ContactEdge edgeA;
 	q3ContactEdge edgeB;
 	q3ContactConstraint* next;
 	q3ContactConstraint* prev;
 
+	// Contact list of the island set of the bodies, see q3IslandSet
+	q3ContactConstraint* islandNext;
+	q3ContactConstraint* islandPrev;
+
 	r32 friction;
 	r32 restitution;
 
@@ -137,7 +151,8 @@ struct q3ContactConstraint
 	{
 		eColliding    = 0x00000001, // Set when contact collides during a step
 		eWasColliding = 0x00000002, // Set when two objects stop colliding
-		eIsland       = 0x00000004, // For internal marking during island forming
+		eIsland       = 0x00000004, // Linked into the island set of its bodies
+		eSleeping     = 0x00000008, // Kept in the sleeping contact list
 	};
 
 	i32 m_flags;
@@ -148,4 +163,25 @@ struct q3ContactConstraint
 	friend struct q3ContactSolver;
 };
 
+enum q3ContactEventType
+{
+	eBeginContact,
+	ePersistContact,
+	eEndContact
+};
+
+// A contact event recorded during a step when the scene buffers events
+// instead of calling the q3ContactListener. contact is NULL for end events,
+// otherwise it stays valid until the next step or until either body is
+// removed.
+struct q3ContactEvent
+{
+	q3ContactEventType type;
+	q3Shape *A, *B;
+	q3Body *bodyA, *bodyB;
+	const q3ContactConstraint *contact;
+	q3Vec3 normal;		// From A to B
+	r32 maxImpulse;		// Largest normal impulse of the step, zero for end events
+};
+
 #endif // Q3CONTACT_H
@@ -28,6 +28,7 @@
 #include "../collision/q3Box.h"
 #include "q3Body.h"
 #include "q3Contact.h"
+#include "q3Island.h"
 #include "../scene/q3Scene.h"
 #include "../debug/q3Render.h"
 
@@ -37,16 +38,35 @@
 q3ContactManager::q3ContactManager( q3Stack* stack )
 	: m_stack( stack )
 	, m_allocator( sizeof( q3ContactConstraint ), 256 )
+	, m_islandAllocator( sizeof( q3IslandSet ), 256 )
 	, m_broadphase( this )
 {
 	m_contactList = NULL;
+	m_sleepingContactList = NULL;
+	m_islandList = NULL;
 	m_contactCount = 0;
 	m_contactListener = NULL;
+	m_speculativeDt = r32( 0.0 );
+	m_coherenceSpeed = r32( 0.0 );
+
+	m_bufferEvents = false;
+	m_eventCount = 0;
+	m_eventCapacity = 64;
+	m_events = (q3ContactEvent*)q3Alloc( m_eventCapacity * sizeof( q3ContactEvent ) );
 }
 
 //--------------------------------------------------------------------------------------------------
-void q3ContactManager::AddContact( q3Box *A, q3Box *B )
+q3ContactManager::~q3ContactManager( )
 {
+	q3Free( m_events );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3ContactManager::AddContact( q3Shape *A, q3Shape *B, i32 childB )
+{
+	// Collision routines expect shapes ordered by type
+	assert( A->type <= B->type );
+
 	q3Body *bodyA = A->body;
 	q3Body *bodyB = B->body;
 	if ( !bodyA->CanCollide( bodyB ) )
@@ -60,11 +80,11 @@ void q3ContactManager::AddContact( q3Box *A, q3Box *B )
 	{
 		if ( edge->other == bodyB )
 		{
-			q3Box *shapeA = edge->constraint->A;
-			q3Box *shapeB = edge->constraint->B;
+			q3Shape *shapeA = edge->constraint->A;
+			q3Shape *shapeB = edge->constraint->B;
 
 			// @TODO: Verify this against Box2D; not sure if this is all we need here
-			if( (A == shapeA) && (B == shapeB) )
+			if( (A == shapeA) && (B == shapeB) && (childB == edge->constraint->childB) )
 				return;
 		}
 
@@ -75,6 +95,7 @@ void q3ContactManager::AddContact( q3Box *A, q3Box *B )
 	q3ContactConstraint *contact = (q3ContactConstraint*)m_allocator.Allocate( );
 	contact->A = A;
 	contact->B = B;
+	contact->childB = childB;
 	contact->bodyA = A->body;
 	contact->bodyB = B->body;
 	contact->manifold.SetPair( A, B );
@@ -82,15 +103,15 @@ void q3ContactManager::AddContact( q3Box *A, q3Box *B )
 	contact->friction = q3MixFriction( A, B );
 	contact->restitution = q3MixRestitution( A, B );
 	contact->manifold.contactCount = 0;
+	contact->manifold.margin = r32( 0.0 );
+	contact->manifold.tangentImpulse[ 0 ] = r32( 0.0 );
+	contact->manifold.tangentImpulse[ 1 ] = r32( 0.0 );
+	contact->manifold.twistImpulse = r32( 0.0 );
 
 	for ( i32 i = 0; i < 8; ++i )
 		contact->manifold.contacts[ i ].warmStarted = 0;
 
-	contact->prev = NULL;
-	contact->next = m_contactList;
-	if ( m_contactList )
-		m_contactList->prev = contact;
-	m_contactList = contact;
+	InsertIntoList( contact );
 
 	// Connect A
 	contact->edgeA.constraint = contact;
@@ -130,6 +151,9 @@ void q3ContactManager::RemoveContact( q3ContactConstraint *contact )
 	q3Body *A = contact->bodyA;
 	q3Body *B = contact->bodyB;
 
+	if ( contact->m_flags & q3ContactConstraint::eIsland )
+		UnlinkContact( contact );
+
 	// Remove from A
 	if ( contact->edgeA.prev )
 		contact->edgeA.prev->next = contact->edgeA.next;
@@ -154,14 +178,7 @@ void q3ContactManager::RemoveContact( q3ContactConstraint *contact )
 	B->SetToAwake( );
 
 	// Remove contact from the manager
-	if ( contact->prev )
-		contact->prev->next = contact->next;
-
-	if ( contact->next )
-		contact->next->prev = contact->prev;
-
-	if ( contact == m_contactList )
-		m_contactList = contact->next;
+	RemoveFromList( contact );
 
 	--m_contactCount;
 
@@ -182,89 +199,172 @@ void q3ContactManager::RemoveContactsFromBody( q3Body *body )
 }
 
 //--------------------------------------------------------------------------------------------------
-void q3ContactManager::RemoveFromBroadphase( q3Body *body )
+void q3ContactManager::WakeContacts( q3Body *body )
 {
-	q3Box* box = body->m_boxes;
-
-	while ( box )
+	for ( q3ContactEdge* edge = body->m_contactList; edge; edge = edge->next )
 	{
-		m_broadphase.RemoveBox( box );
-		box = box->next;
+		q3ContactConstraint* contact = edge->constraint;
+
+		if ( contact->m_flags & q3ContactConstraint::eSleeping )
+		{
+			RemoveFromList( contact );
+			contact->m_flags &= ~q3ContactConstraint::eSleeping;
+			InsertIntoList( contact );
+		}
 	}
 }
 
+//--------------------------------------------------------------------------------------------------
+void q3ContactManager::RemoveFromBroadphase( q3Body *body )
+{
+	if ( body->m_broadPhaseIndex != -1 )
+		m_broadphase.RemoveBody( body );
+}
+
 //--------------------------------------------------------------------------------------------------
 void q3ContactManager::TestCollisions( void )
 {
 	q3ContactConstraint* constraint = m_contactList;
+	m_eventCount = 0;
 
 	while( constraint )
 	{
-		q3Box *A = constraint->A;
-		q3Box *B = constraint->B;
+		q3Shape *A = constraint->A;
+		q3Shape *B = constraint->B;
 		q3Body *bodyA = A->body;
 		q3Body *bodyB = B->body;
 
-		constraint->m_flags &= ~q3ContactConstraint::eIsland;
-
+		// Set aside until either body wakes up
 		if( !bodyA->IsAwake( ) && !bodyB->IsAwake( ) )
 		{
-			constraint = constraint->next;
+			q3ContactConstraint* next = constraint->next;
+			RemoveFromList( constraint );
+			constraint->m_flags |= q3ContactConstraint::eSleeping;
+			InsertIntoList( constraint );
+			constraint = next;
 			continue;
 		}
 
 		if ( !bodyA->CanCollide( bodyB ) )
 		{
 			q3ContactConstraint* next = constraint->next;
+			if ( m_bufferEvents && (constraint->m_flags & q3ContactConstraint::eColliding) )
+				BufferEvent( eEndContact, constraint );
 			RemoveContact( constraint );
 			constraint = next;
 			continue;
 		}
 
 		// Check if contact should persist
-		if ( !m_broadphase.TestOverlap( A->broadPhaseIndex, B->broadPhaseIndex ) )
+		if ( !m_broadphase.TestOverlap( A, B, constraint->childB ) )
 		{
 			q3ContactConstraint* next = constraint->next;
+			if ( m_bufferEvents && (constraint->m_flags & q3ContactConstraint::eColliding) )
+				BufferEvent( eEndContact, constraint );
 			RemoveContact( constraint );
 			constraint = next;
 			continue;
 		}
 		q3Manifold* manifold = &constraint->manifold;
-		q3Manifold oldManifold = constraint->manifold;
-		q3Vec3 ot0 = oldManifold.tangentVectors[ 0 ];
-		q3Vec3 ot1 = oldManifold.tangentVectors[ 1 ];
-		constraint->SolveCollision( );
-		q3ComputeBasis( manifold->normal, manifold->tangentVectors, manifold->tangentVectors + 1 );
 
-		for ( i32 i = 0; i < manifold->contactCount; ++i )
+		// Sensors only track overlap and have no contacts to warm start
+		if ( manifold->sensor )
+			constraint->SolveCollision( );
+
+		// Touching shapes that barely move against one another keep the
+		// manifold of the previous step. Angular speed is measured at a
+		// unit lever arm.
+		else if ( m_coherenceSpeed > r32( 0.0 )
+			&& (constraint->m_flags & q3ContactConstraint::eColliding)
+			&& q3Length( bodyB->m_linearVelocity - bodyA->m_linearVelocity )
+			+ q3Length( bodyA->m_angularVelocity ) + q3Length( bodyB->m_angularVelocity ) < m_coherenceSpeed )
+		{
+			constraint->m_flags |= q3ContactConstraint::eWasColliding;
+		}
+
+		else
 		{
-			q3Contact *c = manifold->contacts + i;
-			c->tangentImpulse[ 0 ] = c->tangentImpulse[ 1 ] = c->normalImpulse = r32( 0.0 );
-			u8 oldWarmStart = c->warmStarted;
-			c->warmStarted = u8( 0 );
+			q3Manifold oldManifold = constraint->manifold;
+			q3Vec3 ot0 = oldManifold.tangentVectors[ 0 ];
+			q3Vec3 ot1 = oldManifold.tangentVectors[ 1 ];
+
+			// Shapes closer than they can move towards one another within a
+			// step receive speculative contacts
+			manifold->margin = q3Length( bodyB->m_linearVelocity - bodyA->m_linearVelocity ) * m_speculativeDt;
+
+			constraint->SolveCollision( );
+			q3ComputeBasis( manifold->normal, manifold->tangentVectors, manifold->tangentVectors + 1 );
+
+			// Central friction carries over while the shapes stay in contact
+			if ( oldManifold.contactCount && manifold->contactCount )
+			{
+				q3Vec3 friction = ot0 * oldManifold.tangentImpulse[ 0 ] + ot1 * oldManifold.tangentImpulse[ 1 ];
+				manifold->tangentImpulse[ 0 ] = q3Dot( friction, manifold->tangentVectors[ 0 ] );
+				manifold->tangentImpulse[ 1 ] = q3Dot( friction, manifold->tangentVectors[ 1 ] );
+			}
+
+			else
+			{
+				manifold->tangentImpulse[ 0 ] = r32( 0.0 );
+				manifold->tangentImpulse[ 1 ] = r32( 0.0 );
+				manifold->twistImpulse = r32( 0.0 );
+			}
 
-			for ( i32 j = 0; j < oldManifold.contactCount; ++j )
+			for ( i32 i = 0; i < manifold->contactCount; ++i )
 			{
-				q3Contact *oc = oldManifold.contacts + j;
-				if ( c->fp.key == oc->fp.key )
+				q3Contact *c = manifold->contacts + i;
+				c->tangentImpulse[ 0 ] = c->tangentImpulse[ 1 ] = c->normalImpulse = r32( 0.0 );
+				u8 oldWarmStart = c->warmStarted;
+				c->warmStarted = u8( 0 );
+
+				for ( i32 j = 0; j < oldManifold.contactCount; ++j )
 				{
-					c->normalImpulse = oc->normalImpulse;
-
-					// Attempt to re-project old friction solutions
-					q3Vec3 friction = ot0 * oc->tangentImpulse[ 0 ] + ot1 * oc->tangentImpulse[ 1 ];
-					c->tangentImpulse[ 0 ] = q3Dot( friction, manifold->tangentVectors[ 0 ] );
-					c->tangentImpulse[ 1 ] = q3Dot( friction, manifold->tangentVectors[ 1 ] );
-					c->warmStarted = q3Max( oldWarmStart, u8( oldWarmStart + 1 ) );
-					break;
+					q3Contact *oc = oldManifold.contacts + j;
+					if ( c->fp.key == oc->fp.key )
+					{
+						c->normalImpulse = oc->normalImpulse;
+
+						// Attempt to re-project old friction solutions
+						q3Vec3 friction = ot0 * oc->tangentImpulse[ 0 ] + ot1 * oc->tangentImpulse[ 1 ];
+						c->tangentImpulse[ 0 ] = q3Dot( friction, manifold->tangentVectors[ 0 ] );
+						c->tangentImpulse[ 1 ] = q3Dot( friction, manifold->tangentVectors[ 1 ] );
+						c->warmStarted = q3Max( oldWarmStart, u8( oldWarmStart + 1 ) );
+						break;
+					}
 				}
 			}
 		}
 
-		if ( m_contactListener )
+		// Contacts join the island set of their bodies while they have points
+		// to solve, speculative ones included
+		if ( !manifold->sensor )
 		{
-			i32 now_colliding = constraint->m_flags & q3ContactConstraint::eColliding;
-			i32 was_colliding = constraint->m_flags & q3ContactConstraint::eWasColliding;
+			bool linked = (constraint->m_flags & q3ContactConstraint::eIsland) != 0;
+
+			if ( manifold->contactCount && !linked )
+				LinkContact( constraint );
+
+			else if ( !manifold->contactCount && linked )
+				UnlinkContact( constraint );
+		}
 
+		i32 now_colliding = constraint->m_flags & q3ContactConstraint::eColliding;
+		i32 was_colliding = constraint->m_flags & q3ContactConstraint::eWasColliding;
+
+		if ( m_bufferEvents )
+		{
+			if ( now_colliding && !was_colliding )
+				BufferEvent( eBeginContact, constraint );
+
+			else if ( now_colliding )
+				BufferEvent( ePersistContact, constraint );
+
+			else if ( was_colliding )
+				BufferEvent( eEndContact, constraint );
+		}
+
+		else if ( m_contactListener )
+		{
 			if ( now_colliding && !was_colliding )
 				m_contactListener->BeginContact( constraint );
 
@@ -277,44 +377,377 @@ void q3ContactManager::TestCollisions( void )
 }
 
 //--------------------------------------------------------------------------------------------------
-void q3ContactManager::RenderContacts( q3Render* render ) const
+void q3ContactManager::AddToIsland( q3Body *body )
+{
+	assert( !(body->m_flags & q3Body::eStatic) );
+
+	q3IslandSet* set = CreateIsland( );
+	set->awake = body->IsAwake( );
+	InsertBody( set, body );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3ContactManager::RemoveFromIsland( q3Body *body )
 {
-	const q3ContactConstraint *contact = m_contactList;
+	q3IslandSet* set = body->m_islandSet;
+
+	if ( !set )
+		return;
+
+	if ( body->m_islandPrev )
+		body->m_islandPrev->m_islandNext = body->m_islandNext;
+
+	if ( body->m_islandNext )
+		body->m_islandNext->m_islandPrev = body->m_islandPrev;
 
-	while ( contact )
+	if ( body == set->bodyList )
+		set->bodyList = body->m_islandNext;
+
+	body->m_islandSet = NULL;
+
+	if ( --set->bodyCount == 0 )
 	{
-		const q3Manifold *m = &contact->manifold;
+		assert( !set->contactCount );
+		DestroyIsland( set );
+	}
+}
 
-		if ( !(contact->m_flags & q3ContactConstraint::eColliding) )
-		{
-			contact = contact->next;
+//--------------------------------------------------------------------------------------------------
+void q3ContactManager::LinkContact( q3ContactConstraint *contact )
+{
+	q3IslandSet* a = contact->bodyA->m_islandSet;
+	q3IslandSet* b = contact->bodyB->m_islandSet;
+	q3IslandSet* set = a ? a : b;
+
+	if ( a && b && a != b )
+		set = MergeIslands( a, b );
+
+	assert( set );
+
+	InsertContact( set, contact );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3ContactManager::UnlinkContact( q3ContactConstraint *contact )
+{
+	q3Body *A = contact->bodyA;
+	q3Body *B = contact->bodyB;
+	q3IslandSet* set = A->m_islandSet ? A->m_islandSet : B->m_islandSet;
+
+	if ( contact->islandPrev )
+		contact->islandPrev->islandNext = contact->islandNext;
+
+	if ( contact->islandNext )
+		contact->islandNext->islandPrev = contact->islandPrev;
+
+	if ( contact == set->contactList )
+		set->contactList = contact->islandNext;
+
+	if ( contact == set->contactTail )
+		set->contactTail = contact->islandPrev;
+
+	--set->contactCount;
+	contact->m_flags &= ~q3ContactConstraint::eIsland;
+
+	// Only contacts between two bodies of the set hold it together
+	if ( A->m_islandSet && B->m_islandSet )
+		set->split = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3ContactManager::SplitIsland( q3IslandSet *set )
+{
+	i32 bodyCount = set->bodyCount;
+	q3ContactConstraint* contacts = set->contactList;
+	bool awake = set->awake;
+
+	m_stack->Reserve( sizeof( q3Body* ) * bodyCount * 2 );
+	q3Body** bodies = (q3Body**)m_stack->Allocate( sizeof( q3Body* ) * bodyCount );
+	q3Body** stack = (q3Body**)m_stack->Allocate( sizeof( q3Body* ) * bodyCount );
+
+	i32 count = 0;
+	for ( q3Body* body = set->bodyList; body; body = body->m_islandNext )
+		bodies[ count++ ] = body;
+
+	DestroyIsland( set );
+
+	// Each body not yet reached seeds a new set, which gathers every body
+	// reachable across linked contacts. Bodies are marked with eIsland
+	// while the search runs.
+	for ( i32 i = 0; i < bodyCount; ++i )
+	{
+		q3Body* seed = bodies[ i ];
+
+		if ( seed->m_flags & q3Body::eIsland )
 			continue;
+
+		q3IslandSet* piece = CreateIsland( );
+		piece->awake = awake;
+
+		i32 stackCount = 0;
+		stack[ stackCount++ ] = seed;
+		seed->m_flags |= q3Body::eIsland;
+
+		while ( stackCount > 0 )
+		{
+			q3Body* body = stack[ --stackCount ];
+			InsertBody( piece, body );
+
+			for ( q3ContactEdge* edge = body->m_contactList; edge; edge = edge->next )
+			{
+				q3Body* other = edge->other;
+
+				if ( !(edge->constraint->m_flags & q3ContactConstraint::eIsland) )
+					continue;
+
+				if ( other->m_flags & (q3Body::eStatic | q3Body::eIsland) )
+					continue;
+
+				assert( stackCount < bodyCount );
+
+				stack[ stackCount++ ] = other;
+				other->m_flags |= q3Body::eIsland;
+			}
 		}
+	}
+
+	for ( i32 i = 0; i < bodyCount; ++i )
+		bodies[ i ]->m_flags &= ~q3Body::eIsland;
+
+	// Contacts follow their bodies into the new sets
+	while ( contacts )
+	{
+		q3ContactConstraint* next = contacts->islandNext;
+		q3Body *A = contacts->bodyA;
+		InsertContact( A->m_islandSet ? A->m_islandSet : contacts->bodyB->m_islandSet, contacts );
+		contacts = next;
+	}
 
-		for ( i32 j = 0; j < m->contactCount; ++j)
+	m_stack->Free( stack );
+	m_stack->Free( bodies );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3ContactManager::InsertIntoList( q3ContactConstraint *contact )
+{
+	q3ContactConstraint** list = (contact->m_flags & q3ContactConstraint::eSleeping) ? &m_sleepingContactList : &m_contactList;
+
+	contact->prev = NULL;
+	contact->next = *list;
+	if ( *list )
+		(*list)->prev = contact;
+	*list = contact;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3ContactManager::RemoveFromList( q3ContactConstraint *contact )
+{
+	q3ContactConstraint** list = (contact->m_flags & q3ContactConstraint::eSleeping) ? &m_sleepingContactList : &m_contactList;
+
+	if ( contact->prev )
+		contact->prev->next = contact->next;
+
+	if ( contact->next )
+		contact->next->prev = contact->prev;
+
+	if ( contact == *list )
+		*list = contact->next;
+}
+
+//--------------------------------------------------------------------------------------------------
+q3IslandSet* q3ContactManager::CreateIsland( void )
+{
+	q3IslandSet* set = (q3IslandSet*)m_islandAllocator.Allocate( );
+	set->bodyList = NULL;
+	set->contactList = NULL;
+	set->contactTail = NULL;
+	set->bodyCount = 0;
+	set->contactCount = 0;
+	set->awake = false;
+	set->split = false;
+
+	set->prev = NULL;
+	set->next = m_islandList;
+	if ( m_islandList )
+		m_islandList->prev = set;
+	m_islandList = set;
+
+	return set;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3ContactManager::DestroyIsland( q3IslandSet *set )
+{
+	if ( set->prev )
+		set->prev->next = set->next;
+
+	if ( set->next )
+		set->next->prev = set->prev;
+
+	if ( set == m_islandList )
+		m_islandList = set->next;
+
+	m_islandAllocator.Free( set );
+}
+
+//--------------------------------------------------------------------------------------------------
+q3IslandSet* q3ContactManager::MergeIslands( q3IslandSet *a, q3IslandSet *b )
+{
+	// Move the smaller set into the larger one
+	if ( a->bodyCount < b->bodyCount )
+	{
+		q3IslandSet* t = a;
+		a = b;
+		b = t;
+	}
+
+	q3Body* lastBody = b->bodyList;
+	for ( q3Body* body = b->bodyList; body; body = body->m_islandNext )
+	{
+		body->m_islandSet = a;
+		lastBody = body;
+	}
+
+	lastBody->m_islandNext = a->bodyList;
+	if ( a->bodyList )
+		a->bodyList->m_islandPrev = lastBody;
+	a->bodyList = b->bodyList;
+
+	if ( b->contactList )
+	{
+		if ( a->contactTail )
 		{
-			const q3Contact *c = m->contacts + j;
-			f32 blue = (f32)(255 - c->warmStarted) / 255.0f;
-			f32 red = 1.0f - blue;
-			render->SetScale( 10.0f, 10.0f, 10.0f );
-			render->SetPenColor( red, blue, blue );
-			render->SetPenPosition( c->position.x, c->position.y, c->position.z );
-			render->Point( );
-
-			if ( m->A->body->IsAwake( ) )
-				render->SetPenColor( 1.0f, 1.0f, 1.0f );
-			else
-				render->SetPenColor( 0.2f, 0.2f, 0.2f );
-
-			render->SetPenPosition( c->position.x, c->position.y, c->position.z );
-			render->Line(
-				c->position.x + m->normal.x * 0.5f,
-				c->position.y + m->normal.y * 0.5f,
-				c->position.z + m->normal.z * 0.5f
-				);
+			a->contactTail->islandNext = b->contactList;
+			b->contactList->islandPrev = a->contactTail;
 		}
 
-		contact = contact->next;
+		else
+			a->contactList = b->contactList;
+
+		a->contactTail = b->contactTail;
+	}
+
+	a->bodyCount += b->bodyCount;
+	a->contactCount += b->contactCount;
+	a->awake = a->awake || b->awake;
+	a->split = a->split || b->split;
+
+	DestroyIsland( b );
+
+	return a;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3ContactManager::InsertBody( q3IslandSet *set, q3Body *body )
+{
+	body->m_islandSet = set;
+	body->m_islandPrev = NULL;
+	body->m_islandNext = set->bodyList;
+	if ( set->bodyList )
+		set->bodyList->m_islandPrev = body;
+	set->bodyList = body;
+
+	++set->bodyCount;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3ContactManager::InsertContact( q3IslandSet *set, q3ContactConstraint *contact )
+{
+	// Contacts are appended, so the solver meets the oldest ones first
+	contact->islandNext = NULL;
+	contact->islandPrev = set->contactTail;
+	if ( set->contactTail )
+		set->contactTail->islandNext = contact;
+	else
+		set->contactList = contact;
+	set->contactTail = contact;
+
+	contact->m_flags |= q3ContactConstraint::eIsland;
+	++set->contactCount;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3ContactManager::BufferEvent( i32 type, q3ContactConstraint *contact )
+{
+	if ( m_eventCount == m_eventCapacity )
+	{
+		q3ContactEvent* oldEvents = m_events;
+		m_eventCapacity *= 2;
+		m_events = (q3ContactEvent*)q3Alloc( m_eventCapacity * sizeof( q3ContactEvent ) );
+		memcpy( m_events, oldEvents, m_eventCount * sizeof( q3ContactEvent ) );
+		q3Free( oldEvents );
+	}
+
+	q3ContactEvent* event = m_events + m_eventCount++;
+	event->type = (q3ContactEventType)type;
+	event->A = contact->A;
+	event->B = contact->B;
+	event->bodyA = contact->bodyA;
+	event->bodyB = contact->bodyB;
+	event->normal = contact->manifold.normal;
+	event->maxImpulse = r32( 0.0 );
+
+	// The contact of an end event may be about to be destroyed
+	event->contact = type == eEndContact ? NULL : contact;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3ContactManager::GatherEventImpulses( void )
+{
+	for ( i32 i = 0; i < m_eventCount; ++i )
+	{
+		q3ContactEvent* event = m_events + i;
+
+		if ( !event->contact )
+			continue;
+
+		const q3Manifold* m = &event->contact->manifold;
+		r32 maxImpulse = r32( 0.0 );
+
+		for ( i32 j = 0; j < m->contactCount; ++j )
+			maxImpulse = q3Max( maxImpulse, m->contacts[ j ].normalImpulse );
+
+		event->maxImpulse = maxImpulse;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3ContactManager::RenderContacts( q3Render* render ) const
+{
+	const q3ContactConstraint *lists[ 2 ] = { m_contactList, m_sleepingContactList };
+
+	for ( i32 i = 0; i < 2; ++i )
+	{
+		for ( const q3ContactConstraint *contact = lists[ i ]; contact; contact = contact->next )
+		{
+			const q3Manifold *m = &contact->manifold;
+
+			if ( !(contact->m_flags & q3ContactConstraint::eColliding) )
+				continue;
+
+			for ( i32 j = 0; j < m->contactCount; ++j)
+			{
+				const q3Contact *c = m->contacts + j;
+				f32 blue = (f32)(255 - c->warmStarted) / 255.0f;
+				f32 red = 1.0f - blue;
+				render->SetScale( 10.0f, 10.0f, 10.0f );
+				render->SetPenColor( red, blue, blue );
+				render->SetPenPosition( c->position.x, c->position.y, c->position.z );
+				render->Point( );
+
+				if ( m->A->body->IsAwake( ) )
+					render->SetPenColor( 1.0f, 1.0f, 1.0f );
+				else
+					render->SetPenColor( 0.2f, 0.2f, 0.2f );
+
+				render->SetPenPosition( c->position.x, c->position.y, c->position.z );
+				render->Line(
+					c->position.x + m->normal.x * 0.5f,
+					c->position.y + m->normal.y * 0.5f,
+					c->position.z + m->normal.z * 0.5f
+					);
+			}
+		}
 	}
 
 	render->SetScale( 1.0f, 1.0f, 1.0f );
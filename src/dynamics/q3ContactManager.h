@@ -35,8 +35,10 @@
 // q3ContactManager
 //--------------------------------------------------------------------------------------------------
 struct q3ContactConstraint;
+struct q3ContactEvent;
+struct q3IslandSet;
 class q3ContactListener;
-struct q3Box;
+struct q3Shape;
 class q3Body;
 class q3Render;
 class q3Stack;
@@ -45,10 +47,12 @@ class q3ContactManager
 {
 public:
 	q3ContactManager( q3Stack* stack );
+	~q3ContactManager( );
 
 	// Add a new contact constraint for a pair of objects
-	// unless the contact constraint already exists
-	void AddContact( q3Box *A, q3Box *B );
+	// unless the contact constraint already exists. childB
+	// is the triangle of B when B is a mesh or heightfield.
+	void AddContact( q3Shape *A, q3Shape *B, i32 childB );
 
 	// Has broadphase find all contacts and call AddContact on the
 	// ContactManager for each pair found
@@ -59,6 +63,10 @@ public:
 
 	// Remove all contacts from a body
 	void RemoveContactsFromBody( q3Body *body );
+
+	// Moves the contacts of a body that just woke up out of the sleeping
+	// contact list
+	void WakeContacts( q3Body *body );
 	void RemoveFromBroadphase( q3Body *body );
 
 	// Remove contacts without broadphase overlap
@@ -66,19 +74,63 @@ public:
 	void TestCollisions( void );
 	static void SolveCollision( void* param );
 
+	// Fills in the impulses of buffered events once the step is solved
+	void GatherEventImpulses( void );
+
+	// Keep the island sets of bodies up to date, see q3IslandSet. Bodies
+	// other than static ones are added once created and removed once their
+	// contacts are gone. Contacts are linked while they have points to solve.
+	void AddToIsland( q3Body *body );
+	void RemoveFromIsland( q3Body *body );
+	void LinkContact( q3ContactConstraint *contact );
+	void UnlinkContact( q3ContactConstraint *contact );
+
+	// Searches the bodies of a set for the pieces it came apart into
+	void SplitIsland( q3IslandSet *set );
+
 	void RenderContacts( q3Render* debugDrawer ) const;
 
 private:
+	// Contacts between two sleeping bodies are moved into their own list
+	// so TestCollisions does not visit them
 	q3ContactConstraint* m_contactList;
+	q3ContactConstraint* m_sleepingContactList;
 	i32 m_contactCount;
 	q3Stack* m_stack;
 	q3PagedAllocator m_allocator;
+	q3PagedAllocator m_islandAllocator;
+	q3IslandSet* m_islandList;
 	q3BroadPhase m_broadphase;
 	q3ContactListener *m_contactListener;
 
+	// Step used to predict speculative contacts, zero when disabled
+	r32 m_speculativeDt;
+
+	// Touching pairs moving slower than this relative to one another keep
+	// their manifolds from the previous step, zero when disabled
+	r32 m_coherenceSpeed;
+
+	// Contact events of the last step, used instead of the listener
+	// when m_bufferEvents is set
+	bool m_bufferEvents;
+	q3ContactEvent* m_events;
+	i32 m_eventCount;
+	i32 m_eventCapacity;
+
+	void BufferEvent( i32 type, q3ContactConstraint *contact );
+
+	void InsertIntoList( q3ContactConstraint *contact );
+	void RemoveFromList( q3ContactConstraint *contact );
+
+	q3IslandSet* CreateIsland( void );
+	void DestroyIsland( q3IslandSet *set );
+	q3IslandSet* MergeIslands( q3IslandSet *a, q3IslandSet *b );
+	void InsertBody( q3IslandSet *set, q3Body *body );
+	void InsertContact( q3IslandSet *set, q3ContactConstraint *contact );
+
 	friend class q3BroadPhase;
 	friend class q3Scene;
-	friend struct q3Box;
+	friend struct q3Shape;
 	friend class q3Body;
 };
 
@@ -41,7 +41,13 @@ void q3ContactSolver::Initialize( q3Island *island )
 	m_contactCount = island->m_contactCount;
 	m_contacts = island->m_contactStates;
 	m_velocities = m_island->m_velocities;
+	m_pseudoVelocities = m_island->m_pseudoVelocities;
+	m_masses = m_island->m_masses;
 	m_enableFriction = island->m_enableFriction;
+	m_enableBlockSolver = island->m_enableBlockSolver;
+	m_enableSplitImpulse = island->m_enableSplitImpulse;
+	m_enableCentralFriction = island->m_enableCentralFriction;
+	m_up = -q3Normalize( island->m_gravity );
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -52,6 +58,10 @@ void q3ContactSolver::ShutDown( void )
 		q3ContactConstraintState *c = m_contacts + i;
 		q3ContactConstraint *cc = m_island->m_contacts[ i ];
 
+		cc->manifold.tangentImpulse[ 0 ] = c->tangentImpulse[ 0 ];
+		cc->manifold.tangentImpulse[ 1 ] = c->tangentImpulse[ 1 ];
+		cc->manifold.twistImpulse = c->twistImpulse;
+
 		for ( i32 j = 0; j < c->contactCount; ++j )
 		{
 			q3Contact *oc = cc->manifold.contacts + j;
@@ -63,64 +73,263 @@ void q3ContactSolver::ShutDown( void )
 	}
 }
 
+//--------------------------------------------------------------------------------------------------
+// Precalculate JM^-1JT for contact and friction constraints
+inline void q3ComputeContactMass( const q3ContactConstraintState *cs, const q3MassState *A, const q3MassState *B, q3ContactState *c )
+{
+	q3Vec3 raCn = q3Cross( c->ra, cs->normal );
+	q3Vec3 rbCn = q3Cross( c->rb, cs->normal );
+	r32 nm = A->m + B->m;
+	r32 tm[ 2 ];
+	tm[ 0 ] = nm;
+	tm[ 1 ] = nm;
+
+	nm += q3Dot( raCn, A->i * raCn ) + q3Dot( rbCn, B->i * rbCn );
+	c->normalMass = q3Invert( nm );
+
+	for ( i32 i = 0; i < 2; ++i )
+	{
+		q3Vec3 raCt = q3Cross( cs->tangentVectors[ i ], c->ra );
+		q3Vec3 rbCt = q3Cross( cs->tangentVectors[ i ], c->rb );
+		tm[ i ] += q3Dot( raCt, A->i * raCt ) + q3Dot( rbCt, B->i * rbCt );
+		c->tangentMass[ i ] = q3Invert( tm[ i ] );
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+// Places the friction rows of a manifold at the center of its contacts.
+// Rows that are not used have their impulses cleared so they do not warm
+// start later steps.
+inline void q3PrepareCentralFriction( q3ContactConstraintState *cs, const q3MassState *A, const q3MassState *B, bool enabled )
+{
+	cs->centralFriction = enabled && cs->contactCount > 1;
+
+	if ( !cs->centralFriction )
+	{
+		cs->tangentImpulse[ 0 ] = r32( 0.0 );
+		cs->tangentImpulse[ 1 ] = r32( 0.0 );
+		cs->twistImpulse = r32( 0.0 );
+		return;
+	}
+
+	q3Vec3 ra( r32( 0.0 ), r32( 0.0 ), r32( 0.0 ) );
+	q3Vec3 rb( r32( 0.0 ), r32( 0.0 ), r32( 0.0 ) );
+
+	for ( i32 j = 0; j < cs->contactCount; ++j )
+	{
+		q3ContactState *c = cs->contacts + j;
+		ra += c->ra;
+		rb += c->rb;
+
+		// Replaced by the rows at the center
+		c->tangentImpulse[ 0 ] = r32( 0.0 );
+		c->tangentImpulse[ 1 ] = r32( 0.0 );
+	}
+
+	r32 inv = r32( 1.0 ) / r32( cs->contactCount );
+	cs->centerRa = ra * inv;
+	cs->centerRb = rb * inv;
+
+	r32 radius = r32( 0.0 );
+	for ( i32 j = 0; j < cs->contactCount; ++j )
+		radius += q3Length( cs->contacts[ j ].ra - cs->centerRa );
+
+	cs->frictionRadius = radius * inv;
+
+	for ( i32 i = 0; i < 2; ++i )
+	{
+		q3Vec3 raCt = q3Cross( cs->tangentVectors[ i ], cs->centerRa );
+		q3Vec3 rbCt = q3Cross( cs->tangentVectors[ i ], cs->centerRb );
+		r32 tm = A->m + B->m + q3Dot( raCt, A->i * raCt ) + q3Dot( rbCt, B->i * rbCt );
+		cs->tangentMass[ i ] = q3Invert( tm );
+	}
+
+	r32 twm = q3Dot( cs->normal, A->i * cs->normal ) + q3Dot( cs->normal, B->i * cs->normal );
+	cs->twistMass = q3Invert( twm );
+}
+
+//--------------------------------------------------------------------------------------------------
+inline void q3WarmStartCentralFriction( const q3ContactConstraintState *cs, const q3MassState *A, const q3MassState *B, q3Vec3* vA, q3Vec3* wA, q3Vec3* vB, q3Vec3* wB )
+{
+	q3Vec3 P = cs->tangentVectors[ 0 ] * cs->tangentImpulse[ 0 ] + cs->tangentVectors[ 1 ] * cs->tangentImpulse[ 1 ];
+	q3Vec3 L = cs->normal * cs->twistImpulse;
+
+	*vA -= P * A->m;
+	*wA -= A->i * (q3Cross( cs->centerRa, P ) + L);
+
+	*vB += P * B->m;
+	*wB += B->i * (q3Cross( cs->centerRb, P ) + L);
+}
+
+//--------------------------------------------------------------------------------------------------
+// Sliding is resisted at the center of the contacts and twisting about the
+// normal with a lever arm of the mean distance of the contacts from the
+// center. Returns the largest change applied to the accumulated impulses.
+inline r32 q3SolveCentralFriction( q3ContactConstraintState *cs, const q3MassState *A, const q3MassState *B, q3Vec3* vA, q3Vec3* wA, q3Vec3* vB, q3Vec3* wB )
+{
+	r32 normalImpulse = r32( 0.0 );
+	for ( i32 j = 0; j < cs->contactCount; ++j )
+		normalImpulse += cs->contacts[ j ].normalImpulse;
+
+	r32 maxLambda = cs->friction * normalImpulse;
+	r32 delta = r32( 0.0 );
+
+	// relative velocity at the center
+	q3Vec3 dv = *vB + q3Cross( *wB, cs->centerRb ) - *vA - q3Cross( *wA, cs->centerRa );
+
+	for ( i32 i = 0; i < 2; ++i )
+	{
+		r32 lambda = -q3Dot( dv, cs->tangentVectors[ i ] ) * cs->tangentMass[ i ];
+
+		// Clamp frictional impulse
+		r32 oldPT = cs->tangentImpulse[ i ];
+		cs->tangentImpulse[ i ] = q3Clamp( -maxLambda, maxLambda, oldPT + lambda );
+		lambda = cs->tangentImpulse[ i ] - oldPT;
+		delta = q3Max( delta, q3Abs( lambda ) );
+
+		// Apply friction impulse
+		q3Vec3 impulse = cs->tangentVectors[ i ] * lambda;
+		*vA -= impulse * A->m;
+		*wA -= A->i * q3Cross( cs->centerRa, impulse );
+
+		*vB += impulse * B->m;
+		*wB += B->i * q3Cross( cs->centerRb, impulse );
+	}
+
+	r32 maxTwist = maxLambda * cs->frictionRadius;
+	r32 lambda = -q3Dot( *wB - *wA, cs->normal ) * cs->twistMass;
+
+	r32 oldTwist = cs->twistImpulse;
+	cs->twistImpulse = q3Clamp( -maxTwist, maxTwist, oldTwist + lambda );
+	lambda = cs->twistImpulse - oldTwist;
+	delta = q3Max( delta, q3Abs( lambda ) );
+
+	q3Vec3 L = cs->normal * lambda;
+	*wA -= A->i * L;
+	*wB += B->i * L;
+
+	return delta;
+}
+
 //--------------------------------------------------------------------------------------------------
 void q3ContactSolver::PreSolve( r32 dt )
+{
+	// Pick the kernel for the island's features once, instead of testing
+	// them for every contact
+	if ( m_enableFriction )
+	{
+		if ( m_enableSplitImpulse )
+			PreSolveKernel<true, true>( dt );
+		else
+			PreSolveKernel<true, false>( dt );
+	}
+
+	else
+	{
+		if ( m_enableSplitImpulse )
+			PreSolveKernel<false, true>( dt );
+		else
+			PreSolveKernel<false, false>( dt );
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+template <bool friction, bool splitImpulse>
+void q3ContactSolver::PreSolveKernel( r32 dt )
 {
 	for ( i32 i = 0; i < m_contactCount; ++i )
 	{
 		q3ContactConstraintState *cs = m_contacts + i;
+		const q3MassState *A = m_masses + cs->indexA;
+		const q3MassState *B = m_masses + cs->indexB;
 
 		q3Vec3 vA = m_velocities[ cs->indexA ].v;
 		q3Vec3 wA = m_velocities[ cs->indexA ].w;
 		q3Vec3 vB = m_velocities[ cs->indexB ].v;
 		q3Vec3 wB = m_velocities[ cs->indexB ].w;
+		bool restitution = cs->restitution > r32( 0.0 );
+
+		q3PrepareCentralFriction( cs, A, B, friction && m_enableCentralFriction );
+
+		if ( cs->centralFriction )
+			q3WarmStartCentralFriction( cs, A, B, &vA, &wA, &vB, &wB );
 
 		for ( i32 j = 0; j < cs->contactCount; ++j )
 		{
 			q3ContactState *c = cs->contacts + j;
+			q3ComputeContactMass( cs, A, B, c );
 
-			// Precalculate JM^-1JT for contact and friction constraints
-			q3Vec3 raCn = q3Cross( c->ra, cs->normal );
-			q3Vec3 rbCn = q3Cross( c->rb, cs->normal );
-			r32 nm = cs->mA + cs->mB;
-			r32 tm[ 2 ];
-			tm[ 0 ] = nm;
-			tm[ 1 ] = nm;
+			// Precalculate bias factor. Speculative contacts allow the shapes to
+			// approach until they touch at the end of the step.
+			// With split impulses the Baumgarte bias drives the pseudo
+			// velocities instead.
+			c->positionBias = r32( 0.0 );
+			c->pseudoImpulse = r32( 0.0 );
 
-			nm += q3Dot( raCn, cs->iA * raCn ) + q3Dot( rbCn, cs->iB * rbCn );
-			c->normalMass = q3Invert( nm );
+			if ( c->penetration > r32( 0.0 ) )
+				c->bias = -c->penetration / dt;
 
-			for ( i32 i = 0; i < 2; ++i )
+			else if ( splitImpulse )
 			{
-				q3Vec3 raCt = q3Cross( cs->tangentVectors[ i ], c->ra );
-				q3Vec3 rbCt = q3Cross( cs->tangentVectors[ i ], c->rb );
-				tm[ i ] += q3Dot( raCt, cs->iA * raCt ) + q3Dot( rbCt, cs->iB * rbCt );
-				c->tangentMass[ i ] = q3Invert( tm[ i ] );
+				c->bias = r32( 0.0 );
+				c->positionBias = -Q3_BAUMGARTE * (r32( 1.0 ) / dt) * q3Min( r32( 0.0 ), c->penetration + Q3_PENETRATION_SLOP );
 			}
 
-			// Precalculate bias factor
-			c->bias = -Q3_BAUMGARTE * (r32( 1.0 ) / dt) * q3Min( r32( 0.0 ), c->penetration + Q3_PENETRATION_SLOP );
+			else
+				c->bias = -Q3_BAUMGARTE * (r32( 1.0 ) / dt) * q3Min( r32( 0.0 ), c->penetration + Q3_PENETRATION_SLOP );
 
 			// Warm start contact
 			q3Vec3 P = cs->normal * c->normalImpulse;
 
-			if ( m_enableFriction )
+			if ( friction )
 			{
 				P += cs->tangentVectors[ 0 ] * c->tangentImpulse[ 0 ];
 				P += cs->tangentVectors[ 1 ] * c->tangentImpulse[ 1 ];
 			}
 
-			vA -= P * cs->mA;
-			wA -= cs->iA * q3Cross( c->ra, P );
+			vA -= P * A->m;
+			wA -= A->i * q3Cross( c->ra, P );
 
-			vB += P * cs->mB;
-			wB += cs->iB * q3Cross( c->rb, P );
+			vB += P * B->m;
+			wB += B->i * q3Cross( c->rb, P );
 
 			// Add in restitution bias
-			r32 dv = q3Dot( vB + q3Cross( wB, c->rb ) - vA - q3Cross( wA, c->ra ), cs->normal );
+			if ( restitution )
+			{
+				r32 dv = q3Dot( vB + q3Cross( wB, c->rb ) - vA - q3Cross( wA, c->ra ), cs->normal );
 
-			if ( dv < -r32( 1.0 ) )
-				c->bias += -(cs->restitution) * dv;
+				if ( dv < -r32( 1.0 ) && c->penetration <= r32( 0.0 ) )
+					c->bias += -(cs->restitution) * dv;
+			}
+		}
+
+		cs->blockSolve = m_enableBlockSolver && cs->contactCount > 1 && cs->contactCount <= Q3_MAX_BLOCK_CONTACTS;
+
+		if ( cs->blockSolve )
+		{
+			for ( i32 j = 0; j < cs->contactCount; ++j )
+			{
+				q3ContactState *cj = cs->contacts + j;
+				q3Vec3 raCnj = q3Cross( cj->ra, cs->normal );
+				q3Vec3 rbCnj = q3Cross( cj->rb, cs->normal );
+
+				for ( i32 k = j; k < cs->contactCount; ++k )
+				{
+					q3ContactState *ck = cs->contacts + k;
+					q3Vec3 raCnk = q3Cross( ck->ra, cs->normal );
+					q3Vec3 rbCnk = q3Cross( ck->rb, cs->normal );
+
+					r32 kjk = A->m + B->m + q3Dot( raCnj, A->i * raCnk ) + q3Dot( rbCnj, B->i * rbCnk );
+					cs->K[ j ][ k ] = kjk;
+					cs->K[ k ][ j ] = kjk;
+				}
+			}
+
+			// Four points upon a face only constrain three degrees of freedom,
+			// so K is singular. A slight softening of the diagonal keeps it
+			// invertible and spreads the load evenly among the points.
+			for ( i32 j = 0; j < cs->contactCount; ++j )
+				cs->K[ j ][ j ] *= r32( 1.0 ) + Q3_BLOCK_SOFTNESS;
 		}
 
 		m_velocities[ cs->indexA ].v = vA;
@@ -131,72 +340,636 @@ void q3ContactSolver::PreSolve( r32 dt )
 }
 
 //--------------------------------------------------------------------------------------------------
-void q3ContactSolver::Solve( )
+// Returns the largest change applied to the accumulated impulses
+inline r32 q3SolveFriction( const q3ContactConstraintState *cs, const q3MassState *A, const q3MassState *B, q3ContactState *c, q3Vec3* vA, q3Vec3* wA, q3Vec3* vB, q3Vec3* wB )
+{
+	// relative velocity at contact
+	q3Vec3 dv = *vB + q3Cross( *wB, c->rb ) - *vA - q3Cross( *wA, c->ra );
+	r32 delta = r32( 0.0 );
+
+	for ( i32 i = 0; i < 2; ++i )
+	{
+		r32 lambda = -q3Dot( dv, cs->tangentVectors[ i ] ) * c->tangentMass[ i ];
+
+		// Calculate frictional impulse
+		r32 maxLambda = cs->friction * c->normalImpulse;
+
+		// Clamp frictional impulse
+		r32 oldPT = c->tangentImpulse[ i ];
+		c->tangentImpulse[ i ] = q3Clamp( -maxLambda, maxLambda, oldPT + lambda );
+		lambda = c->tangentImpulse[ i ] - oldPT;
+		delta = q3Max( delta, q3Abs( lambda ) );
+
+		// Apply friction impulse
+		q3Vec3 impulse = cs->tangentVectors[ i ] * lambda;
+		*vA -= impulse * A->m;
+		*wA -= A->i * q3Cross( c->ra, impulse );
+
+		*vB += impulse * B->m;
+		*wB += B->i * q3Cross( c->rb, impulse );
+	}
+
+	return delta;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Returns the change applied to the accumulated impulse
+inline r32 q3SolveNormal( const q3ContactConstraintState *cs, const q3MassState *A, const q3MassState *B, q3ContactState *c, q3Vec3* vA, q3Vec3* wA, q3Vec3* vB, q3Vec3* wB )
+{
+	q3Vec3 dv = *vB + q3Cross( *wB, c->rb ) - *vA - q3Cross( *wA, c->ra );
+
+	// Normal impulse
+	r32 vn = q3Dot( dv, cs->normal );
+
+	// Factor in positional bias to calculate impulse scalar j
+	r32 lambda = c->normalMass * (-vn + c->bias);
+
+	// Clamp impulse
+	r32 tempPN = c->normalImpulse;
+	c->normalImpulse = q3Max( tempPN + lambda, r32( 0.0 ) );
+	lambda = c->normalImpulse - tempPN;
+
+	// Apply impulse
+	q3Vec3 impulse = cs->normal * lambda;
+	*vA -= impulse * A->m;
+	*wA -= A->i * q3Cross( c->ra, impulse );
+
+	*vB += impulse * B->m;
+	*wB += B->i * q3Cross( c->rb, impulse );
+
+	return q3Abs( lambda );
+}
+
+//--------------------------------------------------------------------------------------------------
+// Pushes penetrating shapes apart with pseudo velocities. Not warm started,
+// since the pseudo velocities start from rest each step. Returns the change
+// applied to the accumulated impulse.
+inline r32 q3SolvePseudo( const q3ContactConstraintState *cs, const q3MassState *A, const q3MassState *B, q3ContactState *c, q3Vec3* vA, q3Vec3* wA, q3Vec3* vB, q3Vec3* wB )
+{
+	q3Vec3 dv = *vB + q3Cross( *wB, c->rb ) - *vA - q3Cross( *wA, c->ra );
+	r32 vn = q3Dot( dv, cs->normal );
+	r32 lambda = c->normalMass * (-vn + c->positionBias);
+
+	// Clamp impulse
+	r32 tempPN = c->pseudoImpulse;
+	c->pseudoImpulse = q3Max( tempPN + lambda, r32( 0.0 ) );
+	lambda = c->pseudoImpulse - tempPN;
+
+	// Apply impulse
+	q3Vec3 impulse = cs->normal * lambda;
+	*vA -= impulse * A->m;
+	*wA -= A->i * q3Cross( c->ra, impulse );
+
+	*vB += impulse * B->m;
+	*wB += B->i * q3Cross( c->rb, impulse );
+
+	return q3Abs( lambda );
+}
+
+//--------------------------------------------------------------------------------------------------
+// Solves the n by n system A * x = b by Gaussian elimination with partial
+// pivoting. A is destroyed and x is written into b. Returns false if A is
+// singular.
+static bool q3SolveLinear( r32 A[ Q3_MAX_BLOCK_CONTACTS ][ Q3_MAX_BLOCK_CONTACTS ], r32* b, i32 n )
+{
+	for ( i32 k = 0; k < n; ++k )
+	{
+		i32 p = k;
+		for ( i32 i = k + 1; i < n; ++i )
+		{
+			if ( q3Abs( A[ i ][ k ] ) > q3Abs( A[ p ][ k ] ) )
+				p = i;
+		}
+
+		if ( q3Abs( A[ p ][ k ] ) < r32( 1.0e-12 ) )
+			return false;
+
+		if ( p != k )
+		{
+			for ( i32 j = k; j < n; ++j )
+			{
+				r32 t = A[ p ][ j ];
+				A[ p ][ j ] = A[ k ][ j ];
+				A[ k ][ j ] = t;
+			}
+
+			r32 t = b[ p ];
+			b[ p ] = b[ k ];
+			b[ k ] = t;
+		}
+
+		for ( i32 i = k + 1; i < n; ++i )
+		{
+			r32 f = A[ i ][ k ] / A[ k ][ k ];
+
+			for ( i32 j = k; j < n; ++j )
+				A[ i ][ j ] -= f * A[ k ][ j ];
+
+			b[ i ] -= f * b[ k ];
+		}
+	}
+
+	for ( i32 i = n - 1; i >= 0; --i )
+	{
+		for ( i32 j = i + 1; j < n; ++j )
+			b[ i ] -= A[ i ][ j ] * b[ j ];
+
+		b[ i ] /= A[ i ][ i ];
+	}
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Looks for accumulated impulses x with contacts in the active set pushing
+// (x >= 0, w = 0) and the remaining contacts separating (x = 0, w >= 0),
+// where w = K * x + b is the normal velocity left after the bias.
+static bool q3SolveActiveSet( const q3ContactConstraintState *cs, const r32* b, i32 active, r32* x )
+{
+	i32 n = cs->contactCount;
+	i32 index[ Q3_MAX_BLOCK_CONTACTS ];
+	i32 count = 0;
+
+	for ( i32 i = 0; i < n; ++i )
+	{
+		x[ i ] = r32( 0.0 );
+
+		if ( active & (1 << i) )
+			index[ count++ ] = i;
+	}
+
+	r32 A[ Q3_MAX_BLOCK_CONTACTS ][ Q3_MAX_BLOCK_CONTACTS ];
+	r32 r[ Q3_MAX_BLOCK_CONTACTS ];
+
+	for ( i32 i = 0; i < count; ++i )
+	{
+		r[ i ] = -b[ index[ i ] ];
+
+		for ( i32 j = 0; j < count; ++j )
+			A[ i ][ j ] = cs->K[ index[ i ] ][ index[ j ] ];
+	}
+
+	if ( !q3SolveLinear( A, r, count ) )
+		return false;
+
+	for ( i32 i = 0; i < count; ++i )
+	{
+		if ( r[ i ] < r32( 0.0 ) )
+			return false;
+
+		x[ index[ i ] ] = r[ i ];
+	}
+
+	for ( i32 i = 0; i < n; ++i )
+	{
+		if ( active & (1 << i) )
+			continue;
+
+		r32 w = b[ i ];
+		for ( i32 j = 0; j < n; ++j )
+			w += cs->K[ i ][ j ] * x[ j ];
+
+		if ( w < r32( 0.0 ) )
+			return false;
+	}
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Solves the normal constraints of a manifold together as a linear
+// complementarity problem by trying each set of active contacts, largest
+// sets first. A resting manifold is nearly always solved by the first
+// set. Returns false when no set works, for the caller to fall back upon
+// sequential impulses. The largest change of an accumulated impulse is
+// written to delta.
+static bool q3BlockSolveNormal( q3ContactConstraintState *cs, const q3MassState *A, const q3MassState *B, q3Vec3* vA, q3Vec3* wA, q3Vec3* vB, q3Vec3* wB, r32* delta )
 {
+	i32 n = cs->contactCount;
+	r32 a[ Q3_MAX_BLOCK_CONTACTS ];
+	r32 b[ Q3_MAX_BLOCK_CONTACTS ];
+	r32 x[ Q3_MAX_BLOCK_CONTACTS ];
+
+	// With the impulses a accumulated so far, w = K * (x - a) + vn - bias
+	for ( i32 i = 0; i < n; ++i )
+	{
+		q3ContactState *c = cs->contacts + i;
+		q3Vec3 dv = *vB + q3Cross( *wB, c->rb ) - *vA - q3Cross( *wA, c->ra );
+		a[ i ] = c->normalImpulse;
+		b[ i ] = q3Dot( dv, cs->normal ) - c->bias;
+	}
+
+	for ( i32 i = 0; i < n; ++i )
+	{
+		for ( i32 j = 0; j < n; ++j )
+			b[ i ] -= cs->K[ i ][ j ] * a[ j ];
+	}
+
+	i32 all = (1 << n) - 1;
+	bool solved = false;
+
+	for ( i32 size = n; size >= 0 && !solved; --size )
+	{
+		for ( i32 active = all; active >= 0 && !solved; --active )
+		{
+			i32 bits = 0;
+			for ( i32 i = 0; i < n; ++i )
+				bits += (active >> i) & 1;
+
+			if ( bits == size )
+				solved = q3SolveActiveSet( cs, b, active, x );
+		}
+	}
+
+	if ( !solved )
+		return false;
+
+	// Apply the change in accumulated impulse
+	for ( i32 i = 0; i < n; ++i )
+	{
+		q3ContactState *c = cs->contacts + i;
+		q3Vec3 impulse = cs->normal * (x[ i ] - a[ i ]);
+		c->normalImpulse = x[ i ];
+		*delta = q3Max( *delta, q3Abs( x[ i ] - a[ i ] ) );
+
+		*vA -= impulse * A->m;
+		*wA -= A->i * q3Cross( c->ra, impulse );
+
+		*vB += impulse * B->m;
+		*wB += B->i * q3Cross( c->rb, impulse );
+	}
+
+	return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+r32 q3ContactSolver::Solve( )
+{
+	i32 features = (m_enableFriction ? 4 : 0) | (m_enableBlockSolver ? 2 : 0) | (m_enableSplitImpulse ? 1 : 0);
+
+	switch ( features )
+	{
+	case 0: return SolveKernel<false, false, false>( );
+	case 1: return SolveKernel<false, false, true>( );
+	case 2: return SolveKernel<false, true, false>( );
+	case 3: return SolveKernel<false, true, true>( );
+	case 4: return SolveKernel<true, false, false>( );
+	case 5: return SolveKernel<true, false, true>( );
+	case 6: return SolveKernel<true, true, false>( );
+	default: return SolveKernel<true, true, true>( );
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+template <bool friction, bool blockSolver, bool splitImpulse>
+r32 q3ContactSolver::SolveKernel( )
+{
+	r32 delta = r32( 0.0 );
+
+	for ( i32 i = 0; i < m_contactCount; ++i )
+	{
+		q3ContactConstraintState *cs = m_contacts + i;
+		const q3MassState *A = m_masses + cs->indexA;
+		const q3MassState *B = m_masses + cs->indexB;
+
+		q3Vec3 vA = m_velocities[ cs->indexA ].v;
+		q3Vec3 wA = m_velocities[ cs->indexA ].w;
+		q3Vec3 vB = m_velocities[ cs->indexB ].v;
+		q3Vec3 wB = m_velocities[ cs->indexB ].w;
+
+		if ( blockSolver && cs->blockSolve )
+		{
+			if ( friction && cs->centralFriction )
+				delta = q3Max( delta, q3SolveCentralFriction( cs, A, B, &vA, &wA, &vB, &wB ) );
+
+			else if ( friction )
+			{
+				for ( i32 j = 0; j < cs->contactCount; ++j )
+					delta = q3Max( delta, q3SolveFriction( cs, A, B, cs->contacts + j, &vA, &wA, &vB, &wB ) );
+			}
+
+			if ( !q3BlockSolveNormal( cs, A, B, &vA, &wA, &vB, &wB, &delta ) )
+			{
+				for ( i32 j = 0; j < cs->contactCount; ++j )
+					delta = q3Max( delta, q3SolveNormal( cs, A, B, cs->contacts + j, &vA, &wA, &vB, &wB ) );
+			}
+		}
+
+		else if ( friction && cs->centralFriction )
+		{
+			delta = q3Max( delta, q3SolveCentralFriction( cs, A, B, &vA, &wA, &vB, &wB ) );
+
+			for ( i32 j = 0; j < cs->contactCount; ++j )
+				delta = q3Max( delta, q3SolveNormal( cs, A, B, cs->contacts + j, &vA, &wA, &vB, &wB ) );
+		}
+
+		else
+		{
+			for ( i32 j = 0; j < cs->contactCount; ++j )
+			{
+				q3ContactState *c = cs->contacts + j;
+
+				if ( friction )
+					delta = q3Max( delta, q3SolveFriction( cs, A, B, c, &vA, &wA, &vB, &wB ) );
+
+				delta = q3Max( delta, q3SolveNormal( cs, A, B, c, &vA, &wA, &vB, &wB ) );
+			}
+		}
+
+		m_velocities[ cs->indexA ].v = vA;
+		m_velocities[ cs->indexA ].w = wA;
+		m_velocities[ cs->indexB ].v = vB;
+		m_velocities[ cs->indexB ].w = wB;
+
+		if ( splitImpulse )
+		{
+			q3Vec3 pvA = m_pseudoVelocities[ cs->indexA ].v;
+			q3Vec3 pwA = m_pseudoVelocities[ cs->indexA ].w;
+			q3Vec3 pvB = m_pseudoVelocities[ cs->indexB ].v;
+			q3Vec3 pwB = m_pseudoVelocities[ cs->indexB ].w;
+
+			for ( i32 j = 0; j < cs->contactCount; ++j )
+				delta = q3Max( delta, q3SolvePseudo( cs, A, B, cs->contacts + j, &pvA, &pwA, &pvB, &pwB ) );
+
+			m_pseudoVelocities[ cs->indexA ].v = pvA;
+			m_pseudoVelocities[ cs->indexA ].w = pwA;
+			m_pseudoVelocities[ cs->indexB ].v = pvB;
+			m_pseudoVelocities[ cs->indexB ].w = pwB;
+		}
+	}
+
+	return delta;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3ContactSolver::PreSolveSoft( r32 h )
+{
+	// A contact spring stiffer than a quarter of the sub-step rate cannot be
+	// integrated stably, so the frequency is capped by the sub-step length
+	r32 hertz = q3Min( Q3_CONTACT_HERTZ, r32( 0.25 ) / h );
+	r32 omega = r32( 2.0 ) * q3PI * hertz;
+	r32 a1 = r32( 2.0 ) * Q3_CONTACT_DAMPING_RATIO + h * omega;
+	r32 a2 = h * omega * a1;
+	r32 a3 = r32( 1.0 ) / (r32( 1.0 ) + a2);
+
+	m_h = h;
+	m_biasRate = omega / a1;
+	m_massScale = a2 * a3;
+	m_impulseScale = a3;
+
 	for ( i32 i = 0; i < m_contactCount; ++i )
 	{
 		q3ContactConstraintState *cs = m_contacts + i;
+		const q3MassState *A = m_masses + cs->indexA;
+		const q3MassState *B = m_masses + cs->indexB;
+		q3Body *bodyA = m_island->m_bodies[ cs->indexA ];
+		q3Body *bodyB = m_island->m_bodies[ cs->indexB ];
 
 		q3Vec3 vA = m_velocities[ cs->indexA ].v;
 		q3Vec3 wA = m_velocities[ cs->indexA ].w;
 		q3Vec3 vB = m_velocities[ cs->indexB ].v;
 		q3Vec3 wB = m_velocities[ cs->indexB ].w;
 
+		cs->blockSolve = false;
+		q3PrepareCentralFriction( cs, A, B, m_enableFriction && m_enableCentralFriction );
+
 		for ( i32 j = 0; j < cs->contactCount; ++j )
 		{
 			q3ContactState *c = cs->contacts + j;
+			q3ComputeContactMass( cs, A, B, c );
+
+			// Anchors ride along with the bodies so the separation can be
+			// measured again after every sub-step
+			c->localA = q3Transpose( bodyA->m_tx.rotation ) * c->ra;
+			c->localB = q3Transpose( bodyB->m_tx.rotation ) * c->rb;
 
-			// relative velocity at contact
 			q3Vec3 dv = vB + q3Cross( wB, c->rb ) - vA - q3Cross( wA, c->ra );
+			c->relativeVelocity = q3Dot( dv, cs->normal );
+			c->maxNormalImpulse = r32( 0.0 );
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3ContactSolver::WarmStart( )
+{
+	for ( i32 i = 0; i < m_contactCount; ++i )
+	{
+		q3ContactConstraintState *cs = m_contacts + i;
+		const q3MassState *A = m_masses + cs->indexA;
+		const q3MassState *B = m_masses + cs->indexB;
+
+		q3Vec3 vA = m_velocities[ cs->indexA ].v;
+		q3Vec3 wA = m_velocities[ cs->indexA ].w;
+		q3Vec3 vB = m_velocities[ cs->indexB ].v;
+		q3Vec3 wB = m_velocities[ cs->indexB ].w;
+
+		if ( cs->centralFriction )
+			q3WarmStartCentralFriction( cs, A, B, &vA, &wA, &vB, &wB );
+
+		for ( i32 j = 0; j < cs->contactCount; ++j )
+		{
+			q3ContactState *c = cs->contacts + j;
+			q3Vec3 P = cs->normal * c->normalImpulse;
 
-			// Friction
 			if ( m_enableFriction )
 			{
-				for ( i32 i = 0; i < 2; ++i )
-				{
-					r32 lambda = -q3Dot( dv, cs->tangentVectors[ i ] ) * c->tangentMass[ i ];
+				P += cs->tangentVectors[ 0 ] * c->tangentImpulse[ 0 ];
+				P += cs->tangentVectors[ 1 ] * c->tangentImpulse[ 1 ];
+			}
 
-					// Calculate frictional impulse
-					r32 maxLambda = cs->friction * c->normalImpulse;
+			vA -= P * A->m;
+			wA -= A->i * q3Cross( c->ra, P );
 
-					// Clamp frictional impulse
-					r32 oldPT = c->tangentImpulse[ i ];
-					c->tangentImpulse[ i ] = q3Clamp( -maxLambda, maxLambda, oldPT + lambda );
-					lambda = c->tangentImpulse[ i ] - oldPT;
+			vB += P * B->m;
+			wB += B->i * q3Cross( c->rb, P );
+		}
 
-					// Apply friction impulse
-					q3Vec3 impulse = cs->tangentVectors[ i ] * lambda;
-					vA -= impulse * cs->mA;
-					wA -= cs->iA * q3Cross( c->ra, impulse );
+		m_velocities[ cs->indexA ].v = vA;
+		m_velocities[ cs->indexA ].w = wA;
+		m_velocities[ cs->indexB ].v = vB;
+		m_velocities[ cs->indexB ].w = wB;
+	}
+}
 
-					vB += impulse * cs->mB;
-					wB += cs->iB * q3Cross( c->rb, impulse );
-				}
-			}
+//--------------------------------------------------------------------------------------------------
+// The normal constraint is a spring pushing the shapes apart instead of a
+// Baumgarte bias, so deep contacts are resolved over several sub-steps
+// without adding energy. Without bias the constraint only removes
+// approaching velocity, relaxing the push of the previous solve.
+void q3ContactSolver::SolveSoft( bool useBias )
+{
+	for ( i32 i = 0; i < m_contactCount; ++i )
+	{
+		q3ContactConstraintState *cs = m_contacts + i;
+		const q3MassState *A = m_masses + cs->indexA;
+		const q3MassState *B = m_masses + cs->indexB;
+		q3Body *bodyA = m_island->m_bodies[ cs->indexA ];
+		q3Body *bodyB = m_island->m_bodies[ cs->indexB ];
 
-			// Normal
-			{
-				dv = vB + q3Cross( wB, c->rb ) - vA - q3Cross( wA, c->ra );
+		q3Vec3 vA = m_velocities[ cs->indexA ].v;
+		q3Vec3 wA = m_velocities[ cs->indexA ].w;
+		q3Vec3 vB = m_velocities[ cs->indexB ].v;
+		q3Vec3 wB = m_velocities[ cs->indexB ].w;
 
-				// Normal impulse
-				r32 vn = q3Dot( dv, cs->normal );
+		for ( i32 j = 0; j < cs->contactCount; ++j )
+		{
+			q3ContactState *c = cs->contacts + j;
 
-				// Factor in positional bias to calculate impulse scalar j
-				r32 lambda = c->normalMass * (-vn + c->bias);
+			// Current separation from the motion of the bodies so far
+			q3Vec3 pA = bodyA->m_worldCenter + bodyA->m_tx.rotation * c->localA;
+			q3Vec3 pB = bodyB->m_worldCenter + bodyB->m_tx.rotation * c->localB;
+			r32 s = q3Dot( pB - pA, cs->normal ) + c->penetration;
 
-				// Clamp impulse
-				r32 tempPN = c->normalImpulse;
-				c->normalImpulse = q3Max( tempPN + lambda, r32( 0.0 ) );
-				lambda = c->normalImpulse - tempPN;
+			r32 bias = r32( 0.0 );
+			r32 massScale = r32( 1.0 );
+			r32 impulseScale = r32( 0.0 );
 
-				// Apply impulse
-				q3Vec3 impulse = cs->normal * lambda;
-				vA -= impulse * cs->mA;
-				wA -= cs->iA * q3Cross( c->ra, impulse );
+			// Speculative, allow the shapes to approach until they touch
+			if ( s > r32( 0.0 ) )
+				bias = s / m_h;
 
-				vB += impulse * cs->mB;
-				wB += cs->iB * q3Cross( c->rb, impulse );
+			else if ( useBias )
+			{
+				bias = q3Max( m_biasRate * q3Min( r32( 0.0 ), s + Q3_PENETRATION_SLOP ), -Q3_MAX_PUSHOUT );
+				massScale = m_massScale;
+				impulseScale = m_impulseScale;
 			}
+
+			q3Vec3 dv = vB + q3Cross( wB, c->rb ) - vA - q3Cross( wA, c->ra );
+			r32 vn = q3Dot( dv, cs->normal );
+			r32 lambda = -c->normalMass * massScale * (vn + bias) - impulseScale * c->normalImpulse;
+
+			// Clamp impulse
+			r32 tempPN = c->normalImpulse;
+			c->normalImpulse = q3Max( tempPN + lambda, r32( 0.0 ) );
+			lambda = c->normalImpulse - tempPN;
+			c->maxNormalImpulse = q3Max( c->maxNormalImpulse, c->normalImpulse );
+
+			// Apply impulse
+			q3Vec3 impulse = cs->normal * lambda;
+			vA -= impulse * A->m;
+			wA -= A->i * q3Cross( c->ra, impulse );
+
+			vB += impulse * B->m;
+			wB += B->i * q3Cross( c->rb, impulse );
+		}
+
+		if ( cs->centralFriction )
+			q3SolveCentralFriction( cs, A, B, &vA, &wA, &vB, &wB );
+
+		else if ( m_enableFriction )
+		{
+			for ( i32 j = 0; j < cs->contactCount; ++j )
+				q3SolveFriction( cs, A, B, cs->contacts + j, &vA, &wA, &vB, &wB );
+		}
+
+		m_velocities[ cs->indexA ].v = vA;
+		m_velocities[ cs->indexA ].w = wA;
+		m_velocities[ cs->indexB ].v = vB;
+		m_velocities[ cs->indexB ].w = wB;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3ContactSolver::ApplyRestitution( )
+{
+	for ( i32 i = 0; i < m_contactCount; ++i )
+	{
+		q3ContactConstraintState *cs = m_contacts + i;
+		const q3MassState *A = m_masses + cs->indexA;
+		const q3MassState *B = m_masses + cs->indexB;
+
+		if ( cs->restitution == r32( 0.0 ) )
+			continue;
+
+		q3Vec3 vA = m_velocities[ cs->indexA ].v;
+		q3Vec3 wA = m_velocities[ cs->indexA ].w;
+		q3Vec3 vB = m_velocities[ cs->indexB ].v;
+		q3Vec3 wB = m_velocities[ cs->indexB ].w;
+
+		for ( i32 j = 0; j < cs->contactCount; ++j )
+		{
+			q3ContactState *c = cs->contacts + j;
+
+			if ( c->relativeVelocity > -r32( 1.0 ) || c->maxNormalImpulse == r32( 0.0 ) )
+				continue;
+
+			q3Vec3 dv = vB + q3Cross( wB, c->rb ) - vA - q3Cross( wA, c->ra );
+			r32 vn = q3Dot( dv, cs->normal );
+			r32 lambda = -c->normalMass * (vn + cs->restitution * c->relativeVelocity);
+
+			// Clamp impulse
+			r32 tempPN = c->normalImpulse;
+			c->normalImpulse = q3Max( tempPN + lambda, r32( 0.0 ) );
+			lambda = c->normalImpulse - tempPN;
+
+			// Apply impulse
+			q3Vec3 impulse = cs->normal * lambda;
+			vA -= impulse * A->m;
+			wA -= A->i * q3Cross( c->ra, impulse );
+
+			vB += impulse * B->m;
+			wB += B->i * q3Cross( c->rb, impulse );
+		}
+
+		m_velocities[ cs->indexA ].v = vA;
+		m_velocities[ cs->indexA ].w = wA;
+		m_velocities[ cs->indexB ].v = vB;
+		m_velocities[ cs->indexB ].w = wB;
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+// Solves the normal constraint of each contact as if the lower body were
+// immovable. With the contacts ordered from the ground up the support of a
+// stack reaches its top within a single pass, instead of rising one layer
+// per iteration. The lower body takes no reaction, so the accumulated
+// impulses are left as they were for warm starting.
+void q3ContactSolver::SolveShock( )
+{
+	q3MassState fixed;
+	fixed.i = q3Diagonal( r32( 0.0 ) );
+	fixed.m = r32( 0.0 );
+
+	for ( i32 i = 0; i < m_contactCount; ++i )
+	{
+		q3ContactConstraintState *cs = m_contacts + i;
+		const q3MassState *A = m_masses + cs->indexA;
+		const q3MassState *B = m_masses + cs->indexB;
+		q3Body *bodyA = m_island->m_bodies[ cs->indexA ];
+		q3Body *bodyB = m_island->m_bodies[ cs->indexB ];
+
+		// Static and kinematic bodies are immovable already
+		if ( (bodyA->m_flags & q3Body::eDynamic) && (bodyB->m_flags & q3Body::eDynamic) )
+		{
+			if ( q3Dot( bodyA->m_worldCenter, m_up ) < q3Dot( bodyB->m_worldCenter, m_up ) )
+				A = &fixed;
+
+			else
+				B = &fixed;
+		}
+
+		q3Vec3 vA = m_velocities[ cs->indexA ].v;
+		q3Vec3 wA = m_velocities[ cs->indexA ].w;
+		q3Vec3 vB = m_velocities[ cs->indexB ].v;
+		q3Vec3 wB = m_velocities[ cs->indexB ].w;
+
+		for ( i32 j = 0; j < cs->contactCount; ++j )
+		{
+			q3ContactState *c = cs->contacts + j;
+			r32 normalMass = c->normalMass;
+			r32 normalImpulse = c->normalImpulse;
+
+			q3Vec3 raCn = q3Cross( c->ra, cs->normal );
+			q3Vec3 rbCn = q3Cross( c->rb, cs->normal );
+			r32 nm = A->m + B->m + q3Dot( raCn, A->i * raCn ) + q3Dot( rbCn, B->i * rbCn );
+			c->normalMass = q3Invert( nm );
+
+			q3SolveNormal( cs, A, B, c, &vA, &wA, &vB, &wB );
+
+			c->normalMass = normalMass;
+			c->normalImpulse = normalImpulse;
 		}
 
 		m_velocities[ cs->indexA ].v = vA;
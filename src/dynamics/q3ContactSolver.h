@@ -35,6 +35,7 @@
 //--------------------------------------------------------------------------------------------------
 struct q3Island;
 struct q3VelocityState;
+struct q3MassState;
 
 struct q3ContactState
 {
@@ -46,6 +47,12 @@ struct q3ContactState
 	r32 bias;					// Restitution + baumgarte
 	r32 normalMass;				// Normal constraint mass
 	r32 tangentMass[ 2 ];		// Tangent constraint mass
+	q3Vec3 localA;				// ra in the frame of A at the start of the step
+	q3Vec3 localB;				// rb in the frame of B at the start of the step
+	r32 relativeVelocity;		// Normal velocity before solving, for restitution
+	r32 maxNormalImpulse;		// Largest normal impulse of any sub-step
+	r32 positionBias;			// Baumgarte bias of the split impulse
+	r32 pseudoImpulse;			// Accumulated split impulse
 };
 
 struct q3ContactConstraintState
@@ -54,16 +61,25 @@ struct q3ContactConstraintState
 	i32 contactCount;
 	q3Vec3 tangentVectors[ 2 ];	// Tangent vectors
 	q3Vec3 normal;				// From A to B
-	q3Vec3 centerA;
-	q3Vec3 centerB;
-	q3Mat3 iA;
-	q3Mat3 iB;
-	r32 mA;
-	r32 mB;
 	r32 restitution;
 	r32 friction;
 	i32 indexA;
 	i32 indexB;
+
+	// Normal mass matrix used when the block solver handles this manifold
+	r32 K[ Q3_MAX_BLOCK_CONTACTS ][ Q3_MAX_BLOCK_CONTACTS ];
+	bool blockSolve;
+
+	// Friction rows at the center of the contacts, used in place of the
+	// friction rows of each contact when centralFriction is set
+	q3Vec3 centerRa;
+	q3Vec3 centerRb;
+	r32 tangentImpulse[ 2 ];
+	r32 tangentMass[ 2 ];
+	r32 twistImpulse;
+	r32 twistMass;
+	r32 frictionRadius;			// Mean distance of the contacts from the center
+	bool centralFriction;
 };
 
 struct q3ContactSolver
@@ -72,14 +88,51 @@ struct q3ContactSolver
 	void ShutDown( void );
 
 	void PreSolve( r32 dt );
-	void Solve( void );
+
+	// Runs one iteration and returns the largest change to any accumulated
+	// impulse, used to detect convergence
+	r32 Solve( void );
+
+	// Sub-stepping mode. PreSolveSoft is called once with the sub-step
+	// length, then each sub-step warm starts, solves with bias, integrates
+	// positions and solves again without bias. Restitution is applied once
+	// after the last sub-step.
+	void PreSolveSoft( r32 h );
+	void WarmStart( void );
+	void SolveSoft( bool useBias );
+	void ApplyRestitution( void );
+
+	// Shock propagation pass, see q3Scene::SetEnableShockPropagation
+	void SolveShock( void );
+
+	// Kernels specialized upon the island's features, so the flags are
+	// tested once per call instead of for every contact
+	template <bool friction, bool splitImpulse>
+	void PreSolveKernel( r32 dt );
+
+	template <bool friction, bool blockSolver, bool splitImpulse>
+	r32 SolveKernel( void );
 
 	q3Island *m_island;
 	q3ContactConstraintState *m_contacts;
 	i32 m_contactCount;
 	q3VelocityState *m_velocities;
+	q3VelocityState *m_pseudoVelocities;
+	q3MassState *m_masses;
+
+	// Soft constraint coefficients for the sub-step length
+	r32 m_h;
+	r32 m_biasRate;
+	r32 m_massScale;
+	r32 m_impulseScale;
+
+	// Against gravity, used to tell the lower body of a contact
+	q3Vec3 m_up;
 
 	bool m_enableFriction;
+	bool m_enableBlockSolver;
+	bool m_enableSplitImpulse;
+	bool m_enableCentralFriction;
 };
 
 #endif // Q3CONTACTSOLVER_H
@@ -24,6 +24,8 @@
 */
 //--------------------------------------------------------------------------------------------------
 
+#include <algorithm>
+
 #include "q3Island.h"
 #include "q3Body.h"
 #include "../common/q3Memory.h"
@@ -38,7 +40,7 @@
 void q3Island::Solve( )
 {
 	// Apply gravity
-	// Integrate velocities and create state buffers, calculate world inertia
+	// Create state buffers, calculate world inertia
 	for ( i32 i = 0 ; i < m_bodyCount; ++i )
 	{
 		q3Body *body = m_bodies[ i ];
@@ -49,43 +51,80 @@ void q3Island::Solve( )
 			body->ApplyLinearForce( m_gravity * body->m_gravityScale );
 
 			// Calculate world space intertia tensor
-			q3Mat3 r = body->m_tx.rotation;
-			body->m_invInertiaWorld = r * body->m_invInertiaModel * q3Transpose( r );
-
-			// Integrate velocity
-			body->m_linearVelocity += (body->m_force * body->m_invMass) * m_dt;
-			body->m_angularVelocity += (body->m_invInertiaWorld * body->m_torque) * m_dt;
-
-			// From Box2D!
-			// Apply damping.
-			// ODE: dv/dt + c * v = 0
-			// Solution: v(t) = v0 * exp(-c * t)
-			// Time step: v(t + dt) = v0 * exp(-c * (t + dt)) = v0 * exp(-c * t) * exp(-c * dt) = v * exp(-c * dt)
-			// v2 = exp(-c * dt) * v1
-			// Pade approximation:
-			// v2 = v1 * 1 / (1 + c * dt)
-			body->m_linearVelocity *= r32( 1.0 ) / (r32( 1.0 ) + m_dt * body->m_linearDamping);
-			body->m_angularVelocity *= r32( 1.0 ) / (r32( 1.0 ) + m_dt * body->m_angularDamping);
+			body->UpdateInvInertiaWorld( );
+		}
+
+		// Bullets are swept from here once all islands are solved
+		if ( body->m_flags & q3Body::eBullet )
+		{
+			body->m_worldCenter0 = body->m_worldCenter;
+			body->m_q0 = body->m_q;
 		}
 
 		v->v = body->m_linearVelocity;
 		v->w = body->m_angularVelocity;
+
+		if ( m_enableSplitImpulse )
+		{
+			m_pseudoVelocities[ i ].v.SetAll( r32( 0.0 ) );
+			m_pseudoVelocities[ i ].w.SetAll( r32( 0.0 ) );
+		}
 	}
 
 	// Create contact solver, pass in state buffers, create buffers for contacts
-	// Initialize velocity constraint for normal + friction and warm start
 	q3ContactSolver contactSolver;
 	contactSolver.Initialize( this );
-	contactSolver.PreSolve( m_dt );
 
-	// Solve contacts
-	for ( i32 i = 0; i < m_iterations; ++i )
-		contactSolver.Solve( );
+	if ( m_substeps > 1 )
+	{
+		// Each sub-step recomputes the separation of every contact from the
+		// motion of the bodies so far, pushes apart with soft constraints and
+		// then relaxes away the velocity the push added
+		r32 h = m_dt / r32( m_substeps );
+		contactSolver.PreSolveSoft( h );
+
+		for ( i32 i = 0; i < m_substeps; ++i )
+		{
+			IntegrateVelocities( h );
+			contactSolver.WarmStart( );
+			contactSolver.SolveSoft( true );
+			IntegratePositions( h );
+			contactSolver.SolveSoft( false );
+		}
+
+		contactSolver.ApplyRestitution( );
+	}
+
+	else
+	{
+		// Initialize velocity constraint for normal + friction and warm start
+		IntegrateVelocities( m_dt );
+		contactSolver.PreSolve( m_dt );
+
+		// The final iterations are given to shock propagation
+		i32 shockIterations = 0;
+		if ( m_enableShockPropagation )
+			shockIterations = q3Min( Q3_SHOCK_ITERATIONS, m_iterations - 1 );
+
+		// Solve contacts, stopping early once no impulse changes by more than
+		// the tolerance
+		for ( i32 i = 0; i < m_iterations - shockIterations; ++i )
+		{
+			r32 delta = contactSolver.Solve( );
+
+			if ( i + 1 >= m_minIterations && delta < m_impulseTolerance )
+				break;
+		}
+
+		for ( i32 i = 0; i < shockIterations; ++i )
+			contactSolver.SolveShock( );
+
+		IntegratePositions( m_dt );
+	}
 
 	contactSolver.ShutDown( );
 
 	// Copy back state buffers
-	// Integrate positions
 	for ( i32 i = 0 ; i < m_bodyCount; ++i )
 	{
 		q3Body *body = m_bodies[ i ];
@@ -96,53 +135,153 @@ void q3Island::Solve( )
 
 		body->m_linearVelocity = v->v;
 		body->m_angularVelocity = v->w;
+	}
+
+	if ( m_allowSleep )
+	{
+		for ( i32 i = 0; i < m_islandCount; ++i )
+		{
+			i32 lastBody = i + 1 < m_islandCount ? m_islandStarts[ i + 1 ] : m_bodyCount;
+			Sleep( m_islandStarts[ i ], lastBody );
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Island::IntegrateVelocities( r32 h )
+{
+	for ( i32 i = 0 ; i < m_bodyCount; ++i )
+	{
+		q3Body *body = m_bodies[ i ];
+		q3VelocityState *v = m_velocities + i;
+
+		if ( !(body->m_flags & q3Body::eDynamic) )
+			continue;
+
+		v->v += (body->m_force * body->m_invMass) * h;
+		v->w += (body->m_invInertiaWorld * body->m_torque) * h;
+
+		// From Box2D!
+		// Apply damping.
+		// ODE: dv/dt + c * v = 0
+		// Solution: v(t) = v0 * exp(-c * t)
+		// Time step: v(t + dt) = v0 * exp(-c * (t + dt)) = v0 * exp(-c * t) * exp(-c * dt) = v * exp(-c * dt)
+		// v2 = exp(-c * dt) * v1
+		// Pade approximation:
+		// v2 = v1 * 1 / (1 + c * dt)
+		v->v *= r32( 1.0 ) / (r32( 1.0 ) + h * body->m_linearDamping);
+		v->w *= r32( 1.0 ) / (r32( 1.0 ) + h * body->m_angularDamping);
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Island::IntegratePositions( r32 h )
+{
+	for ( i32 i = 0 ; i < m_bodyCount; ++i )
+	{
+		q3Body *body = m_bodies[ i ];
+		q3VelocityState *v = m_velocities + i;
+
+		if ( body->m_flags & q3Body::eStatic )
+			continue;
 
-		// Integrate position
-		body->m_worldCenter += body->m_linearVelocity * m_dt;
-		body->m_q.Integrate( body->m_angularVelocity, m_dt );
+		q3Vec3 lv = v->v;
+		q3Vec3 av = v->w;
+
+		// Penetration is resolved by moving the bodies without leaving any
+		// velocity behind
+		if ( m_enableSplitImpulse )
+		{
+			lv += m_pseudoVelocities[ i ].v;
+			av += m_pseudoVelocities[ i ].w;
+		}
+
+		body->m_worldCenter += lv * h;
+		body->m_q.Integrate( av, h );
 		body->m_q = q3Normalize( body->m_q );
 		body->m_tx.rotation = body->m_q.ToMat3( );
 	}
+}
 
-	if ( m_allowSleep )
+//--------------------------------------------------------------------------------------------------
+void q3Island::Sleep( i32 firstBody, i32 lastBody )
+{
+	// Find minimum sleep time of the entire island
+	f32 minSleepTime = Q3_R32_MAX;
+	for ( i32 i = firstBody; i < lastBody; ++i )
 	{
-		// Find minimum sleep time of the entire island
-		f32 minSleepTime = Q3_R32_MAX;
-		for ( i32 i = 0; i < m_bodyCount; ++i )
+		q3Body* body = m_bodies[ i ];
+
+		if ( body->m_flags & q3Body::eStatic )
+			continue;
+
+		const r32 sqrLinVel = q3Dot( body->m_linearVelocity, body->m_linearVelocity );
+		const r32 cbAngVel = q3Dot( body->m_angularVelocity, body->m_angularVelocity );
+		// Degraded quality lets bodies sleep while moving faster
+		const r32 linTol = Q3_SLEEP_LINEAR / m_quality;
+		const r32 angTol = Q3_SLEEP_ANGULAR / m_quality;
+
+		if ( sqrLinVel > linTol || cbAngVel > angTol )
 		{
-			q3Body* body = m_bodies[ i ];
+			minSleepTime = r32( 0.0 );
+			body->m_sleepTime = r32( 0.0 );
+		}
+
+		else
+		{
+			body->m_sleepTime += m_dt;
+			minSleepTime = q3Min( minSleepTime, body->m_sleepTime );
+		}
+	}
+
+	// Put entire island to sleep so long as the minimum found sleep time
+	// is below the threshold. If the minimum sleep time reaches below the
+	// sleeping threshold, the entire island will be reformed next step
+	// and sleep test will be tried again.
+	if ( minSleepTime > Q3_SLEEP_TIME * m_quality )
+	{
+		for ( i32 i = firstBody; i < lastBody; ++i )
+			m_bodies[ i ]->SetToSleep( );
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+i32 q3Island::Depth( i32 *depths, i32 firstBody, i32 firstContact ) const
+{
+	for ( i32 i = firstBody; i < m_bodyCount; ++i )
+		depths[ i ] = (m_bodies[ i ]->m_flags & q3Body::eDynamic) ? -1 : 0;
 
-			if ( body->m_flags & q3Body::eStatic )
-				continue;
+	// Relax the depths across the contacts until they settle, which takes
+	// about as many passes as the island is deep
+	bool changed = true;
+	while ( changed )
+	{
+		changed = false;
 
-			const r32 sqrLinVel = q3Dot( body->m_linearVelocity, body->m_linearVelocity );
-			const r32 cbAngVel = q3Dot( body->m_angularVelocity, body->m_angularVelocity );
-			const r32 linTol = Q3_SLEEP_LINEAR;
-			const r32 angTol = Q3_SLEEP_ANGULAR;
+		for ( i32 i = firstContact; i < m_contactCount; ++i )
+		{
+			i32 a = m_contacts[ i ]->bodyA->m_islandIndex;
+			i32 b = m_contacts[ i ]->bodyB->m_islandIndex;
 
-			if ( sqrLinVel > linTol || cbAngVel > angTol )
+			if ( depths[ a ] >= 0 && (depths[ b ] < 0 || depths[ b ] > depths[ a ] + 1) )
 			{
-				minSleepTime = r32( 0.0 );
-				body->m_sleepTime = r32( 0.0 );
+				depths[ b ] = depths[ a ] + 1;
+				changed = true;
 			}
 
-			else
+			if ( depths[ b ] >= 0 && (depths[ a ] < 0 || depths[ a ] > depths[ b ] + 1) )
 			{
-				body->m_sleepTime += m_dt;
-				minSleepTime = q3Min( minSleepTime, body->m_sleepTime );
+				depths[ a ] = depths[ b ] + 1;
+				changed = true;
 			}
 		}
-
-		// Put entire island to sleep so long as the minimum found sleep time
-		// is below the threshold. If the minimum sleep time reaches below the
-		// sleeping threshold, the entire island will be reformed next step
-		// and sleep test will be tried again.
-		if ( minSleepTime > Q3_SLEEP_TIME )
-		{
-			for ( i32 i = 0; i < m_bodyCount; ++i )
-				m_bodies[ i ]->SetToSleep( );
-		}
 	}
+
+	i32 depth = 0;
+	for ( i32 i = firstBody; i < m_bodyCount; ++i )
+		depth = q3Max( depth, depths[ i ] );
+
+	return depth;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -163,21 +302,54 @@ void q3Island::Add( q3ContactConstraint *contact )
 	m_contacts[ m_contactCount++ ] = contact;
 }
 
+//--------------------------------------------------------------------------------------------------
+// Orders contacts by the height of their lower dynamic body, so contacts
+// upon static and kinematic bodies come first
+struct q3ContactHeightSort
+{
+	r32 Height( const q3ContactConstraint* contact ) const
+	{
+		const q3Body* bodyA = contact->bodyA;
+		const q3Body* bodyB = contact->bodyB;
+
+		if ( !(bodyA->m_flags & q3Body::eDynamic) || !(bodyB->m_flags & q3Body::eDynamic) )
+			return -Q3_R32_MAX;
+
+		return q3Min( q3Dot( bodyA->m_worldCenter, up ), q3Dot( bodyB->m_worldCenter, up ) );
+	}
+
+	bool operator( )( const q3ContactConstraint* a, const q3ContactConstraint* b ) const
+	{
+		return Height( a ) < Height( b );
+	}
+
+	q3Vec3 up;
+};
+
 //--------------------------------------------------------------------------------------------------
 void q3Island::Initialize( )
 {
+	// Shock propagation solves contacts from the ground up
+	if ( m_enableShockPropagation )
+	{
+		q3ContactHeightSort sort;
+		sort.up = -m_gravity;
+		std::sort( m_contacts, m_contacts + m_contactCount, sort );
+	}
+
+	for ( i32 i = 0; i < m_bodyCount; ++i )
+	{
+		q3Body *body = m_bodies[ i ];
+		m_masses[ i ].i = body->m_invInertiaWorld;
+		m_masses[ i ].m = body->m_invMass;
+	}
+
 	for ( i32 i = 0; i < m_contactCount; ++i )
 	{
 		q3ContactConstraint *cc = m_contacts[ i ];
 
 		q3ContactConstraintState *c = m_contactStates + i;
 
-		c->centerA = cc->bodyA->m_worldCenter;
-		c->centerB = cc->bodyB->m_worldCenter;
-		c->iA = cc->bodyA->m_invInertiaWorld;
-		c->iB = cc->bodyB->m_invInertiaWorld;
-		c->mA = cc->bodyA->m_invMass;
-		c->mB = cc->bodyB->m_invMass;
 		c->restitution = cc->restitution;
 		c->friction = cc->friction;
 		c->indexA = cc->bodyA->m_islandIndex;
@@ -186,13 +358,16 @@ void q3Island::Initialize( )
 		c->tangentVectors[ 0 ] = cc->manifold.tangentVectors[ 0 ];
 		c->tangentVectors[ 1 ] = cc->manifold.tangentVectors[ 1 ];
 		c->contactCount = cc->manifold.contactCount;
+		c->tangentImpulse[ 0 ] = cc->manifold.tangentImpulse[ 0 ];
+		c->tangentImpulse[ 1 ] = cc->manifold.tangentImpulse[ 1 ];
+		c->twistImpulse = cc->manifold.twistImpulse;
 
 		for ( i32 j = 0; j < c->contactCount; ++j )
 		{
 			q3ContactState *s = c->contacts + j;
 			q3Contact *cp = cc->manifold.contacts + j;
-			s->ra = cp->position - c->centerA;
-			s->rb = cp->position - c->centerB;
+			s->ra = cp->position - cc->bodyA->m_worldCenter;
+			s->rb = cp->position - cc->bodyB->m_worldCenter;
 			s->penetration = cp->penetration;
 			s->normalImpulse = cp->normalImpulse;
 			s->tangentImpulse[ 0 ] = cp->tangentImpulse[ 0 ];
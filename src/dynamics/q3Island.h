@@ -45,15 +45,52 @@ struct q3VelocityState
 	q3Vec3 v;
 };
 
+// Mass of a body as seen by the contact solver, gathered once per step so
+// constraints index bodies instead of carrying their own copies
+struct q3MassState
+{
+	q3Mat3 i;	// Inverse world inertia
+	r32 m;		// Inverse mass
+};
+
+// Bodies connected by touching contacts, kept from one step to the next so
+// islands need not be searched for every step. Contacts that begin touching
+// merge the sets of their bodies at once. Contacts that stop touching only
+// mark their set, which is split apart before it is next solved. Static
+// bodies belong to no set.
+struct q3IslandSet
+{
+	q3Body* bodyList;
+	q3ContactConstraint* contactList;	// In the order the contacts were linked
+	q3ContactConstraint* contactTail;
+	i32 bodyCount;
+	i32 contactCount;
+	bool awake;		// Set while any of its bodies may be awake
+	bool split;		// A contact between two of its bodies was unlinked
+
+	q3IslandSet* next;
+	q3IslandSet* prev;
+};
+
 struct q3Island
 {
 	void Solve( );
 	void Add( q3Body *body );
 	void Add( q3ContactConstraint *contact );
 	void Initialize( );
+	void IntegrateVelocities( r32 h );
+	void IntegratePositions( r32 h );
+	void Sleep( i32 firstBody, i32 lastBody );
+
+	// Depth of the deepest dynamic body below a static or kinematic body,
+	// counted in contacts, for the island added last starting at firstBody
+	// and firstContact. depths is scratch space for each body.
+	i32 Depth( i32 *depths, i32 firstBody, i32 firstContact ) const;
 
 	q3Body **m_bodies;
 	q3VelocityState *m_velocities;
+	q3VelocityState *m_pseudoVelocities;	// Position correction only, see q3Scene::SetEnableSplitImpulse
+	q3MassState *m_masses;
 	i32 m_bodyCapacity;
 	i32 m_bodyCount;
 
@@ -62,12 +99,25 @@ struct q3Island
 	i32 m_contactCount;
 	i32 m_contactCapacity;
 
+	// First body of each island gathered into this one, which are solved
+	// together but fall asleep apart
+	i32 *m_islandStarts;
+	i32 m_islandCount;
+
 	r32 m_dt;
 	q3Vec3 m_gravity;
 	i32 m_iterations;
+	i32 m_minIterations;
+	r32 m_impulseTolerance;
+	i32 m_substeps;
+	r32 m_quality;		// Below 1 while the scene is over its step budget
 
 	bool m_allowSleep;
 	bool m_enableFriction;
+	bool m_enableBlockSolver;
+	bool m_enableSplitImpulse;
+	bool m_enableCentralFriction;
+	bool m_enableShockPropagation;
 };
 
 #endif // Q3ISLAND_H
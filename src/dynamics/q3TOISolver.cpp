@@ -0,0 +1,479 @@
+//--------------------------------------------------------------------------------------------------
+/**
+@file	q3TOISolver.cpp
+
+@author	Randy Gaul
+@date	10/19/2026
+
+	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+
+	This software is provided 'as-is', without any express or implied
+	warranty. In no event will the authors be held liable for any damages
+	arising from the use of this software.
+
+	Permission is granted to anyone to use this software for any purpose,
+	including commercial applications, and to alter it and redistribute it
+	freely, subject to the following restrictions:
+	  1. The origin of this software must not be misrepresented; you must not
+	     claim that you wrote the original software. If you use this software
+	     in a product, an acknowledgment in the product documentation would be
+	     appreciated but is not required.
+	  2. Altered source versions must be plainly marked as such, and must not
+	     be misrepresented as being the original software.
+	  3. This notice may not be removed or altered from any source distribution.
+*/
+//--------------------------------------------------------------------------------------------------
+
+#include "q3TOISolver.h"
+#include "q3Body.h"
+#include "q3Contact.h"
+#include "../broadphase/q3BroadPhase.h"
+#include "../collision/q3Collide.h"
+#include "../collision/q3Mesh.h"
+#include "../collision/q3Heightfield.h"
+#include "../collision/q3Plane.h"
+#include "../common/q3Memory.h"
+#include "../common/q3Settings.h"
+
+//--------------------------------------------------------------------------------------------------
+// q3Sweep
+//--------------------------------------------------------------------------------------------------
+const q3Quaternion q3Sweep::GetOrientation( r32 t ) const
+{
+	// Normalized lerp along the shortest arc
+	r32 s = q0.x * q1.x + q0.y * q1.y + q0.z * q1.z + q0.w * q1.w < r32( 0.0 ) ? -t : t;
+	r32 u = r32( 1.0 ) - t;
+
+	return q3Normalize( q3Quaternion(
+		u * q0.x + s * q1.x,
+		u * q0.y + s * q1.y,
+		u * q0.z + s * q1.z,
+		u * q0.w + s * q1.w
+		) );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Sweep::GetTransform( q3Transform* tx, r32 t ) const
+{
+	tx->rotation = GetOrientation( t ).ToMat3( );
+	tx->position = c0 + (c1 - c0) * t - tx->rotation * localCenter;
+}
+
+//--------------------------------------------------------------------------------------------------
+// q3TOISolver
+//--------------------------------------------------------------------------------------------------
+// Bisection steps taken to refine the time of impact within a sample
+const i32 k_toiIterations = 12;
+
+// Sequential impulse passes used to resolve the velocity of a bullet at impact
+const i32 k_toiVelocityIterations = 8;
+
+const i32 k_maxTOIContacts = 32;
+
+//--------------------------------------------------------------------------------------------------
+void q3TOISolver::Initialize( const q3BroadPhase *broadphase, r32 dt )
+{
+	m_broadphase = broadphase;
+	m_dt = dt;
+	m_pairs = NULL;
+	m_pairCount = 0;
+	m_pairCapacity = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3TOISolver::ShutDown( void )
+{
+	if ( m_pairs )
+		q3Free( m_pairs );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3TOISolver::AddPair( q3Shape *A, q3Shape *B, i32 childB )
+{
+	if ( m_pairCount == m_pairCapacity )
+	{
+		q3TOIPair* oldPairs = m_pairs;
+		m_pairCapacity = m_pairCapacity ? m_pairCapacity * 2 : 64;
+		m_pairs = (q3TOIPair*)q3Alloc( m_pairCapacity * sizeof( q3TOIPair ) );
+
+		if ( oldPairs )
+		{
+			memcpy( m_pairs, oldPairs, m_pairCount * sizeof( q3TOIPair ) );
+			q3Free( oldPairs );
+		}
+	}
+
+	// Collision routines expect shapes ordered by type
+	if ( A->type > B->type )
+		std::swap( A, B );
+
+	q3TOIPair* pair = m_pairs + m_pairCount++;
+	pair->A = A;
+	pair->B = B;
+	pair->childB = childB;
+	pair->depth0 = r32( 0.0 );
+}
+
+//--------------------------------------------------------------------------------------------------
+// Pairs every shape of the bullet with each triangle of B (a mesh or
+// heightfield) that overlaps the swept aabb
+template <typename T>
+struct q3TOITriangleWrapper
+{
+	bool TreeCallBack( i32 index )
+	{
+		q3AABB triAABB;
+		triangles->ComputeTriangleAABB( triangles->body->GetTransform( ), index, &triAABB );
+
+		if ( !q3AABBtoAABB( aabb, triAABB ) )
+			return true;
+
+		for ( q3Shape* shape = shapes; shape; shape = shape->next )
+		{
+			if ( !shape->sensor )
+				solver->AddPair( shape, triangles, index );
+		}
+
+		return true;
+	}
+
+	q3TOISolver *solver;
+	q3Shape *shapes;
+	T *triangles;
+	q3AABB aabb;
+};
+
+//--------------------------------------------------------------------------------------------------
+template <typename T>
+static void q3AddTriangles( q3TOISolver *solver, q3Shape *shapes, T *triangles, const q3AABB& aabb )
+{
+	q3TOITriangleWrapper<T> wrapper;
+	wrapper.solver = solver;
+	wrapper.shapes = shapes;
+	wrapper.triangles = triangles;
+	wrapper.aabb = aabb;
+
+	triangles->Query( &wrapper, q3Mul( q3Inverse( triangles->body->GetTransform( ) ), aabb ) );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3TOISolver::FindPairs( q3Body *body, const q3AABB& aabb )
+{
+	struct BroadPhaseWrapper
+	{
+		bool TreeCallBack( i32 id )
+		{
+			q3Body *other = (q3Body *)broadPhase->GetUserData( id );
+
+			// Dynamic bodies are left to the discrete contacts
+			if ( (other->m_flags & q3Body::eDynamic) || !bullet->CanCollide( other ) )
+				return true;
+
+			for ( q3Shape* shape = other->m_shapes; shape; shape = shape->next )
+			{
+				if ( shape->sensor || shape->type == ePlaneShape )
+					continue;
+
+				switch ( shape->type )
+				{
+				case eMeshShape:
+					q3AddTriangles( solver, bullet->m_shapes, (q3Mesh*)shape, aabb );
+					break;
+
+				case eHeightfieldShape:
+					q3AddTriangles( solver, bullet->m_shapes, (q3Heightfield*)shape, aabb );
+					break;
+
+				default:
+				{
+					q3AABB shapeAABB;
+					shape->ComputeAABB( other->m_tx, &shapeAABB );
+
+					if ( !q3AABBtoAABB( aabb, shapeAABB ) )
+						break;
+
+					for ( q3Shape* b = bullet->m_shapes; b; b = b->next )
+					{
+						if ( !b->sensor )
+							solver->AddPair( b, shape, 0 );
+					}
+				}
+					break;
+				}
+			}
+
+			return true;
+		}
+
+		q3TOISolver *solver;
+		const q3BroadPhase *broadPhase;
+		const q3Body *bullet;
+		q3AABB aabb;
+	};
+
+	m_pairCount = 0;
+
+	BroadPhaseWrapper wrapper;
+	wrapper.solver = this;
+	wrapper.broadPhase = m_broadphase;
+	wrapper.bullet = body;
+	wrapper.aabb = aabb;
+	m_broadphase->Query( &wrapper, aabb );
+
+	for ( i32 i = 0; i < m_broadphase->m_planeCount; ++i )
+	{
+		q3Shape *plane = m_broadphase->m_planes[ i ];
+
+		if ( plane->sensor || !body->CanCollide( plane->body ) )
+			continue;
+
+		if ( !q3AABBtoPlane( aabb, ((const q3Plane*)plane)->GetPlane( plane->body->m_tx ) ) )
+			continue;
+
+		for ( q3Shape* shape = body->m_shapes; shape; shape = shape->next )
+		{
+			if ( !shape->sensor )
+				AddPair( shape, plane, 0 );
+		}
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+// Deepest penetration of a pair at the current transforms of its bodies, or a
+// negative value if the shapes do not touch
+static r32 q3ComputeDepth( const q3TOIPair* pair, q3Manifold* m )
+{
+	m->SetPair( pair->A, pair->B );
+	m->contactCount = 0;
+	m->margin = r32( 0.0 );
+	q3Collide( m, pair->A, pair->B, pair->childB );
+
+	r32 depth = -Q3_R32_MAX;
+
+	for ( i32 i = 0; i < m->contactCount; ++i )
+		depth = q3Max( depth, -m->contacts[ i ].penetration );
+
+	return depth;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3TOISolver::Advance( q3Body *body, const q3Sweep& sweep, r32 t )
+{
+	body->m_worldCenter = sweep.c0 + (sweep.c1 - sweep.c0) * t;
+	body->m_q = sweep.GetOrientation( t );
+	sweep.GetTransform( &body->m_tx, t );
+}
+
+//--------------------------------------------------------------------------------------------------
+// Places the bullet at time t of the sweep and returns true if any pair
+// penetrates deeper than it did at the start of the sweep
+bool q3TOISolver::TestSweep( q3Body *body, const q3Sweep& sweep, r32 t )
+{
+	sweep.GetTransform( &body->m_tx, t );
+
+	for ( i32 i = 0; i < m_pairCount; ++i )
+	{
+		q3TOIPair* pair = m_pairs + i;
+		q3Manifold m;
+
+		if ( q3ComputeDepth( pair, &m ) > pair->depth0 + Q3_PENETRATION_SLOP )
+			return true;
+	}
+
+	return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+// Removes the approaching velocity of the bullet at each contact found at its
+// current transform. The shapes hit are static or kinematic and do not react.
+void q3TOISolver::ResolveVelocity( q3Body *body )
+{
+	struct q3TOIContact
+	{
+		q3Vec3 r;
+		q3Vec3 n;			// Points towards the bullet
+		q3Vec3 otherVelocity;
+		r32 bias;
+		r32 normalMass;
+		r32 normalImpulse;
+	};
+
+	q3TOIContact contacts[ k_maxTOIContacts ];
+	i32 count = 0;
+
+	q3Mat3 r = body->m_tx.rotation;
+	q3Mat3 invInertia = r * body->m_invInertiaModel * q3Transpose( r );
+	q3Vec3 c = body->m_worldCenter;
+	q3Vec3 v = body->m_linearVelocity;
+	q3Vec3 w = body->m_angularVelocity;
+
+	for ( i32 i = 0; i < m_pairCount && count < k_maxTOIContacts; ++i )
+	{
+		q3TOIPair* pair = m_pairs + i;
+		q3Manifold m;
+
+		if ( q3ComputeDepth( pair, &m ) < r32( 0.0 ) )
+			continue;
+
+		bool flip = pair->B->body == body;
+		q3Body *other = flip ? pair->A->body : pair->B->body;
+		r32 restitution = q3MixRestitution( pair->A, pair->B );
+
+		for ( i32 j = 0; j < m.contactCount && count < k_maxTOIContacts; ++j )
+		{
+			q3TOIContact* tc = contacts + count++;
+			q3Vec3 p = m.contacts[ j ].position;
+			tc->r = p - c;
+			tc->n = flip ? m.normal : -m.normal;
+			tc->otherVelocity = other->m_linearVelocity + q3Cross( other->m_angularVelocity, p - other->m_worldCenter );
+			tc->normalImpulse = r32( 0.0 );
+
+			q3Vec3 rn = q3Cross( tc->r, tc->n );
+			tc->normalMass = q3Invert( body->m_invMass + q3Dot( rn, invInertia * rn ) );
+
+			r32 dv = q3Dot( v + q3Cross( w, tc->r ) - tc->otherVelocity, tc->n );
+			tc->bias = dv < -r32( 1.0 ) ? -restitution * dv : r32( 0.0 );
+		}
+	}
+
+	for ( i32 i = 0; i < k_toiVelocityIterations; ++i )
+	{
+		for ( i32 j = 0; j < count; ++j )
+		{
+			q3TOIContact* tc = contacts + j;
+			r32 dv = q3Dot( v + q3Cross( w, tc->r ) - tc->otherVelocity, tc->n );
+			r32 lambda = tc->normalMass * (tc->bias - dv);
+
+			r32 oldImpulse = tc->normalImpulse;
+			tc->normalImpulse = q3Max( oldImpulse + lambda, r32( 0.0 ) );
+			lambda = tc->normalImpulse - oldImpulse;
+
+			q3Vec3 P = tc->n * lambda;
+			v += P * body->m_invMass;
+			w += invInertia * q3Cross( tc->r, P );
+		}
+	}
+
+	body->m_linearVelocity = v;
+	body->m_angularVelocity = w;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3TOISolver::Solve( q3Body *body )
+{
+	// Smallest half extent and largest reach from the center of mass of the
+	// bullet's shapes. Shapes cannot pass through one another while moving
+	// less than half of the smallest extent per sample.
+	r32 minExtent = Q3_R32_MAX;
+	r32 maxRadius = r32( 0.0 );
+	q3Transform identity;
+	q3Identity( identity );
+
+	for ( q3Shape* shape = body->m_shapes; shape; shape = shape->next )
+	{
+		q3AABB aabb;
+		shape->ComputeAABB( identity, &aabb );
+		q3Vec3 e = (aabb.max - aabb.min) * r32( 0.5 );
+		q3Vec3 lo = aabb.min - body->m_localCenter;
+		q3Vec3 hi = aabb.max - body->m_localCenter;
+		q3Vec3 reach( q3Max( q3Abs( lo.x ), q3Abs( hi.x ) ), q3Max( q3Abs( lo.y ), q3Abs( hi.y ) ), q3Max( q3Abs( lo.z ), q3Abs( hi.z ) ) );
+
+		minExtent = q3Min( minExtent, q3Min( e.x, q3Min( e.y, e.z ) ) );
+		maxRadius = q3Max( maxRadius, q3Length( reach ) );
+	}
+
+	r32 sampleLength = r32( 0.5 ) * minExtent;
+
+	q3Sweep sweep;
+	sweep.localCenter = body->m_localCenter;
+	sweep.c0 = body->m_worldCenter0;
+	sweep.q0 = body->m_q0;
+	sweep.c1 = body->m_worldCenter;
+	sweep.q1 = body->m_q;
+	r32 remaining = r32( 1.0 );
+	r32 t = r32( 1.0 );
+
+	for ( i32 substep = 0; substep < Q3_MAX_TOI_SUBSTEPS; ++substep )
+	{
+		const q3Quaternion& q0 = sweep.q0;
+		const q3Quaternion& q1 = sweep.q1;
+		r32 cosHalfAngle = q3Abs( q0.x * q1.x + q0.y * q1.y + q0.z * q1.z + q0.w * q1.w );
+		r32 angle = r32( 2.0 ) * std::acos( q3Min( cosHalfAngle, r32( 1.0 ) ) );
+		r32 motion = q3Length( sweep.c1 - sweep.c0 ) + angle * maxRadius;
+
+		// Discrete collision handles slow bullets
+		t = r32( 1.0 );
+		if ( motion <= sampleLength )
+			break;
+
+		q3AABB aabb, aabb1;
+		sweep.GetTransform( &body->m_tx, r32( 0.0 ) );
+		body->ComputeAABB( &aabb );
+		sweep.GetTransform( &body->m_tx, r32( 1.0 ) );
+		body->ComputeAABB( &aabb1 );
+		aabb = q3Combine( aabb, aabb1 );
+
+		FindPairs( body, aabb );
+
+		if ( !m_pairCount )
+			break;
+
+		// Pairs already touching at the start of the sweep are resolved by the
+		// contact solver, only deeper penetration counts as an impact
+		sweep.GetTransform( &body->m_tx, r32( 0.0 ) );
+
+		for ( i32 i = 0; i < m_pairCount; ++i )
+		{
+			q3Manifold m;
+			m_pairs[ i ].depth0 = q3Max( q3ComputeDepth( m_pairs + i, &m ), r32( 0.0 ) );
+		}
+
+		i32 samples = q3Min( (i32)std::ceil( motion / sampleLength ), (i32)Q3_MAX_TOI_SAMPLES );
+		r32 lo = r32( 0.0 );
+		r32 hi = r32( -1.0 );
+
+		for ( i32 i = 1; i <= samples; ++i )
+		{
+			r32 s = r32( i ) / r32( samples );
+
+			if ( TestSweep( body, sweep, s ) )
+			{
+				hi = s;
+				break;
+			}
+
+			lo = s;
+		}
+
+		if ( hi < r32( 0.0 ) )
+			break;
+
+		for ( i32 i = 0; i < k_toiIterations; ++i )
+		{
+			r32 mid = r32( 0.5 ) * (lo + hi);
+
+			if ( TestSweep( body, sweep, mid ) )
+				hi = mid;
+			else
+				lo = mid;
+		}
+
+		// Move to the time of impact and resolve the velocity there
+		Advance( body, sweep, lo );
+		ResolveVelocity( body );
+
+		// Sweep the rest of the step with the new velocity
+		remaining *= r32( 1.0 ) - lo;
+		r32 h = remaining * m_dt;
+		sweep.c0 = body->m_worldCenter;
+		sweep.q0 = body->m_q;
+		sweep.c1 = sweep.c0 + body->m_linearVelocity * h;
+		sweep.q1 = sweep.q0;
+		sweep.q1.Integrate( body->m_angularVelocity, h );
+		t = r32( 0.0 );
+	}
+
+	// The last sweep ends at t = 1, or at its start if an impact was just
+	// resolved and no substeps remain
+	Advance( body, sweep, t );
+}
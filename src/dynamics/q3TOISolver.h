@@ -0,0 +1,90 @@
+//--------------------------------------------------------------------------------------------------
+/**
+@file	q3TOISolver.h
+
+@author	Randy Gaul
+@date	10/19/2026
+
+	Copyright (c) 2014 Randy Gaul http://www.randygaul.net
+
+	This software is provided 'as-is', without any express or implied
+	warranty. In no event will the authors be held liable for any damages
+	arising from the use of this software.
+
+	Permission is granted to anyone to use this software for any purpose,
+	including commercial applications, and to alter it and redistribute it
+	freely, subject to the following restrictions:
+	  1. The origin of this software must not be misrepresented; you must not
+	     claim that you wrote the original software. If you use this software
+	     in a product, an acknowledgment in the product documentation would be
+	     appreciated but is not required.
+	  2. Altered source versions must be plainly marked as such, and must not
+	     be misrepresented as being the original software.
+	  3. This notice may not be removed or altered from any source distribution.
+*/
+//--------------------------------------------------------------------------------------------------
+
+#ifndef Q3TOISOLVER_H
+#define Q3TOISOLVER_H
+
+#include "../math/q3Math.h"
+#include "../math/q3Transform.h"
+#include "../common/q3Geometry.h"
+
+//--------------------------------------------------------------------------------------------------
+// q3TOISolver
+//--------------------------------------------------------------------------------------------------
+class q3Body;
+class q3BroadPhase;
+struct q3Shape;
+
+// Motion of a body's center of mass and orientation from the start of a
+// sweep (t = 0) to its end (t = 1)
+struct q3Sweep
+{
+	const q3Quaternion GetOrientation( r32 t ) const;
+	void GetTransform( q3Transform* tx, r32 t ) const;
+
+	q3Vec3 localCenter;
+	q3Vec3 c0, c1;
+	q3Quaternion q0, q1;
+};
+
+// A shape of the bullet and a shape it may hit during a sweep. Shapes are
+// ordered by type, as with contacts.
+struct q3TOIPair
+{
+	q3Shape *A;
+	q3Shape *B;
+	i32 childB;
+	r32 depth0;		// Penetration at the start of the sweep
+};
+
+// Continuous collision for bullet bodies. Once the positions of a step are
+// integrated the motion of each bullet is swept against static and kinematic
+// bodies, and planes. The sweep is sampled at intervals shorter than the
+// bullet's smallest half extent and the first impact is refined by bisection.
+// The bullet is placed at the time of impact, its velocity is resolved against
+// the hit and the remainder of the step is swept again.
+struct q3TOISolver
+{
+	void Initialize( const q3BroadPhase *broadphase, r32 dt );
+	void ShutDown( void );
+
+	void Solve( q3Body *body );
+
+	const q3BroadPhase *m_broadphase;
+	r32 m_dt;
+
+	q3TOIPair *m_pairs;
+	i32 m_pairCount;
+	i32 m_pairCapacity;
+
+	void AddPair( q3Shape *A, q3Shape *B, i32 childB );
+	void FindPairs( q3Body *body, const q3AABB& aabb );
+	void Advance( q3Body *body, const q3Sweep& sweep, r32 t );
+	bool TestSweep( q3Body *body, const q3Sweep& sweep, r32 t );
+	void ResolveVelocity( q3Body *body );
+};
+
+#endif // Q3TOISOLVER_H
@@ -80,6 +80,23 @@ inline const q3HalfSpace q3Mul( const q3Transform& tx, const q3Vec3& scale, cons
 	return q3HalfSpace( normal, q3Dot( origin, normal ) );
 }
 
+//--------------------------------------------------------------------------------------------------
+// Computes the AABB bounding the oriented box formed by transforming aabb
+// by tx. The result is conservative when tx contains a rotation.
+inline const q3AABB q3Mul( const q3Transform& tx, const q3AABB& aabb )
+{
+	q3Vec3 c = (aabb.min + aabb.max) * r32( 0.5 );
+	q3Vec3 e = (aabb.max - aabb.min) * r32( 0.5 );
+	c = q3Mul( tx, c );
+	e = q3Abs( tx.rotation.ex ) * e.x + q3Abs( tx.rotation.ey ) * e.y + q3Abs( tx.rotation.ez ) * e.z;
+
+	q3AABB out;
+	out.min = c - e;
+	out.max = c + e;
+
+	return out;
+}
+
 //--------------------------------------------------------------------------------------------------
 inline const q3Vec3 q3MulT( const q3Transform& tx, const q3Vec3& v )
 {
@@ -30,7 +30,14 @@
 #include "common/q3Types.h"
 #include "scene/q3Scene.h"
 #include "dynamics/q3Body.h"
+#include "dynamics/q3Contact.h"
+#include "collision/q3Sphere.h"
+#include "collision/q3Capsule.h"
 #include "collision/q3Box.h"
+#include "collision/q3Hull.h"
+#include "collision/q3Mesh.h"
+#include "collision/q3Heightfield.h"
+#include "collision/q3Plane.h"
 #include "math/q3Vec3.h"
 #include "math/q3Mat3.h"
 #include "math/q3Quaternion.h"
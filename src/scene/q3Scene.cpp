@@ -25,6 +25,7 @@
 //--------------------------------------------------------------------------------------------------
 
 #include <stdlib.h>
+#include <chrono>
 
 #include "q3Scene.h"
 #include "../dynamics/q3Body.h"
@@ -32,10 +33,29 @@
 #include "../dynamics/q3Contact.h"
 #include "../dynamics/q3Island.h"
 #include "../dynamics/q3ContactSolver.h"
+#include "../dynamics/q3TOISolver.h"
 #include "../collision/q3Box.h"
+#include "../collision/q3Plane.h"
 
 //--------------------------------------------------------------------------------------------------
 // q3Scene
+//--------------------------------------------------------------------------------------------------
+q3AdaptiveIterations::q3AdaptiveIterations( i32 minIterations, i32 maxIterations, i32 iterationsPerLevel )
+	: m_minIterations( minIterations )
+	, m_maxIterations( maxIterations )
+	, m_iterationsPerLevel( iterationsPerLevel )
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+i32 q3AdaptiveIterations::Iterations( i32 bodyCount, i32 contactCount, i32 depth )
+{
+	Q3_UNUSED( bodyCount );
+	Q3_UNUSED( contactCount );
+
+	return q3Min( m_minIterations + depth * m_iterationsPerLevel, m_maxIterations );
+}
+
 //--------------------------------------------------------------------------------------------------
 q3Scene::q3Scene( r32 dt, const q3Vec3& gravity, i32 iterations )
 	: m_contactManager( &m_stack )
@@ -45,9 +65,20 @@ q3Scene::q3Scene( r32 dt, const q3Vec3& gravity, i32 iterations )
 	, m_gravity( gravity )
 	, m_dt( dt )
 	, m_iterations( iterations )
+	, m_minIterations( 1 )
+	, m_impulseTolerance( r32( 0.0 ) )
+	, m_substeps( 1 )
+	, m_iterationPolicy( NULL )
+	, m_stepBudget( r32( 0.0 ) )
+	, m_quality( r32( 1.0 ) )
 	, m_newBox( false )
 	, m_allowSleep( true )
 	, m_enableFriction( true )
+	, m_enableSpeculative( false )
+	, m_enableBlockSolver( false )
+	, m_enableSplitImpulse( false )
+	, m_enableCentralFriction( false )
+	, m_enableShockPropagation( false )
 {
 }
 
@@ -60,141 +91,189 @@ q3Scene::~q3Scene( )
 //--------------------------------------------------------------------------------------------------
 void q3Scene::Step( )
 {
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now( );
+
 	if ( m_newBox )
 	{
 		m_contactManager.m_broadphase.UpdatePairs( );
 		m_newBox = false;
 	}
 
+	m_contactManager.m_coherenceSpeed = m_quality < r32( 1.0 ) ? Q3_COHERENCE_TOLERANCE / m_dt : r32( 0.0 );
 	m_contactManager.TestCollisions( );
 
-	for ( q3Body* body = m_bodyList; body; body = body->m_next )
-		body->m_flags &= ~q3Body::eIsland;
+	// Split the island sets that may have come apart since they were last
+	// solved. Sets only need splitting to let their pieces sleep apart.
+	for ( q3IslandSet* set = m_contactManager.m_islandList; set; )
+	{
+		q3IslandSet* next = set->next;
 
-	// Size the stack island, pick worst case size
+		if ( set->split && set->awake && m_allowSleep )
+			m_contactManager.SplitIsland( set );
+
+		set = next;
+	}
+
+	// Size the stack island, pick worst case size. Islands are gathered until
+	// they hold Q3_ISLAND_BATCH_BODIES bodies. The island that fills a batch
+	// holds each body at most once, but the islands gathered before it may
+	// hold the same static bodies again.
+	i32 bodyCapacity = m_bodyCount + Q3_ISLAND_BATCH_BODIES;
 	m_stack.Reserve(
-		sizeof( q3Body* ) * m_bodyCount
-		+ sizeof( q3VelocityState ) * m_bodyCount
+		sizeof( q3Body* ) * bodyCapacity
+		+ sizeof( q3VelocityState ) * bodyCapacity * 2
+		+ sizeof( q3MassState ) * bodyCapacity
 		+ sizeof( q3ContactConstraint* ) * m_contactManager.m_contactCount
 		+ sizeof( q3ContactConstraintState ) * m_contactManager.m_contactCount
-		+ sizeof( q3Body* ) * m_bodyCount
+		+ sizeof( i32 ) * bodyCapacity * 2
 	);
 
 	q3Island island;
-	island.m_bodyCapacity = m_bodyCount;
+	island.m_bodyCapacity = bodyCapacity;
 	island.m_contactCapacity = m_contactManager.m_contactCount;
-	island.m_bodies = (q3Body**)m_stack.Allocate( sizeof( q3Body* ) * m_bodyCount );
-	island.m_velocities = (q3VelocityState *)m_stack.Allocate( sizeof( q3VelocityState ) * m_bodyCount );
+	island.m_bodies = (q3Body**)m_stack.Allocate( sizeof( q3Body* ) * bodyCapacity );
+	island.m_velocities = (q3VelocityState *)m_stack.Allocate( sizeof( q3VelocityState ) * bodyCapacity );
+	island.m_pseudoVelocities = (q3VelocityState *)m_stack.Allocate( sizeof( q3VelocityState ) * bodyCapacity );
+	island.m_masses = (q3MassState *)m_stack.Allocate( sizeof( q3MassState ) * bodyCapacity );
 	island.m_contacts = (q3ContactConstraint **)m_stack.Allocate( sizeof( q3ContactConstraint* ) * island.m_contactCapacity );
-	island.m_contactStates = (q3ContactConstraintState *)m_stack.Allocate( sizeof( q3ContactConstraintState ) * island.m_contactCapacity );
 	island.m_allowSleep = m_allowSleep;
 	island.m_enableFriction = m_enableFriction;
+	island.m_enableBlockSolver = m_enableBlockSolver;
+	island.m_enableSplitImpulse = m_enableSplitImpulse;
+	island.m_enableCentralFriction = m_enableCentralFriction;
+	island.m_enableShockPropagation = m_enableShockPropagation && q3LengthSq( m_gravity ) > r32( 0.0 );
 	island.m_bodyCount = 0;
 	island.m_contactCount = 0;
+	island.m_islandCount = 0;
 	island.m_dt = m_dt;
 	island.m_gravity = m_gravity;
 	island.m_iterations = m_iterations;
-
-	// Build each active island and then solve each built island
-	i32 stackSize = m_bodyCount;
-	q3Body** stack = (q3Body**)m_stack.Allocate( sizeof( q3Body* ) * stackSize );
-	for ( q3Body* seed = m_bodyList; seed; seed = seed->m_next )
+	island.m_minIterations = m_minIterations;
+	island.m_impulseTolerance = m_impulseTolerance;
+	island.m_substeps = m_substeps;
+	island.m_quality = m_quality;
+
+	// Gather each awake island set and then solve each gathered island
+	i32* depths = (i32*)m_stack.Allocate( sizeof( i32 ) * bodyCapacity );
+	island.m_islandStarts = (i32 *)m_stack.Allocate( sizeof( i32 ) * bodyCapacity );
+	i32 batchIterations = 0;
+
+	// Contact states come last, their size is not a multiple of the
+	// pointer alignment the other arrays need
+	island.m_contactStates = (q3ContactConstraintState *)m_stack.Allocate( sizeof( q3ContactConstraintState ) * island.m_contactCapacity );
+	for ( q3IslandSet* set = m_contactManager.m_islandList; set; set = set->next )
 	{
-		// Seed cannot be apart of an island already
-		if ( seed->m_flags & q3Body::eIsland )
+		if ( !set->awake )
 			continue;
 
-		// Seed must be awake
-		if ( !(seed->m_flags & q3Body::eAwake) )
-			continue;
+		// The set sleeps once none of its bodies are awake
+		bool awake = false;
+		for ( q3Body* body = set->bodyList; body; body = body->m_islandNext )
+		{
+			if ( body->m_flags & q3Body::eAwake )
+			{
+				awake = true;
+				break;
+			}
+		}
 
-		// Seed cannot be a static body in order to keep islands
-		// as small as possible
-		if ( seed->m_flags & q3Body::eStatic )
+		if ( !awake )
+		{
+			set->awake = false;
 			continue;
+		}
 
-		i32 stackCount = 0;
-		stack[ stackCount++ ] = seed;
-		island.m_bodyCount = 0;
-		island.m_contactCount = 0;
-
-		// Mark seed as apart of island
-		seed->m_flags |= q3Body::eIsland;
+		i32 firstBody = island.m_bodyCount;
+		i32 firstContact = island.m_contactCount;
+		island.m_islandStarts[ island.m_islandCount++ ] = firstBody;
 
-		// Perform DFS on constraint graph
-		while( stackCount > 0 )
+		// Awaken all bodies connected to the island
+		for ( q3Body* body = set->bodyList; body; body = body->m_islandNext )
 		{
-			// Decrement stack to implement iterative backtracking
-			q3Body *body = stack[ --stackCount ];
 			island.Add( body );
-
-			// Awaken all bodies connected to the island
 			body->SetToAwake( );
+			m_contactManager.m_broadphase.SetBodyAwake( body, true );
+		}
 
-			// Do not search across static bodies to keep island
-			// formations as small as possible, however the static
-			// body itself should be apart of the island in order
-			// to properly represent a full contact
-			if ( body->m_flags & q3Body::eStatic )
-				continue;
-
-			// Search all contacts connected to this body
-			q3ContactEdge* contacts = body->m_contactList;
-			for ( q3ContactEdge* edge = contacts; edge; edge = edge->next )
-			{
-				q3ContactConstraint *contact = edge->constraint;
-
-				// Skip contacts that have been added to an island already
-				if ( contact->m_flags & q3ContactConstraint::eIsland )
-					continue;
+		// Static bodies are not part of any set, however they are added to
+		// the island of each set they touch in order to properly represent
+		// a full contact
+		for ( q3ContactConstraint* contact = set->contactList; contact; contact = contact->islandNext )
+		{
+			island.Add( contact );
 
-				// Can safely skip this contact if it didn't actually collide with anything
-				if ( !(contact->m_flags & q3ContactConstraint::eColliding) )
-					continue;
+			q3Body* bodies[ 2 ] = { contact->bodyA, contact->bodyB };
 
-				// Skip sensors
-				if ( contact->A->sensor || contact->B->sensor )
-					continue;
+			for ( i32 i = 0; i < 2; ++i )
+			{
+				q3Body* body = bodies[ i ];
 
-				// Mark island flag and add to island
-				contact->m_flags |= q3ContactConstraint::eIsland;
-				island.Add( contact );
+				if ( (body->m_flags & (q3Body::eStatic | q3Body::eIsland)) == q3Body::eStatic )
+				{
+					island.Add( body );
+					body->m_flags |= q3Body::eIsland;
+				}
+			}
+		}
 
-				// Attempt to add the other body in the contact to the island
-				// to simulate contact awakening propogation
-				q3Body* other = edge->other;
-				if ( other->m_flags & q3Body::eIsland )
-					continue;
+		assert( island.m_bodyCount != firstBody );
 
-				assert( stackCount < stackSize );
+		i32 iterations = m_iterations;
 
-				stack[ stackCount++ ] = other;
-				other->m_flags |= q3Body::eIsland;
-			}
+		if ( m_iterationPolicy )
+		{
+			i32 depth = island.Depth( depths, firstBody, firstContact );
+			iterations = m_iterationPolicy->Iterations( island.m_bodyCount - firstBody, island.m_contactCount - firstContact, depth );
 		}
 
-		assert( island.m_bodyCount != 0 );
-
-		island.Initialize( );
-		island.Solve( );
+		batchIterations = q3Max( batchIterations, iterations );
 
 		// Reset all static island flags
 		// This allows static bodies to participate in other island formations
-		for ( i32 i = 0; i < island.m_bodyCount; i++ )
+		for ( i32 i = firstBody; i < island.m_bodyCount; i++ )
 		{
 			q3Body *body = island.m_bodies[ i ];
 
 			if ( body->m_flags & q3Body::eStatic )
 				body->m_flags &= ~q3Body::eIsland;
 		}
+
+		// Islands are independent, so tiny ones are gathered and solved
+		// together instead of paying for the setup of the solver each
+		if ( island.m_bodyCount < Q3_ISLAND_BATCH_BODIES )
+			continue;
+
+		SolveIsland( &island, batchIterations );
+		batchIterations = 0;
 	}
 
-	m_stack.Free( stack );
+	if ( island.m_islandCount )
+		SolveIsland( &island, batchIterations );
+
 	m_stack.Free( island.m_contactStates );
+	m_stack.Free( island.m_islandStarts );
+	m_stack.Free( depths );
 	m_stack.Free( island.m_contacts );
+	m_stack.Free( island.m_masses );
+	m_stack.Free( island.m_pseudoVelocities );
 	m_stack.Free( island.m_velocities );
 	m_stack.Free( island.m_bodies );
 
+	// Sweep bullets solved this step against static geometry
+	q3TOISolver toiSolver;
+	toiSolver.Initialize( &m_contactManager.m_broadphase, m_dt );
+
+	for ( q3Body* body = m_bodyList; body; body = body->m_next )
+	{
+		if ( (body->m_flags & (q3Body::eBullet | q3Body::eAwake)) == (q3Body::eBullet | q3Body::eAwake) )
+			toiSolver.Solve( body );
+	}
+
+	toiSolver.ShutDown( );
+
+	if ( m_contactManager.m_bufferEvents )
+		m_contactManager.GatherEventImpulses( );
+
 	// Update the broadphase AABBs
 	for ( q3Body* body = m_bodyList; body; body = body->m_next )
 	{
@@ -213,6 +292,35 @@ void q3Scene::Step( )
 		q3Identity( body->m_force );
 		q3Identity( body->m_torque );
 	}
+
+	// Trade quality for time while over budget, and win it back slowly
+	// once there is headroom again
+	if ( m_stepBudget > r32( 0.0 ) )
+	{
+		std::chrono::duration<r32> elapsed = std::chrono::steady_clock::now( ) - start;
+
+		if ( elapsed.count( ) > m_stepBudget )
+			m_quality = q3Max( Q3_MIN_QUALITY, m_quality * Q3_QUALITY_DECAY );
+
+		else if ( elapsed.count( ) < m_stepBudget * Q3_QUALITY_DECAY )
+			m_quality = q3Min( r32( 1.0 ), m_quality + Q3_QUALITY_RECOVERY );
+	}
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Scene::SolveIsland( q3Island* island, i32 iterations )
+{
+	island->m_iterations = q3Max( 1, i32( r32( iterations ) * m_quality + r32( 0.5 ) ) );
+
+	if ( m_substeps > 1 )
+		island->m_substeps = q3Max( 2, i32( r32( m_substeps ) * m_quality + r32( 0.5 ) ) );
+
+	island->Initialize( );
+	island->Solve( );
+
+	island->m_bodyCount = 0;
+	island->m_contactCount = 0;
+	island->m_islandCount = 0;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -231,6 +339,9 @@ q3Body* q3Scene::CreateBody( const q3BodyDef& def )
 	m_bodyList = body;
 	++m_bodyCount;
 
+	if ( !(body->m_flags & q3Body::eStatic) )
+		m_contactManager.AddToIsland( body );
+
 	return body;
 }
 
@@ -241,7 +352,9 @@ void q3Scene::RemoveBody( q3Body* body )
 
 	m_contactManager.RemoveContactsFromBody( body );
 
-	body->RemoveAllBoxes( );
+	body->RemoveAllShapes( );
+
+	m_contactManager.RemoveFromIsland( body );
 
 	// Remove body from scene bodyList
 	if ( body->m_next )
@@ -255,6 +368,7 @@ void q3Scene::RemoveBody( q3Body* body )
 
 	--m_bodyCount;
 
+	body->~q3Body( );
 	m_heap.Free( body );
 }
 
@@ -267,8 +381,11 @@ void q3Scene::RemoveAllBodies( )
 	{
 		q3Body* next = body->m_next;
 
-		body->RemoveAllBoxes( );
+		body->RemoveAllShapes( );
 
+		m_contactManager.RemoveFromIsland( body );
+
+		body->~q3Body( );
 		m_heap.Free( body );
 
 		body = next;
@@ -295,12 +412,77 @@ void q3Scene::SetIterations( i32 iterations )
 	m_iterations = q3Max( 1, iterations );
 }
 
+//--------------------------------------------------------------------------------------------------
+void q3Scene::SetImpulseTolerance( r32 tolerance, i32 minIterations )
+{
+	m_impulseTolerance = q3Max( r32( 0.0 ), tolerance );
+	m_minIterations = q3Max( 1, minIterations );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Scene::SetSubsteps( i32 substeps )
+{
+	m_substeps = q3Max( 1, substeps );
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Scene::SetIterationPolicy( q3IterationPolicy* policy )
+{
+	m_iterationPolicy = policy;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Scene::SetStepBudget( r32 seconds )
+{
+	m_stepBudget = q3Max( r32( 0.0 ), seconds );
+
+	if ( m_stepBudget == r32( 0.0 ) )
+		m_quality = r32( 1.0 );
+}
+
+//--------------------------------------------------------------------------------------------------
+r32 q3Scene::GetQuality( ) const
+{
+	return m_quality;
+}
+
 //--------------------------------------------------------------------------------------------------
 void q3Scene::SetEnableFriction( bool enabled )
 {
 	m_enableFriction = enabled;
 }
 
+//--------------------------------------------------------------------------------------------------
+void q3Scene::SetEnableBlockSolver( bool enabled )
+{
+	m_enableBlockSolver = enabled;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Scene::SetEnableSplitImpulse( bool enabled )
+{
+	m_enableSplitImpulse = enabled;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Scene::SetEnableCentralFriction( bool enabled )
+{
+	m_enableCentralFriction = enabled;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Scene::SetEnableShockPropagation( bool enabled )
+{
+	m_enableShockPropagation = enabled;
+}
+
+//--------------------------------------------------------------------------------------------------
+void q3Scene::SetEnableSpeculative( bool enabled )
+{
+	m_enableSpeculative = enabled;
+	m_contactManager.m_speculativeDt = enabled ? m_dt : r32( 0.0 );
+}
+
 //--------------------------------------------------------------------------------------------------
 void q3Scene::Render( q3Render* render ) const
 {
@@ -313,7 +495,7 @@ void q3Scene::Render( q3Render* render ) const
 	}
 
 	m_contactManager.RenderContacts( render );
-	//m_contactManager.m_broadphase.m_tree.Render( render );
+	//m_contactManager.m_broadphase.m_trees[ 0 ].Render( render );
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -342,99 +524,225 @@ void q3Scene::SetContactListener( q3ContactListener* listener )
 	m_contactManager.m_contactListener = listener;
 }
 
+//--------------------------------------------------------------------------------------------------
+void q3Scene::SetBufferContactEvents( bool enabled )
+{
+	m_contactManager.m_bufferEvents = enabled;
+	m_contactManager.m_eventCount = 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+const q3ContactEvent* q3Scene::GetContactEvents( ) const
+{
+	return m_contactManager.m_events;
+}
+
+//--------------------------------------------------------------------------------------------------
+i32 q3Scene::GetContactEventCount( ) const
+{
+	return m_contactManager.m_eventCount;
+}
+
 //--------------------------------------------------------------------------------------------------
 void q3Scene::QueryAABB( q3QueryCallback *cb, const q3AABB& aabb ) const
 {
-	struct SceneQueryWrapper
+	struct BodyQueryWrapper
 	{
 		bool TreeCallBack( i32 id )
 		{
 			q3AABB aabb;
-			q3Box *box = (q3Box *)broadPhase->m_tree.GetUserData( id );
+			q3Shape *shape = (q3Shape *)body->m_shapeTree.GetUserData( id );
 
-			box->ComputeAABB( box->body->GetTransform( ), &aabb );
+			shape->ComputeAABB( body->m_tx, &aabb );
 
 			if ( q3AABBtoAABB( m_aabb, aabb ) )
 			{
-				return cb->ReportShape( box );
+				done = !cb->ReportShape( shape );
+				return !done;
 			}
 
 			return true;
 		}
 
+		q3QueryCallback *cb;
+		const q3Body *body;
+		q3AABB m_aabb;
+		bool done;
+	};
+
+	struct SceneQueryWrapper
+	{
+		bool TreeCallBack( i32 id )
+		{
+			BodyQueryWrapper wrapper;
+			wrapper.body = (const q3Body *)broadPhase->GetUserData( id );
+			wrapper.m_aabb = m_aabb;
+			wrapper.cb = cb;
+			wrapper.done = false;
+			wrapper.body->m_shapeTree.Query( &wrapper, wrapper.body->m_tx, m_aabb );
+
+			return !wrapper.done;
+		}
+
 		q3QueryCallback *cb;
 		const q3BroadPhase *broadPhase;
 		q3AABB m_aabb;
 	};
 
+	const q3BroadPhase* broadPhase = &m_contactManager.m_broadphase;
+
+	// Planes are not in the tree
+	for ( i32 i = 0; i < broadPhase->m_planeCount; ++i )
+	{
+		const q3Plane *plane = (const q3Plane *)broadPhase->m_planes[ i ];
+
+		if ( q3AABBtoPlane( aabb, plane->GetPlane( plane->body->m_tx ) ) )
+		{
+			if ( !cb->ReportShape( broadPhase->m_planes[ i ] ) )
+				return;
+		}
+	}
+
 	SceneQueryWrapper wrapper;
 	wrapper.m_aabb = aabb;
-	wrapper.broadPhase = &m_contactManager.m_broadphase;
+	wrapper.broadPhase = broadPhase;
 	wrapper.cb = cb;
-	m_contactManager.m_broadphase.m_tree.Query( &wrapper, aabb );
+	broadPhase->Query( &wrapper, aabb );
 }
 
 //--------------------------------------------------------------------------------------------------
 void q3Scene::QueryPoint( q3QueryCallback *cb, const q3Vec3& point ) const
 {
-	struct SceneQueryWrapper
+	struct BodyQueryWrapper
 	{
 		bool TreeCallBack( i32 id )
 		{
-			q3Box *box = (q3Box *)broadPhase->m_tree.GetUserData( id );
+			q3Shape *shape = (q3Shape *)body->m_shapeTree.GetUserData( id );
 
-			if ( box->TestPoint( box->body->GetTransform( ), m_point ) )
+			if ( shape->TestPoint( body->m_tx, m_point ) )
 			{
-				cb->ReportShape( box );
+				cb->ReportShape( shape );
 			}
 
 			return true;
 		}
 
+		q3QueryCallback *cb;
+		const q3Body *body;
+		q3Vec3 m_point;
+	};
+
+	struct SceneQueryWrapper
+	{
+		bool TreeCallBack( i32 id )
+		{
+			BodyQueryWrapper wrapper;
+			wrapper.body = (const q3Body *)broadPhase->GetUserData( id );
+			wrapper.m_point = m_point;
+			wrapper.cb = cb;
+			wrapper.body->m_shapeTree.Query( &wrapper, wrapper.body->m_tx, m_aabb );
+
+			return true;
+		}
+
 		q3QueryCallback *cb;
 		const q3BroadPhase *broadPhase;
 		q3Vec3 m_point;
+		q3AABB m_aabb;
 	};
 
-	SceneQueryWrapper wrapper;
-	wrapper.m_point = point;
-	wrapper.broadPhase = &m_contactManager.m_broadphase;
-	wrapper.cb = cb;
 	const r32 k_fattener = r32( 0.5 );
 	q3Vec3 v( k_fattener, k_fattener, k_fattener );
 	q3AABB aabb;
 	aabb.min = point - v;
 	aabb.max = point + v;
-	m_contactManager.m_broadphase.m_tree.Query( &wrapper, aabb );
+
+	const q3BroadPhase* broadPhase = &m_contactManager.m_broadphase;
+
+	for ( i32 i = 0; i < broadPhase->m_planeCount; ++i )
+	{
+		q3Shape *plane = broadPhase->m_planes[ i ];
+
+		if ( plane->TestPoint( plane->body->m_tx, point ) )
+			cb->ReportShape( plane );
+	}
+
+	SceneQueryWrapper wrapper;
+	wrapper.m_point = point;
+	wrapper.m_aabb = aabb;
+	wrapper.broadPhase = broadPhase;
+	wrapper.cb = cb;
+	broadPhase->Query( &wrapper, aabb );
 }
 
 //--------------------------------------------------------------------------------------------------
 void q3Scene::RayCast( q3QueryCallback *cb, q3RaycastData& rayCast ) const
 {
-	struct SceneQueryWrapper
+	struct BodyQueryWrapper
 	{
 		bool TreeCallBack( i32 id )
 		{
-			q3Box *box = (q3Box *)broadPhase->m_tree.GetUserData( id );
+			q3Shape *shape = (q3Shape *)body->m_shapeTree.GetUserData( id );
 
-			if ( box->Raycast( box->body->GetTransform( ), m_rayCast ) )
+			if ( shape->Raycast( body->m_tx, m_rayCast ) )
 			{
-				return cb->ReportShape( box );
+				done = !cb->ReportShape( shape );
+				return !done;
 			}
 
 			return true;
 		}
 
+		q3QueryCallback *cb;
+		const q3Body *body;
+		q3RaycastData *m_rayCast;
+		bool done;
+	};
+
+	struct SceneQueryWrapper
+	{
+		bool TreeCallBack( i32 id )
+		{
+			BodyQueryWrapper wrapper;
+			wrapper.body = (const q3Body *)broadPhase->GetUserData( id );
+			wrapper.m_rayCast = m_rayCast;
+			wrapper.cb = cb;
+			wrapper.done = false;
+
+			// Shapes are stored in the local space of the body
+			const q3Transform& tx = wrapper.body->m_tx;
+			q3RaycastData localRay;
+			localRay.start = q3MulT( tx, m_rayCast->start );
+			localRay.dir = q3MulT( tx.rotation, m_rayCast->dir );
+			localRay.t = m_rayCast->t;
+			wrapper.body->m_shapeTree.Query( &wrapper, localRay );
+
+			return !wrapper.done;
+		}
+
 		q3QueryCallback *cb;
 		const q3BroadPhase *broadPhase;
 		q3RaycastData *m_rayCast;
 	};
 	
+	const q3BroadPhase* broadPhase = &m_contactManager.m_broadphase;
+
+	for ( i32 i = 0; i < broadPhase->m_planeCount; ++i )
+	{
+		q3Shape *plane = broadPhase->m_planes[ i ];
+
+		if ( plane->Raycast( plane->body->m_tx, &rayCast ) )
+		{
+			if ( !cb->ReportShape( plane ) )
+				return;
+		}
+	}
+
 	SceneQueryWrapper wrapper;
 	wrapper.m_rayCast = &rayCast;
-	wrapper.broadPhase = &m_contactManager.m_broadphase;
+	wrapper.broadPhase = broadPhase;
 	wrapper.cb = cb;
-	m_contactManager.m_broadphase.m_tree.Query( &wrapper, rayCast );
+	broadPhase->Query( &wrapper, rayCast );
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -445,6 +753,11 @@ void q3Scene::Dump( FILE* file ) const
 	fprintf( file, "scene.SetGravity( q3Vec3( %.15lf, %.15lf, %.15lf ) );\n", m_gravity.x, m_gravity.y, m_gravity.z );
 	fprintf( file, "scene.SetAllowSleep( %s );\n", m_allowSleep ? "true" : "false" );
 	fprintf( file, "scene.SetEnableFriction( %s );\n", m_enableFriction ? "true" : "false" );
+	fprintf( file, "scene.SetEnableBlockSolver( %s );\n", m_enableBlockSolver ? "true" : "false" );
+	fprintf( file, "scene.SetEnableSpeculative( %s );\n", m_enableSpeculative ? "true" : "false" );
+	fprintf( file, "scene.SetEnableSplitImpulse( %s );\n", m_enableSplitImpulse ? "true" : "false" );
+	fprintf( file, "scene.SetEnableCentralFriction( %s );\n", m_enableCentralFriction ? "true" : "false" );
+	fprintf( file, "scene.SetEnableShockPropagation( %s );\n", m_enableShockPropagation ? "true" : "false" );
 
 	fprintf( file, "q3Body** bodies = (q3Body**)q3Alloc( sizeof( q3Body* ) * %d );\n", m_bodyCount );
 
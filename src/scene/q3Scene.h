@@ -39,6 +39,8 @@
 class q3Body;
 struct q3BodyDef;
 struct q3ContactConstraint;
+struct q3ContactEvent;
+struct q3Shape;
 class q3Render;
 struct q3Island;
 
@@ -69,7 +71,37 @@ public:
 	{
 	}
 
-	virtual bool ReportShape( q3Box *box ) = 0;
+	virtual bool ReportShape( q3Shape *shape ) = 0;
+};
+
+// Chooses how many iterations the solver runs upon each island, so small
+// islands are not charged the cost of the deepest stack in the scene.
+// bodyCount includes the static bodies the island touches. depth is the
+// most contacts crossed from a static or kinematic body to reach one of
+// its dynamic bodies, zero for islands resting upon nothing. Called once
+// for every awake island each step.
+class q3IterationPolicy
+{
+public:
+	virtual ~q3IterationPolicy( )
+	{
+	}
+
+	virtual i32 Iterations( i32 bodyCount, i32 contactCount, i32 depth ) = 0;
+};
+
+// Built in policy. Islands take minIterations plus iterationsPerLevel for
+// each level of their depth, up to maxIterations.
+class q3AdaptiveIterations : public q3IterationPolicy
+{
+public:
+	q3AdaptiveIterations( i32 minIterations = 4, i32 maxIterations = 30, i32 iterationsPerLevel = 2 );
+
+	i32 Iterations( i32 bodyCount, i32 contactCount, i32 depth );
+
+	i32 m_minIterations;
+	i32 m_maxIterations;
+	i32 m_iterationsPerLevel;
 };
 
 class q3Scene
@@ -104,10 +136,75 @@ public:
 	// inputs set the iteration count to 1.
 	void SetIterations( i32 iterations );
 
+	// Lets an island stop iterating once no accumulated impulse changed by
+	// more than tolerance during an iteration, after at least minIterations.
+	// The iteration count remains the maximum. Resting piles often converge
+	// within a few iterations. A tolerance of zero, the default, always runs
+	// every iteration.
+	void SetImpulseTolerance( r32 tolerance, i32 minIterations );
+
+	// Lets the policy choose the iteration count of each island in place
+	// of the scene's iteration count. The policy is not owned by the scene.
+	// Provide a NULL pointer to remove the previously set policy.
+	void SetIterationPolicy( q3IterationPolicy* policy );
+
+	// Gives each Step a time budget in seconds. While steps overrun it the
+	// scene lowers its quality: islands run fewer iterations or sub-steps,
+	// touching shapes that barely moved keep their manifolds from the
+	// previous step, and islands fall asleep sooner. Quality recovers once
+	// steps come in well within budget. Zero, the default, disables the
+	// budget and keeps full quality.
+	void SetStepBudget( r32 seconds );
+
+	// Current quality, from Q3_MIN_QUALITY up to 1 for full quality
+	r32 GetQuality( ) const;
+
+	// Splits each step into sub-steps that solve every contact once with
+	// soft constraints, measuring how far the shapes have moved apart after
+	// each one. Tall stacks and heavy bodies resting upon light ones hold
+	// together far better than with iterations alone. When above 1 the
+	// iteration count, impulse tolerance and block solver are unused. The
+	// default of 1 keeps the iterative solver.
+	void SetSubsteps( i32 substeps );
+
 	// Friction occurs when two rigid bodies have shapes that slide along one
 	// another. The friction force resists this sliding motion.
 	void SetEnableFriction( bool enabled );
 
+	// The block solver solves the normal constraints of each manifold with
+	// two to four contact points together, instead of one point at a time.
+	// Stacks settle in far fewer iterations at a higher cost per iteration.
+	// The default is disabled.
+	void SetEnableBlockSolver( bool enabled );
+
+	// Resolves penetration with separate pseudo velocities that move the
+	// bodies but are thrown away after the step, instead of biasing their
+	// real velocities. Piles no longer gain energy as they push apart, so
+	// they come to rest and fall asleep sooner. Unused when sub-stepping.
+	// The default is disabled.
+	void SetEnableSplitImpulse( bool enabled );
+
+	// Solves the friction of a manifold with two or more contacts as two
+	// sliding rows and one twisting row at the center of the contacts,
+	// instead of two sliding rows at every contact. Up to eight times fewer
+	// friction rows are solved for a small loss of accuracy in how the
+	// friction is spread over the contact area. The default is disabled.
+	void SetEnableCentralFriction( bool enabled );
+
+	// Orders the contacts of each island from the ground up, against
+	// gravity, and gives the final iteration to a pass that treats the lower
+	// body of every contact as immovable. Tall stacks then stand with far
+	// fewer iterations, at the cost of lower bodies not feeling the full
+	// weight above them during that pass. Unused when sub-stepping or
+	// without gravity. The default is disabled.
+	void SetEnableShockPropagation( bool enabled );
+
+	// Speculative contacts are generated between shapes that are still
+	// apart but may touch within the next step, judging by their velocity.
+	// The solver only lets such shapes close the gap, which prevents most
+	// tunneling at large timesteps without the cost of bullets.
+	void SetEnableSpeculative( bool enabled );
+
 	// Render the scene with an interpolated time between the last frame and
 	// the current simulation step.
 	void Render( q3Render* render ) const;
@@ -128,6 +225,15 @@ public:
 	// listener.
 	void SetContactListener( q3ContactListener* listener );
 
+	// Instead of calling the contact listener from within collision
+	// detection, record begin, persist and end events into a buffer that
+	// can be read in bulk after Step returns. Persist events are recorded
+	// every step for each awake pair that keeps touching. The buffer is
+	// cleared at the beginning of each Step. The default is disabled.
+	void SetBufferContactEvents( bool enabled );
+	const q3ContactEvent* GetContactEvents( ) const;
+	i32 GetContactEventCount( ) const;
+
 	// Query the world to find any shapes that can potentially intersect
 	// the provided AABB. This works by querying the broadphase with an
 	// AAABB -- only *potential* intersections are reported. Perhaps the
@@ -149,6 +255,9 @@ public:
 	void Dump( FILE* file ) const;
 
 private:
+	// Solves the islands gathered so far and empties the island
+	void SolveIsland( q3Island* island, i32 iterations );
+
 	q3ContactManager m_contactManager;
 	q3PagedAllocator m_boxAllocator;
 
@@ -161,10 +270,21 @@ private:
 	q3Vec3 m_gravity;
 	r32 m_dt;
 	i32 m_iterations;
+	i32 m_minIterations;
+	r32 m_impulseTolerance;
+	i32 m_substeps;
+	q3IterationPolicy* m_iterationPolicy;
+	r32 m_stepBudget;
+	r32 m_quality;
 
 	bool m_newBox;
 	bool m_allowSleep;
 	bool m_enableFriction;
+	bool m_enableSpeculative;
+	bool m_enableBlockSolver;
+	bool m_enableSplitImpulse;
+	bool m_enableCentralFriction;
+	bool m_enableShockPropagation;
 
 	friend class q3Body;
 };